@@ -0,0 +1,342 @@
+#include "c8/chip8.h"
+#include "c8/decode.h"
+#include "c8/encode.h"
+#include "c8/private/instruction.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifndef VERSION
+#define VERSION "dev"
+#endif
+
+#define DEFAULT_REPEATS 5
+#define DEFAULT_TIME_NS 20000000LL
+#define ENCODE_BUFFER_SIZE (C8_MEMSIZE - C8_PROG_START)
+#define PROG_START 0x200
+#define SPRITE_ADDR 0x300
+
+/* Blocks of `ENCODE_BLOCK_INSTRUCTIONS` in the `encode` program */
+#define ENCODE_BLOCKS 48
+#define ENCODE_BLOCK_INSTRUCTIONS 8
+
+/**
+ * @struct bench_t
+ * @brief One micro-benchmark
+ *
+ * `run` performs `n` operations, each executing `instructions` CHIP-8
+ * instructions (0 if the benchmark does not execute any).
+ *
+ * @param name name in the report
+ * @param setup prepares `c8` before each measurement, or NULL
+ * @param run the operation
+ * @param opcode instruction placed at `PROG_START` by `setup_opcode`
+ * @param mode interpreter mode for `opcode`
+ * @param display display mode for `opcode`
+ * @param instructions CHIP-8 instructions executed per operation
+ */
+typedef struct bench {
+    const char* name;
+    void (*setup)(c8_t*, const struct bench*);
+    void (*run)(c8_t*, const struct bench*, long);
+    uint16_t opcode;
+    int mode;
+    int display;
+    int instructions;
+} bench_t;
+
+/**
+ * @struct result_t
+ * @brief Fastest of the repeated measurements of a benchmark
+ *
+ * @param ops operations per measurement
+ * @param ns fastest measurement in nanoseconds
+ */
+typedef struct {
+    long ops;
+    int64_t ns;
+} result_t;
+
+static int64_t now(void);
+static void measure(c8_t*, const bench_t*, int, result_t*);
+static void run_decode(c8_t*, const bench_t*, long);
+static void run_encode(c8_t*, const bench_t*, long);
+static void run_opcode(c8_t*, const bench_t*, long);
+static void setup_encode(c8_t*, const bench_t*);
+static void setup_opcode(c8_t*, const bench_t*);
+static void usage(const char*);
+
+/* Program assembled by the `encode` benchmark */
+static char* program;
+static uint8_t encoded[ENCODE_BUFFER_SIZE];
+
+#define OPCODE(name, op) \
+    { name, setup_opcode, run_opcode, op, C8_MODE_CHIP8, C8_DISPLAYMODE_LOW, 1 }
+#define OPCODE_MODE(name, op, mode, display) \
+    { name, setup_opcode, run_opcode, op, mode, display, 1 }
+
+static const bench_t benches[] = {
+    /* `parse_instruction` dispatch, one family per leading nibble */
+    OPCODE("dispatch/0nnn CLS", 0x00E0),
+    OPCODE("dispatch/1nnn JP", 0x1200),
+    OPCODE("dispatch/2nnn CALL", 0x2200),
+    OPCODE("dispatch/3xkk SE", 0x3012),
+    OPCODE("dispatch/4xkk SNE", 0x4012),
+    OPCODE("dispatch/5xy0 SE", 0x5010),
+    OPCODE("dispatch/6xkk LD", 0x6012),
+    OPCODE("dispatch/7xkk ADD", 0x7001),
+    OPCODE("dispatch/8xy4 ADD", 0x8014),
+    OPCODE("dispatch/8xy6 SHR", 0x8016),
+    OPCODE("dispatch/9xy0 SNE", 0x9010),
+    OPCODE("dispatch/Annn LD I", 0xA300),
+    OPCODE("dispatch/Bnnn JP V0", 0xB200),
+    OPCODE("dispatch/Cxkk RND", 0xC0FF),
+    OPCODE("dispatch/Ex9E SKP", 0xE09E),
+    OPCODE("dispatch/Fx1E ADD I", 0xF01E),
+    OPCODE("dispatch/Fx33 LD B", 0xF033),
+    OPCODE("dispatch/Fx65 LD Vx, [I]", 0xFF65),
+
+    /* `i_drw_vx_vy_b` */
+    OPCODE("draw/lores 8 rows", 0xD018),
+    OPCODE("draw/lores 15 rows", 0xD01F),
+    OPCODE_MODE("draw/hires 8 rows", 0xD018, C8_MODE_SCHIP, C8_DISPLAYMODE_HIGH),
+    OPCODE_MODE("draw/hires 16x16", 0xD010, C8_MODE_SCHIP, C8_DISPLAYMODE_HIGH),
+
+    /* Whole display operations */
+    OPCODE_MODE("display/CLS", 0x00E0, C8_MODE_SCHIP, C8_DISPLAYMODE_HIGH),
+    OPCODE_MODE("display/SCR", 0x00FB, C8_MODE_SCHIP, C8_DISPLAYMODE_HIGH),
+    OPCODE_MODE("display/SCL", 0x00FC, C8_MODE_SCHIP, C8_DISPLAYMODE_HIGH),
+    OPCODE_MODE("display/SCD 4", 0x00C4, C8_MODE_SCHIP, C8_DISPLAYMODE_HIGH),
+
+    /* Assembler and disassembler, instructions are those decoded or emitted */
+    { "decode/c8_decode_instruction", NULL, run_decode, 0, 0, 0, 1 },
+    { "encode/c8_encode", setup_encode, run_encode, 0, 0, 0,
+        ENCODE_BLOCKS * ENCODE_BLOCK_INSTRUCTIONS },
+};
+
+int main(int argc, char* argv[]) {
+    int opt;
+    int repeats = DEFAULT_REPEATS;
+    int first = 1;
+    char* filter = NULL;
+    char* outp = NULL;
+    FILE* outf = stdout;
+
+    /* Parse args */
+    while ((opt = getopt(argc, argv, "f:o:r:V")) != -1) {
+        switch (opt) {
+        case 'f': filter = optarg; break;
+        case 'o': outp = optarg; break;
+        case 'r': repeats = atoi(optarg); break;
+        case 'V': printf("%s %s\n", argv[0], VERSION); exit(EXIT_SUCCESS);
+        default: usage(argv[0]);
+        }
+    }
+
+    if (repeats < 1) {
+        usage(argv[0]);
+    }
+
+    if (outp) {
+        outf = fopen(outp, "w");
+        if (!outf) {
+            fprintf(stderr, "Could not open %s\n", outp);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    c8_t* c8 = c8_init_mem(NULL, 0, 0);
+    if (!c8) {
+        exit(EXIT_FAILURE);
+    }
+
+    fprintf(outf, "{\n  \"version\": \"%s\",\n  \"repeats\": %d,\n  \"benchmarks\": [", VERSION, repeats);
+    for (size_t i = 0; i < sizeof(benches) / sizeof(benches[0]); i++) {
+        const bench_t* b = &benches[i];
+        result_t r;
+
+        if (filter && !strstr(b->name, filter)) {
+            continue;
+        }
+
+        measure(c8, b, repeats, &r);
+
+        double nsPerOp = (double)r.ns / r.ops;
+        fprintf(outf, "%s\n    { \"name\": \"%s\", \"ops\": %ld, \"ns_per_op\": %.3f",
+            first ? "" : ",", b->name, r.ops, nsPerOp);
+        if (b->instructions) {
+            fprintf(outf, ", \"instructions_per_sec\": %.0f",
+                b->instructions * 1e9 / nsPerOp);
+        }
+        fprintf(outf, " }");
+        first = 0;
+    }
+    fprintf(outf, "\n  ]\n}\n");
+
+    c8_deinit(c8);
+    free(program);
+    if (outp) {
+        fclose(outf);
+    }
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Get the time of the monotonic clock
+ *
+ * @return time in nanoseconds
+ */
+static int64_t now(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/**
+ * @brief Measure a benchmark
+ *
+ * The number of operations is calibrated so one measurement takes about
+ * `DEFAULT_TIME_NS`, then the fastest of `repeats` measurements is kept, as
+ * it is the one least disturbed by the rest of the system. Every measurement
+ * starts from the same state, so results are reproducible.
+ *
+ * @param c8 `c8_t` to run the benchmark on
+ * @param b benchmark
+ * @param repeats number of measurements
+ * @param r where to store the result
+ */
+static void measure(c8_t* c8, const bench_t* b, int repeats, result_t* r) {
+    long ops = 1;
+    int64_t ns = 0;
+
+    /* Double the operations until a measurement is long enough */
+    while (ns < DEFAULT_TIME_NS / 8 && ops < (1L << 40)) {
+        ops *= 2;
+        if (b->setup) {
+            b->setup(c8, b);
+        }
+        int64_t start = now();
+        b->run(c8, b, ops);
+        ns = now() - start;
+    }
+    if (ns > 0) {
+        ops = ops * (DEFAULT_TIME_NS / ns);
+    }
+    if (ops < 1) {
+        ops = 1;
+    }
+
+    r->ops = ops;
+    r->ns = INT64_MAX;
+    for (int i = 0; i < repeats; i++) {
+        if (b->setup) {
+            b->setup(c8, b);
+        }
+        int64_t start = now();
+        b->run(c8, b, ops);
+        ns = now() - start;
+        if (ns < r->ns) {
+            r->ns = ns;
+        }
+    }
+}
+
+/**
+ * @brief Decode every 16-bit value in turn
+ */
+static void run_decode(c8_t* c8, const bench_t* b, long n) {
+    char buf[C8_DECODE_MAX_LENGTH];
+    volatile char sink = 0;
+
+    for (long i = 0; i < n; i++) {
+        sink ^= c8_decode_instruction_r((uint16_t)i, NULL, buf, sizeof(buf))[0];
+    }
+}
+
+/**
+ * @brief Assemble `program` `n` times
+ */
+static void run_encode(c8_t* c8, const bench_t* b, long n) {
+    for (long i = 0; i < n; i++) {
+        c8_encode(program, encoded, 0);
+    }
+}
+
+/**
+ * @brief Execute the instruction at `PROG_START` `n` times
+ *
+ * The program counter is reset before each execution, and the stack pointer
+ * too, so `CALL` never overflows.
+ */
+static void run_opcode(c8_t* c8, const bench_t* b, long n) {
+    for (long i = 0; i < n; i++) {
+        c8->pc = PROG_START;
+        c8->sp = 0;
+        parse_instruction(c8);
+    }
+}
+
+/**
+ * @brief Build the program assembled by the `encode` benchmark
+ *
+ * The program is a mix of labels, jumps, and all kinds of operands.
+ */
+static void setup_encode(c8_t* c8, const bench_t* b) {
+    static const char* block =
+        "LOOP%02d:\n"
+        "    LD V0, 0x%02X\n"
+        "    LD V1, V0\n"
+        "    ADD V1, 1\n"
+        "    SE V1, 0x10\n"
+        "    JP LOOP%02d\n"
+        "    LD I, 0x300\n"
+        "    DRW V0, V1, 8\n"
+        "    CALL LOOP%02d\n";
+    size_t size = ENCODE_BLOCKS * 160;
+    size_t len = 0;
+
+    if (program) {
+        return;
+    }
+
+    program = malloc(size);
+    if (!program) {
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < ENCODE_BLOCKS; i++) {
+        len += snprintf(program + len, size - len, block, i, i, i, i / 2);
+    }
+}
+
+/**
+ * @brief Reset `c8` and place `b->opcode` at `PROG_START`
+ */
+static void setup_opcode(c8_t* c8, const bench_t* b) {
+    /* Sprites start 4 pixels before a word boundary and span two words */
+    memset(c8->V, 0, sizeof(c8->V));
+    c8->V[0] = 60;
+    c8->V[1] = 13;
+    c8->I = SPRITE_ADDR;
+    c8->mode = b->mode;
+    c8->display.mode = b->display;
+    c8->display.x = c8->display.y = 0;
+    memset(c8->display.p, 0, sizeof(c8->display.p));
+    c8_seed(c8, 1);
+
+    for (int i = 0; i < 32; i++) {
+        c8->mem[SPRITE_ADDR + i] = (uint8_t)(0xA5 ^ (i * 37));
+    }
+    c8->mem[PROG_START] = b->opcode >> 8;
+    c8->mem[PROG_START + 1] = b->opcode & 0xFF;
+    invalidate_code(c8, PROG_START, 2);
+}
+
+static void usage(const char* argv0) {
+    fprintf(stderr, "Usage: %s [-V] [-f filter] [-o outputfile] [-r repeats]\n", argv0);
+    exit(EXIT_FAILURE);
+}
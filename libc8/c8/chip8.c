@@ -7,30 +7,83 @@
 #include "chip8.h"
 
 #include "font.h"
+#include "recompile.h"
 
 #include "private/debug.h"
 #include "private/exception.h"
+#include "private/frame.h"
 #include "private/instruction.h"
+#include "private/jit.h"
+#include "private/profile.h"
+#include "private/random.h"
+#include "private/rewind.h"
+#include "private/timer.h"
+#include "private/trace.h"
+#include "private/undo.h"
 #include "private/util.h"
 
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
-#include <unistd.h>
 
 #define DEBUG(c) (c->flags & C8_FLAG_DEBUG)
+#define INTERPRETED (C8_FLAG_DEBUG | C8_FLAG_VERBOSE | C8_FLAG_TRACE | C8_FLAG_PROFILE)
+#define JIT(c) ((c->flags & (C8_FLAG_JIT | INTERPRETED)) == C8_FLAG_JIT)
+#define RECOMPILED(c) (c->recompiled && !(c->flags & INTERPRETED))
+#define THREADED(c) (c->flags & C8_FLAG_THREADED)
+
+#define NSEC_PER_SEC 1000000000L
+#define C8_RESYNC_FRAMES 5
+
+/**
+ * @struct emulation_t
+ * @brief State shared between the threads of a threaded simulation
+ *
+ * @param c8 the `c8_t` being simulated (only used by the emulation thread)
+ * @param frames completed frames, from the emulation thread to the render thread
+ * @param keys keys currently held down (same layout as `c8->keys`)
+ * @param pressed last key pressed or released (return value of `c8_tick`), or
+ * -1 if none since the last frame
+ * @param quit set by the render thread when the window is closed
+ * @param done set by the emulation thread when it exits
+ */
+typedef struct {
+    c8_t* c8;
+    frame_exchange_t frames;
+    atomic_uint keys;
+    atomic_int pressed;
+    atomic_int quit;
+    atomic_int done;
+} emulation_t;
 
 static void draw(c8_t*, uint16_t);
+static void* emulate(void*);
+static void emulate_frame(c8_t*, int*);
+static int execute(c8_t*, int);
+static void handle_input(c8_t*, int, int*);
 static int load_rom(c8_t*, const char*);
+static uint32_t pack_keys(const int*);
+static int run_frame(c8_t*, int, int*);
+static int simulate_threaded(c8_t*);
+static int64_t timespec_diff(const struct timespec*, const struct timespec*);
+static void wait_frame(c8_t*, struct timespec*, long*);
 
 /**
- * @brief Deinitialize graphics and free c8
+ * @brief Free c8
  *
  * @param c8 `c8_t` to deinitialize
  */
 void c8_deinit(c8_t* c8) {
-    c8_deinit_graphics();
+    jit_free(c8);
+    rewind_free(c8);
+    undo_free(c8);
+    trace_close(c8);
+    profile_close(c8);
+    free(c8->cold);
     free(c8);
 }
 
@@ -38,34 +91,71 @@ void c8_deinit(c8_t* c8) {
  * @brief Initialize and return a `c8_t` with the given flags
  *
  * This function allocates memory for a new `c8_t` with all values set to 0
- * or their default values, adds the font to memory, inititializes the graphics
- * system, and returns a pointer to the `c8_t`.
+ * or their default values, adds the font to memory, and returns a pointer to
+ * the `c8_t`. The graphics system is not initialized until `c8_simulate` is
+ * called, so a `c8_t` can be run headless with `c8_run`.
  *
  * @param path path to ROM file
  * @param flags flags
  *
- * @return pointer to initialized `c8_t`.
+ * @return pointer to initialized `c8_t`, NULL if the ROM could not be loaded
  */
 c8_t* c8_init(const char* path, int flags) {
-    int res;
+    c8_t* c8 = c8_init_mem(NULL, 0, flags);
 
-    c8_t* c8 = (c8_t*)calloc(1, sizeof(c8_t));
+    if (c8 && load_rom(c8, path) < 0) {
+        c8_deinit(c8);
+        return NULL;
+    }
+    return c8;
+}
+
+/**
+ * @brief Initialize and return a `c8_t` running a ROM already in memory
+ *
+ * Same as `c8_init`, but copies the ROM from `rom` instead of loading it from
+ * a file.
+ *
+ * @param rom ROM contents (can be NULL if `size` is 0)
+ * @param size size of `rom` in bytes
+ * @param flags flags
+ *
+ * @return pointer to initialized `c8_t`.
+ */
+c8_t* c8_init_mem(const uint8_t* rom, size_t size, int flags) {
+    c8_t* c8 = (c8_t*)aligned_alloc(C8_CACHE_LINE, sizeof(c8_t));
 
     if (!c8) {
         C8_EXCEPTION(MEMORY_ALLOCATION_EXCEPTION, "At %s", __func__);
         return NULL;
     }
+    memset(c8, 0, sizeof(c8_t));
+
+    c8->cold = (c8_cold_t*)calloc(1, sizeof(c8_cold_t));
+    if (!c8->cold) {
+        C8_EXCEPTION(MEMORY_ALLOCATION_EXCEPTION, "At %s", __func__);
+        free(c8);
+        return NULL;
+    }
+
+    if (size > C8_MEMSIZE - C8_PROG_START) {
+        C8_EXCEPTION(FILE_TOO_BIG_EXCEPTION, "ROM too big: %zu bytes", size);
+        size = C8_MEMSIZE - C8_PROG_START;
+    }
 
     c8->flags = flags;
+    c8->pc = C8_PROG_START;
+    c8->running = 1;
     c8->cs = C8_CLOCK_SPEED;
-    c8->colors[1] = 0xFFFFFF;
+    c8->cold->colors[1] = 0xFFFFFF;
     c8->display.mode = C8_DISPLAYMODE_HIGH;
     c8->mode = C8_MODE_CHIP8;
+    random_seed(&c8->rng, 0);
 
-
-    load_rom(c8, path);
+    if (size) {
+        memcpy(c8->mem + C8_PROG_START, rom, size);
+    }
     c8_set_fonts(c8, 0, 0);
-    c8_init_graphics();
     return c8;
 }
 
@@ -78,10 +168,9 @@ c8_t* c8_init(const char* path, int flags) {
  * @return 1 if success
  */
 int c8_load_palette_s(c8_t* c8, char* s) {
-    char* c[2];
+    char* c[2] = { s, NULL };
     int len = strlen(s);
 
-    c[0] = s;
     for (int i = 0; i < len; i++) {
         if (s[i] == ',') {
             s[i] = '\0';
@@ -92,10 +181,11 @@ int c8_load_palette_s(c8_t* c8, char* s) {
     if (!c[1]) {
         C8_EXCEPTION(INVALID_COLOR_PALETTE_EXCEPTION,
             "Invalid color palette: %s", s);
+        return 0;
     }
 
     for (int i = 0; i < 2; i++) {
-        if ((c8->colors[i] = parse_int(c[i])) == -1) {
+        if ((c8->cold->colors[i] = parse_int(c[i])) == -1) {
             C8_EXCEPTION(INVALID_COLOR_PALETTE_EXCEPTION,
                 "Invalid color palette: %s", s);
         }
@@ -129,7 +219,7 @@ int c8_load_palette_f(c8_t* c8, const char* path) {
                 "Invalid color palette: %s", buf);
             return 0;
         }
-        c8->colors[i] = c;
+        c8->cold->colors[i] = c;
     }
 
     fclose(f);
@@ -155,17 +245,211 @@ void c8_load_quirks(c8_t* c8, const char* s) {
     }
 }
 
+/**
+ * @brief Go back `n` rewind snapshots
+ *
+ * Restores the state `c8` was in `n` snapshots ago (see `c8_set_rewind`).
+ * Newer snapshots are discarded. Flags, clock speed, and held keys are not
+ * restored.
+ *
+ * @param c8 the `c8_t` to rewind
+ * @param n number of snapshots to go back
+ *
+ * @return number of snapshots gone back, fewer than `n` if there are not
+ * enough (0 if rewinding is disabled)
+ */
+int c8_rewind(c8_t* c8, int n) {
+    n = rewind_restore(c8, n);
+    if (n) {
+        undo_clear(c8);
+    }
+    return n;
+}
+
+/**
+ * @brief Execute up to `max` instructions as fast as possible
+ *
+ * This is a headless alternative to `c8_simulate`: graphics are not used,
+ * input is not polled, the debug REPL is not entered, and there is no sleeping.
+ * Execution continues from the current state of `c8`, so this can be called
+ * repeatedly. The delay and sound timers tick after exactly the same
+ * instructions as in `c8_simulate`, so results do not depend on how execution
+ * is split between calls.
+ *
+ * If this returns `C8_STOP_KEY`, set the pressed key in `c8->keys` and clear
+ * `c8->waitingForKey` before calling it again.
+ *
+ * @param c8 the `c8_t` to execute
+ * @param max maximum number of instructions to execute
+ *
+ * @return reason execution stopped: `C8_STOP_BUDGET` if `max` instructions
+ * were executed, `C8_STOP_EXIT` if the program exited, `C8_STOP_KEY` if it is
+ * waiting for a key press, or `C8_STOP_ERROR` if an error occurred.
+ */
+int c8_run(c8_t* c8, uint64_t max) {
+    if (c8->cs <= 0) {
+        C8_EXCEPTION(INVALID_CLOCK_SPEED_EXCEPTION, "Clock speed must be greater than 0 (got %d).", c8->cs);
+        return C8_STOP_ERROR;
+    }
+
+    for (;;) {
+        if (!c8->running) {
+            return C8_STOP_EXIT;
+        }
+        if (c8->waitingForKey) {
+            return C8_STOP_KEY;
+        }
+        if (!max) {
+            return C8_STOP_BUDGET;
+        }
+
+        /* Stop at the next timer tick so the program sees the new timers */
+        uint64_t budget = timer_cycles_left(c8);
+        if (budget > max) {
+            budget = max;
+        }
+
+        int n = execute(c8, budget);
+        if (n < 0) {
+            return C8_STOP_ERROR;
+        }
+
+        timer_advance(c8, n);
+        c8->cycles += n;
+        max -= (uint64_t)n < max ? (uint64_t)n : max;
+    }
+}
+
+/**
+ * @brief Execute `n` frames (1/60th of a second each) as fast as possible
+ *
+ * Same as `c8_run`, but runs until the delay and sound timers have ticked `n`
+ * times instead of for a number of instructions. If rewinding is enabled,
+ * snapshots are taken as in `c8_simulate`.
+ *
+ * @param c8 the `c8_t` to execute
+ * @param n number of frames to execute
+ *
+ * @return reason execution stopped (see `c8_run`)
+ */
+int c8_run_frames(c8_t* c8, uint64_t n) {
+    if (c8->cs <= 0 || !n) {
+        return c8_run(c8, 0);
+    }
+
+    if (c8->cold->rewind) {
+        int reason = C8_STOP_BUDGET;
+
+        for (uint64_t i = 0; i < n && reason == C8_STOP_BUDGET; i++) {
+            reason = c8_run(c8, timer_cycles_left(c8));
+            if (reason == C8_STOP_BUDGET) {
+                rewind_frame(c8);
+            }
+        }
+        return reason;
+    }
+
+    return c8_run(c8, (n * c8->cs - c8->timerCycles + C8_FRAME_RATE - 1) / C8_FRAME_RATE);
+}
+
+/**
+ * @brief Seed the random number generator used by `RND`
+ *
+ * Each `c8_t` has its own generator, seeded with 0 by `c8_init`. Two `c8_t`s
+ * with the same seed, ROM, and input produce the same results.
+ *
+ * @param c8 the `c8_t` to seed
+ * @param seed seed
+ */
+void c8_seed(c8_t* c8, uint64_t seed) {
+    random_seed(&c8->rng, seed);
+}
+
+/**
+ * @brief Start or stop profiling
+ *
+ * While profiling, every instruction executed is counted by operation, by
+ * address, and by the subroutine it runs in (see profile.c). When profiling
+ * stops, including in `c8_deinit`, the counts are written to `path` in
+ * callgrind format (for tools such as KCachegrind or `callgrind_annotate`) and
+ * a summary is printed to `stderr`. Profiled programs always run in the
+ * interpreter.
+ *
+ * @param c8 the `c8_t` to profile
+ * @param path where to write the profile, or NULL to stop profiling
+ *
+ * @return 1 if successful, 0 otherwise
+ */
+int c8_set_profile(c8_t* c8, const char* path) {
+    return path ? profile_open(c8, path) : profile_close(c8);
+}
+
+/**
+ * @brief Enable, reconfigure, or disable rewinding
+ *
+ * When enabled, `c8_simulate` snapshots `c8` every `interval` frames into an
+ * in-memory ring, keeping as many snapshots as fit in `budget` bytes. Most
+ * snapshots are small deltas (see rewind.c), so a budget of a few megabytes
+ * holds minutes of history. Snapshots can be restored with `c8_rewind`, the
+ * rewind key, or the debugger's `rewind` command.
+ *
+ * @param c8 the `c8_t` to configure
+ * @param budget maximum bytes of snapshots to keep (0 to disable rewinding)
+ * @param interval frames between snapshots (`C8_REWIND_INTERVAL` if <= 0)
+ *
+ * @return 1 if successful, 0 otherwise
+ */
+int c8_set_rewind(c8_t* c8, size_t budget, int interval) {
+    return rewind_configure(c8, budget, interval);
+}
+
+/**
+ * @brief Set whether errors terminate the process
+ *
+ * By default, libc8 prints an error message and exits when an error occurs.
+ * When disabled, the message is still printed, and the failing function
+ * returns an exception code instead (`c8_run` returns `C8_STOP_ERROR`). This
+ * is process-wide and should be set before other threads use libc8.
+ *
+ * @param enable 1 to exit on errors (the default), 0 to return
+ */
+void c8_set_exit_on_exception(int enable) {
+    c8_exception_exit = enable;
+}
+
 /**
  * @brief Main interpreter simulation loop. Exits when `c8->running` is 0.
  *
+ * Execution is scheduled in frames of 1/60th of a second. Each frame, input is
+ * polled once, `c8->cs / 60` instructions are executed in a burst (the
+ * remainder, `c8->cs % 60`, is spread evenly across frames), the display is
+ * rendered if needed, and the loop sleeps until the next frame deadline on an
+ * absolute `CLOCK_MONOTONIC` timeline. Scheduling statistics are kept in
+ * `c8->cold->sched`.
+ *
+ * The delay and sound timers are advanced by each frame's instruction budget
+ * (see timer.c), so they tick at 60 Hz of emulated time regardless of `cs`.
+ * Frames end on the same instructions as in `c8_run_frames`.
+ *
+ * If `c8->recompiled` is set or `C8_FLAG_JIT` is set (and neither debug nor
+ * verbose mode is enabled), each frame's instructions are executed by
+ * recompiled code (see recompile.c) or translated code (see jit.c).
+ *
+ * If `C8_FLAG_THREADED` is set, emulation runs on a separate thread and the
+ * calling thread only polls input and renders, so a slow (e.g. vsync'd)
+ * present does not delay emulation. Completed frames are handed over through a
+ * lock-free triple buffer (see frame.c), and the latest one is rendered.
+ *
+ * The graphics system is initialized when this is called and deinitialized
+ * when it returns.
+ *
  * @param c8 the `c8_t` to simulate
  */
 void c8_simulate(c8_t* c8) {
-    int debugRet;
-    int ret;
+    struct timespec deadline;
+    long nsRem = 0;
     int step = 1;
-
-    srand(time(NULL));
+    int key[C8_KEY_COUNT] = { 0 };
 
     c8->pc = C8_PROG_START;
     c8->running = 1;
@@ -175,9 +459,18 @@ void c8_simulate(c8_t* c8) {
         return;
     }
 
+    memset(&c8->cold->sched, 0, sizeof(c8->cold->sched));
+    c8_init_graphics();
+
+    if (THREADED(c8) && simulate_threaded(c8)) {
+        c8_deinit_graphics();
+        return;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+
     while (c8->running) {
-        usleep(1000000 / c8->cs);
-        int t = c8_tick(c8->key);
+        int t = c8_tick(key);
 
         if (t == -2) {
             /* Quit */
@@ -185,60 +478,348 @@ void c8_simulate(c8_t* c8) {
             continue;
         }
 
-        if (c8->key[16]) {
-            /* Enter debug mode */
-            c8->flags |= C8_FLAG_DEBUG;
-            step = 1;
+        c8->keys = pack_keys(key);
+        handle_input(c8, t, &step);
+        emulate_frame(c8, &step);
+
+        if (c8->draw) {
+            c8_render(&c8->display, c8->cold->colors);
+            c8->draw = 0;
         }
 
-        if (c8->key[17]) {
-            /* Exit debug mode */
-            if (DEBUG(c8)) {
-                c8->flags ^= C8_FLAG_DEBUG;
-            }
+        wait_frame(c8, &deadline, &nsRem);
+    }
+
+    c8_deinit_graphics();
+}
+
+/**
+ * @brief Run `c8_simulate` with emulation on a separate thread
+ *
+ * The calling thread polls input, passes it to the emulation thread, and
+ * renders the latest completed frame until the emulation thread exits. Input
+ * and rendering stay on the calling thread because graphics libraries (SDL2
+ * in particular) require it to be the thread that initialized them.
+ *
+ * @param c8 the `c8_t` to simulate
+ *
+ * @return 1 if the simulation ran, 0 if the emulation thread could not be
+ * started
+ */
+static int simulate_threaded(c8_t* c8) {
+    const struct timespec idle = { 0, NSEC_PER_SEC / 1000 };
+    emulation_t* em = calloc(1, sizeof(emulation_t));
+    int key[C8_KEY_COUNT] = { 0 };
+    pthread_t thread;
+
+    if (!em) {
+        return 0;
+    }
+
+    em->c8 = c8;
+    frame_init(&em->frames);
+    atomic_init(&em->keys, 0);
+    atomic_init(&em->pressed, -1);
+    atomic_init(&em->quit, 0);
+    atomic_init(&em->done, 0);
+
+    if (pthread_create(&thread, NULL, emulate, em)) {
+        free(em);
+        return 0;
+    }
+
+    while (!atomic_load(&em->done)) {
+        int t = c8_tick(key);
+
+        if (t == -2) {
+            atomic_store(&em->quit, 1);
+        } else if (t >= 0) {
+            atomic_store(&em->pressed, t);
         }
 
-        if (DEBUG(c8) && (has_breakpoint(c8, c8->pc) || step)) {
-            /* Call debug REPL and process return value */
-            debugRet = debug_repl(c8);
+        atomic_store(&em->keys, pack_keys(key));
+
+        frame_t* f = frame_latest(&em->frames);
+        if (f) {
+            c8_render(&f->display, f->colors);
+        } else {
+            nanosleep(&idle, NULL);
+        }
+    }
+
+    pthread_join(thread, NULL);
+    free(em);
+    return 1;
+}
+
+/**
+ * @brief Emulation thread of `simulate_threaded`
+ *
+ * Runs the same frame loop as `c8_simulate`, taking input from and publishing
+ * frames to the `emulation_t` instead of calling the graphics system.
+ *
+ * @param arg the `emulation_t`
+ *
+ * @return NULL
+ */
+static void* emulate(void* arg) {
+    emulation_t* em = arg;
+    c8_t* c8 = em->c8;
+    struct timespec deadline;
+    long nsRem = 0;
+    int step = 1;
+
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
 
-            switch (debugRet) {
+    while (c8->running) {
+        if (atomic_load(&em->quit)) {
+            c8->running = 0;
+            break;
+        }
+
+        c8->keys = atomic_load(&em->keys);
+
+        handle_input(c8, atomic_exchange(&em->pressed, -1), &step);
+        emulate_frame(c8, &step);
+
+        if (c8->draw) {
+            frame_t* f = frame_back(&em->frames);
+            memcpy(&f->display, &c8->display, sizeof(c8_display_t));
+            memcpy(f->colors, c8->cold->colors, sizeof(f->colors));
+            frame_publish(&em->frames);
+            c8->draw = 0;
+        }
+
+        wait_frame(c8, &deadline, &nsRem);
+    }
+
+    atomic_store(&em->done, 1);
+    return NULL;
+}
+
+/**
+ * @brief Apply a frame's input to `c8`
+ *
+ * Enters or leaves debug mode if the debug keys are held, and delivers the
+ * key press `t` to the program if it is waiting for one.
+ *
+ * @param c8 the `c8_t` to apply input to
+ * @param t last key pressed or released this frame, or a negative value if none
+ * @param step set to 1 when entering debug mode
+ */
+static void handle_input(c8_t* c8, int t, int* step) {
+    if (C8_KEY_DOWN(c8, 16)) {
+        /* Enter debug mode */
+        c8->flags |= C8_FLAG_DEBUG;
+        *step = 1;
+    }
+
+    if (C8_KEY_DOWN(c8, 17)) {
+        /* Exit debug mode */
+        if (DEBUG(c8)) {
+            c8->flags ^= C8_FLAG_DEBUG;
+        }
+    }
+
+    if (t >= 0 && c8->waitingForKey) {
+        /* Waiting for key and a key was pressed */
+        c8->V[c8->VK] = t;
+        c8->waitingForKey = 0;
+    }
+}
+
+/**
+ * @brief Pack the key states filled in by `c8_tick` into a `c8->keys` bitmask
+ *
+ * @param key `C8_KEY_COUNT` key states (non-zero if held down)
+ *
+ * @return bitmask with bit n set if `key[n]` is held down
+ */
+static uint32_t pack_keys(const int* key) {
+    uint32_t keys = 0;
+
+    for (int i = 0; i < C8_KEY_COUNT; i++) {
+        keys |= (uint32_t)(key[i] != 0) << i;
+    }
+    return keys;
+}
+
+/**
+ * @brief Execute one frame's instructions and advance the timers
+ *
+ * While the rewind key is held and rewinding is enabled, the frame goes back
+ * one snapshot instead.
+ *
+ * @param c8 the `c8_t` to execute
+ * @param step 1 if stepping through instructions in debug mode
+ */
+static void emulate_frame(c8_t* c8, int* step) {
+    if (C8_KEY_DOWN(c8, C8_KEY_REWIND) && c8->cold->rewind) {
+        c8_rewind(c8, 1);
+        return;
+    }
+
+    /* Run until the next timer tick, i.e. `c8->cs / 60` on average */
+    int budget = timer_cycles_left(c8);
+
+    c8->cycles += run_frame(c8, budget, step);
+
+    /* The whole frame elapses, even while waiting for a key */
+    timer_advance(c8, budget);
+    rewind_frame(c8);
+}
+
+/**
+ * @brief Execute up to `budget` instructions for one frame
+ *
+ * In debug mode, the debug REPL is entered before each instruction at a
+ * breakpoint or while stepping, and each instruction is recorded in the undo
+ * log so the debugger can step backwards.
+ *
+ * @param c8 the `c8_t` to execute
+ * @param budget number of instructions to execute
+ * @param step 1 if stepping through instructions in debug mode
+ *
+ * @return number of instructions executed
+ */
+static int run_frame(c8_t* c8, int budget, int* step) {
+    int n = 0;
+
+    if (!DEBUG(c8)) {
+        n = execute(c8, budget);
+        return n > 0 ? n : 0;
+    }
+
+    while (n < budget && c8->running && !c8->waitingForKey) {
+        if (DEBUG(c8) && (has_breakpoint(c8, c8->pc) || *step)) {
+            /* Call debug REPL and process return value */
+            switch (debug_repl(c8)) {
             case DEBUG_QUIT:
                 c8->running = 0;
-                continue;
+                return n;
+            case DEBUG_CONTINUE:
+                *step = 0;
+                break;
             case DEBUG_STEP:
-                step = 1;
+                *step = 1;
                 break;
-
             }
         }
 
-        if (t >= 0 && c8->waitingForKey) {
-            /* Waiting for key and a key was pressed */
-            c8->V[c8->VK] = t;
-            c8->waitingForKey = 0;
+        undo_record(c8);
+        int ret = parse_instruction(c8);
+        if (ret < 0) {
+            break;
         }
 
-        if (!c8->waitingForKey) {
-            /* Not waiting for key, parse next instruction */
-            ret = parse_instruction(c8);
+        c8->pc += ret;
+        n++;
+    }
 
-            c8->pc += ret;
+    return n;
+}
 
-            if (c8->dt > 0) {
-                c8->dt--;
-            }
+/**
+ * @brief Execute up to `budget` instructions without debugging
+ *
+ * Execution stops early if `c8->running` is cleared or the program starts
+ * waiting for a key press. Recompiled or translated code is used if enabled
+ * (see `c8_simulate`), in which case the budget may be exceeded by up to one
+ * recompiled block.
+ *
+ * @param c8 the `c8_t` to execute
+ * @param budget number of instructions to execute
+ *
+ * @return number of instructions executed, or an exception code if an error
+ * occurs.
+ */
+static int execute(c8_t* c8, int budget) {
+    int n = 0;
 
-            if (c8->st > 0) {
-                c8->st--; // TODO sound
-            }
+    if (RECOMPILED(c8)) {
+        return c8_rc_execute(c8, budget);
+    }
+    if (JIT(c8)) {
+        return jit_execute(c8, budget);
+    }
 
-            if (c8->draw) {
-                c8_render(&c8->display, c8->colors);
-                c8->draw = 0;
-            }
+    while (n < budget && c8->running && !c8->waitingForKey) {
+        int ret = parse_instruction(c8);
+        if (ret < 0) {
+            return ret;
         }
+
+        c8->pc += ret;
+        n++;
+    }
+
+    return n;
+}
+
+/**
+ * @brief Sleep until the next frame deadline and update `c8->cold->sched`
+ *
+ * The deadline advances by exactly 1/60th of a second each frame (the
+ * fractional nanoseconds are carried in `nsRem`), so sleep overshoot does not
+ * accumulate. If the deadline has already passed, the frame is counted as an
+ * overrun and the loop continues immediately. If it is more than
+ * `C8_RESYNC_FRAMES` frames behind (e.g. after the debug REPL), the timeline is
+ * reset to the current time instead of running a burst of catch-up frames.
+ *
+ * @param c8 the `c8_t` being simulated
+ * @param deadline deadline of the current frame, advanced to the next frame
+ * @param nsRem fractional nanosecond remainder of the frame period
+ */
+static void wait_frame(c8_t* c8, struct timespec* deadline, long* nsRem) {
+    struct timespec now;
+    int64_t late;
+
+    deadline->tv_nsec += NSEC_PER_SEC / C8_FRAME_RATE;
+    *nsRem += NSEC_PER_SEC % C8_FRAME_RATE;
+    if (*nsRem >= C8_FRAME_RATE) {
+        deadline->tv_nsec++;
+        *nsRem -= C8_FRAME_RATE;
     }
+    if (deadline->tv_nsec >= NSEC_PER_SEC) {
+        deadline->tv_sec++;
+        deadline->tv_nsec -= NSEC_PER_SEC;
+    }
+
+    c8->cold->sched.frames++;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    late = timespec_diff(&now, deadline);
+
+    if (late > 0) {
+        /* Missed the deadline, don't sleep */
+        c8->cold->sched.overruns++;
+        if (late > C8_RESYNC_FRAMES * (NSEC_PER_SEC / C8_FRAME_RATE)) {
+            *deadline = now;
+            c8->cold->sched.resyncs++;
+        }
+    } else {
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, deadline, NULL) == EINTR);
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        late = timespec_diff(&now, deadline);
+    }
+
+    c8->cold->sched.drift = late;
+    c8->cold->sched.totalDrift += late;
+    if (late > c8->cold->sched.maxDrift) {
+        c8->cold->sched.maxDrift = late;
+    }
+}
+
+/**
+ * @brief Get `a - b` in nanoseconds
+ *
+ * @param a time to subtract from
+ * @param b time to subtract
+ *
+ * @return difference in nanoseconds
+ */
+static int64_t timespec_diff(const struct timespec* a, const struct timespec* b) {
+    return (int64_t)(a->tv_sec - b->tv_sec) * NSEC_PER_SEC + (a->tv_nsec - b->tv_nsec);
 }
 
 /**
@@ -247,7 +828,7 @@ void c8_simulate(c8_t* c8) {
  * @param c8 `c8_t` to store the ROM's contents
  * @param addr path to the ROM
  *
- * @return 1 if success.
+ * @return 1 if success, exception code otherwise (`c8->mem` is unchanged)
  */
 static int load_rom(c8_t* c8, const char* addr) {
     FILE* f;
@@ -262,9 +843,11 @@ static int load_rom(c8_t* c8, const char* addr) {
     /* Get file size */
     fseek(f, 0, SEEK_END);
     size = ftell(f);
-    if (ftell(f) > (0x1000 - 0x200)) {
+    if (size < 0 || size > C8_MEMSIZE - C8_PROG_START) {
         /* File is too big, failure */
         C8_EXCEPTION(FILE_TOO_BIG_EXCEPTION, "ROM file too big: %s", addr);
+        fclose(f);
+        return FILE_TOO_BIG_EXCEPTION;
     }
     rewind(f);
 
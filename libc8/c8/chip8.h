@@ -10,10 +10,23 @@
 #include "graphics.h"
 #include "defs.h"
 
+#include <stddef.h>
 #include <stdint.h>
 
 #define C8_CLOCK_SPEED 1000
+#define C8_FRAME_RATE 60
 #define C8_STACK_SIZE 16
+#define C8_CACHE_LINE 64
+
+/* Keys 0-F, plus the enter (16) and leave (17) debug mode and rewind keys */
+#define C8_KEY_COUNT 19
+#define C8_KEY_REWIND 18
+#define C8_KEY_DOWN(c, k) (((c)->keys >> (k)) & 1)
+
+/* Frames between rewind snapshots by default (see `c8_set_rewind`) */
+#define C8_REWIND_INTERVAL 6
+
+#define C8_BREAKPOINT(c, addr) (((c)->cold->breakpoints[(addr) >> 3] >> ((addr) & 7)) & 1)
 
 #define C8_MODE_CHIP8 0
 #define C8_MODE_SCHIP 1
@@ -26,62 +39,164 @@
 #define C8_FLAG_QUIRK_LOADSTORE 0x10
 #define C8_FLAG_QUIRK_SHIFT 0x20
 #define C8_FLAG_QUIRK_JUMP 0x40
+#define C8_FLAG_JIT 0x80
+#define C8_FLAG_THREADED 0x100
+#define C8_FLAG_TRACE 0x200
+#define C8_FLAG_PROFILE 0x400
+
+#define C8_STOP_BUDGET 0
+#define C8_STOP_EXIT 1
+#define C8_STOP_KEY 2
+#define C8_STOP_ERROR 3
+
+/**
+ * @struct c8_predecoded_t
+ * @brief Cached decoding of the instruction at one memory address
+ *
+ * @param op handler index (0 if the address has not been decoded yet)
+ * @param x x operand
+ * @param y y operand
+ * @param b b (nibble) operand
+ * @param kk kk (byte) operand
+ * @param nnn nnn (address) operand
+ */
+typedef struct {
+    uint8_t op;
+    uint8_t x;
+    uint8_t y;
+    uint8_t b;
+    uint8_t kk;
+    uint16_t nnn;
+} c8_predecoded_t;
+
+/**
+ * @struct c8_sched_stats_t
+ * @brief Frame scheduling statistics of `c8_simulate`
+ *
+ * Drift is how late the simulation loop woke up (or finished a frame, if it
+ * overran) relative to the frame's deadline, in nanoseconds.
+ *
+ * @param frames frames run
+ * @param overruns frames that finished after their deadline
+ * @param resyncs times the schedule was reset after falling too far behind
+ * @param drift drift of the last frame
+ * @param maxDrift largest drift of any frame
+ * @param totalDrift sum of the drift of all frames (divide by `frames` for
+ * the mean)
+ */
+typedef struct {
+    uint64_t frames;
+    uint64_t overruns;
+    uint64_t resyncs;
+    int64_t drift;
+    int64_t maxDrift;
+    int64_t totalDrift;
+} c8_sched_stats_t;
+
+ /**
+  * @struct c8_cold_t
+  * @brief Parts of a `c8_t` that are not used while executing instructions
+  *
+  * Allocated separately from the `c8_t` so that it does not take up room in
+  * the cache lines used by the interpreter.
+  *
+  * @param breakpoints debug breakpoint bitmap (see `C8_BREAKPOINT`)
+  * @param colors 24 bit hex colors, background=[0] foreground=[1]
+  * @param fonts font IDs (see font.c)
+  * @param sched frame scheduling statistics of `c8_simulate`
+  * @param rewind rewind snapshots (see rewind.c), or NULL if disabled
+  * @param undo debug mode undo log (see undo.c), or NULL if unused
+  * @param trace open execution trace (see trace.c), or NULL if not tracing
+  * @param profile instruction profile (see profile.c), or NULL if not profiling
+  */
+typedef struct {
+    uint8_t breakpoints[C8_MEMSIZE / 8];
+    int colors[2];
+    int fonts[2];
+    c8_sched_stats_t sched;
+    struct c8_rewind* rewind;
+    struct c8_undo* undo;
+    struct c8_trace* trace;
+    struct c8_profile* profile;
+} c8_cold_t;
 
  /**
   * @struct c8_t
   * @brief Represents current state of the CHIP-8 interpreter
   *
-  * @param mem CHIP-8 memory
-  * @param R flag registers
+  * Fields are ordered by how often the interpreter uses them: the registers
+  * share the first cache line, followed by the rest of the execution state,
+  * memory, the display, and the predecoded instruction cache. Everything else
+  * is in `cold`.
+  *
   * @param V V (general purpose) registers
+  * @param pc program counter
+  * @param I I (address) register
   * @param sp stack pointer
   * @param dt display timer
   * @param st sound timer
   * @param stack stack
-  * @param pc program counter
-  * @param I I (address) register
-  * @param key key press states
-  * @param VK V to store next keypress
-  * @param cs instructions to execute per second
+  * @param flags CLI flags
+  * @param mode interpreter mode (C8_MODE_CHIP8, C8_MODE_SCHIP, C8_MODE_XOCHIP)
+  * @param keys key press states, bit n is set while key n is held down (see
+  * `C8_KEY_COUNT`)
+  * @param draw need to draw? (1 or 0)
   * @param waitingForKey 1 or 0
   * @param running 1 or 0
+  * @param VK V to store next keypress
+  * @param cs instructions to execute per second
+  * @param timerCycles elapsed cycles since the last timer tick, times 60
+  * @param cycles total instructions executed
+  * @param rng state of the generator used by `RND` (see `c8_seed`)
+  * @param jit translated code cache (used with C8_FLAG_JIT, see jit.c)
+  * @param recompiled dispatcher of a ROM recompiled by `chip8rc` (see recompile.c)
+  * @param R flag registers
+  * @param cold debugger and UI state
+  * @param mem CHIP-8 memory
   * @param display graphics display
-  * @param flags CLI flags
-  * @param breakpoints debug breakpoint map
-  * @param colors 24 bit hex colors, background=[0] foreground=[1]
-  * @param fonts font IDs (see font.c)
-  * @param draw need to draw? (1 or 0)
-  * @param mode interpreter mode (C8_MODE_CHIP8, C8_MODE_SCHIP, C8_MODE_XOCHIP)
+  * @param predecoded predecoded instruction cache, indexed by address
   */
-typedef struct {
-    uint8_t mem[C8_MEMSIZE];
-    uint8_t R[8];
-    uint8_t V[16];
+typedef struct c8 {
+    _Alignas(C8_CACHE_LINE) uint8_t V[16];
+    uint16_t pc;
+    uint16_t I;
     uint8_t sp;
     uint8_t dt;
     uint8_t st;
     uint16_t stack[C8_STACK_SIZE];
-    uint16_t pc;
-    uint16_t I;
-    int key[18];
-    int VK;
-    int cs;
+    int flags;
+    int mode;
+    uint32_t keys;
+    int draw;
     int waitingForKey;
     int running;
+    int VK;
+    int cs;
+    int64_t timerCycles;
+    uint64_t cycles;
+    uint64_t rng;
+    struct c8_jit* jit;
+    int (*recompiled)(struct c8*);
+    uint8_t R[8];
+    c8_cold_t* cold;
+    _Alignas(C8_CACHE_LINE) uint8_t mem[C8_MEMSIZE];
     c8_display_t display;
-    int flags;
-    int breakpoints[C8_MEMSIZE];
-    int colors[2];
-    int fonts[2];
-    int draw;
-    int mode;
+    c8_predecoded_t predecoded[C8_MEMSIZE];
 } c8_t;
 
 void c8_deinit(c8_t*);
 c8_t* c8_init(const char*, int);
+c8_t* c8_init_mem(const uint8_t*, size_t, int);
 int c8_load_palette_s(c8_t*, char*);
 int c8_load_palette_f(c8_t*, const char*);
 void c8_load_quirks(c8_t*, const char*);
+int c8_rewind(c8_t*, int);
+int c8_run(c8_t*, uint64_t);
+void c8_set_exit_on_exception(int);
+int c8_run_frames(c8_t*, uint64_t);
+void c8_seed(c8_t*, uint64_t);
+int c8_set_profile(c8_t*, const char*);
+int c8_set_rewind(c8_t*, size_t, int);
 void c8_simulate(c8_t*);
 
 #endif
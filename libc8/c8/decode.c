@@ -15,11 +15,10 @@
 
 #define DEFINE_LABELS (args & C8_DECODE_DEFINE_LABELS)
 #define PRINT_ADDRESSES (args & C8_DECODE_PRINT_ADDRESSES)
-#define RESULT_SIZE 32
 
 static void find_labels(FILE*, uint8_t*);
 
-char result[RESULT_SIZE];
+static _Thread_local char result[C8_DECODE_MAX_LENGTH];
 
 /**
  * @brief Convert bytecode from `input` to assembly and writes it to `output`.
@@ -71,8 +70,23 @@ void c8_decode(FILE* input, FILE* output, int args) {
 /**
  * @brief Decode `in` and return its assembly value.
  *
- * Gets the assembly value of instruction `in`, stores it in the global
- * variable `result`, and returns `result`.
+ * Same as `c8_decode_instruction_r`, but stores the result in a buffer owned
+ * by the calling thread, which is overwritten by the next call on that thread.
+ *
+ * @param in The instruction to decode
+ * @param label_map The label map (can be NULL for no labels)
+ *
+ * @return `result` containing the associated assembly instruction
+ */
+char* c8_decode_instruction(uint16_t in, uint8_t* label_map) {
+    return c8_decode_instruction_r(in, label_map, result, sizeof(result));
+}
+
+/**
+ * @brief Decode `in` into `buf` and return `buf`.
+ *
+ * Gets the assembly value of instruction `in` and stores it in `buf`, which
+ * should be at least `C8_DECODE_MAX_LENGTH` bytes.
  *
  * If `label_map` is not `NULL`, it should point to an aray of size `MEMSIZE`,
  * with all "labeled" elements set to a unique, non-zero integer. All other
@@ -84,20 +98,20 @@ void c8_decode(FILE* input, FILE* output, int args) {
  *
  * @param in The instruction to decode
  * @param label_map The label map (can be NULL for no labels)
+ * @param buf where to store the assembly instruction
+ * @param size size of `buf`
  *
- * @return `result` containing the associated assembly instruction
+ * @return `buf`
  */
-char* c8_decode_instruction(uint16_t in, uint8_t* label_map) {
+char* c8_decode_instruction_r(uint16_t in, const uint8_t* label_map, char* buf, size_t size) {
     C8_EXPAND(in);
-    for (int i = 0; i < 16; i++) {
-        result[i] = '\0';
-    }
+    buf[0] = '\0';
 
     if ((in & 0xFFF0) == 0x00C0) {
         // Special case for SCD n
         // SCD is the only a=0 instruction that has a b parameter.
-        snprintf(result, RESULT_SIZE, "SCD 0x%01X", b);
-        return result;
+        snprintf(buf, size, "SCD 0x%01X", b);
+        return buf;
     }
     for (int i = 0; formats[i].cmd != I_NULL; i++) {
         if ((C8_A(formats[i].base) & a) == C8_A(in)) {
@@ -112,45 +126,45 @@ char* c8_decode_instruction(uint16_t in, uint8_t* label_map) {
             }
 
             if (match) {
-                snprintf(result, RESULT_SIZE, "%s", c8_instructionStrings[formats[i].cmd]);
+                snprintf(buf, size, "%s", c8_instructionStrings[formats[i].cmd]);
 
-                int idx = strlen(result);
+                int idx = strlen(buf);
                 for (int j = 0; j < formats[i].pcount; j++) {
                     if (j > 0) {
-                        snprintf(result + idx, RESULT_SIZE - idx, ",");
+                        snprintf(buf + idx, size - idx, ",");
                         idx++;
                     }
                     switch (formats[i].ptype[j]) {
                     case SYM_INT12:
-                        if (label_map[nnn]) {
-                            snprintf(result + idx, RESULT_SIZE - idx, " label%d", label_map[nnn]);
+                        if (label_map && label_map[nnn]) {
+                            snprintf(buf + idx, size - idx, " label%d", label_map[nnn]);
                         }
                         else {
-                            snprintf(result + idx, RESULT_SIZE - idx, " $%03X", nnn);
+                            snprintf(buf + idx, size - idx, " $%03X", nnn);
                         }
                         break;
                     case SYM_INT8:
-                        snprintf(result + idx, RESULT_SIZE - idx, " 0x%02X", (in & formats[i].pmask[j]) >> shift(formats[i].pmask[j]));
+                        snprintf(buf + idx, size - idx, " 0x%02X", (in & formats[i].pmask[j]) >> shift(formats[i].pmask[j]));
                         break;
                     case SYM_INT4:
-                        snprintf(result + idx, RESULT_SIZE - idx, " 0x%01X", (in & formats[i].pmask[j]) >> shift(formats[i].pmask[j]));
+                        snprintf(buf + idx, size - idx, " 0x%01X", (in & formats[i].pmask[j]) >> shift(formats[i].pmask[j]));
                         break;
                     case SYM_V:
-                        snprintf(result + idx, RESULT_SIZE - idx, " V%01X", (in & formats[i].pmask[j]) >> shift(formats[i].pmask[j]));
+                        snprintf(buf + idx, size - idx, " V%01X", (in & formats[i].pmask[j]) >> shift(formats[i].pmask[j]));
                         break;
                     default:
-                        snprintf(result + idx, RESULT_SIZE - idx, " %s", c8_identifierStrings[formats[i].ptype[j]]);
+                        snprintf(buf + idx, size - idx, " %s", c8_identifierStrings[formats[i].ptype[j]]);
                         break;
                     }
-                    idx = strlen(result);
+                    idx = strlen(buf);
                 }
-                return result;
+                return buf;
             }
         }
     }
 
-    snprintf(result, RESULT_SIZE, ".DW 0x%04X", in);
-    return result;
+    snprintf(buf, size, ".DW 0x%04X", in);
+    return buf;
 }
 
 /**
@@ -160,7 +174,7 @@ char* c8_decode_instruction(uint16_t in, uint8_t* label_map) {
  *
  * @return `in`'s `nnn` value if it exists, 0 otherwise.
  */
-uint16_t jump(uint16_t in) {
+uint16_t c8_jump(uint16_t in) {
     uint16_t a = C8_A(in);
 
     if (a == 0x1 || a == 0x2 || a == 0xa || a == 0xb) {
@@ -191,7 +205,7 @@ static void find_labels(FILE* input, uint8_t* labelMap) {
         }
         else {
             ins |= (uint16_t)c;
-            if ((to = jump(ins))) {
+            if ((to = c8_jump(ins))) {
                 labelMap[to] = count++;
             }
         }
@@ -7,14 +7,17 @@
 #ifndef LIBC8_DECODE_H
 #define LIBC8_DECODE_H
 
+#include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
 
 #define C8_DECODE_DEFINE_LABELS 0x1
 #define C8_DECODE_PRINT_ADDRESSES 0x2
+#define C8_DECODE_MAX_LENGTH 32
 
 void c8_decode(FILE*, FILE*, int);
 char* c8_decode_instruction(uint16_t, uint8_t*);
+char* c8_decode_instruction_r(uint16_t, const uint8_t*, char*, size_t);
 uint16_t c8_jump(uint16_t);
 
 #endif
@@ -6,274 +6,453 @@
 
 #include "encode.h"
 
+#include "private/arena.h"
 #include "private/symbol.h"
 #include "defs.h"
 #include "private/exception.h"
+#include "private/lexer.h"
 #include "private/util.h"
 
 #include <ctype.h>
+#include <fcntl.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
-static int initialize_labels(label_list_t*);
-static int initialize_symbols(symbol_list_t*);
-static int line_count(const char*);
-static int parse_line(char*, int, symbol_list_t*, label_list_t*);
-static int parse_word(char*, const char*, int, symbol_t*, const label_list_t*);
-static inline void put16(uint8_t*, uint16_t, int);
-static int tokenize(char**, char*, const char*, int);
-static int to_upper(char*);
-static char* remove_comma(char*);
-static int write(uint8_t*, symbol_list_t*, int);
+#define PROGRAM_SIZE (C8_MEMSIZE - C8_PROG_START)
 
-char** c8_lines;
-char** c8_lines_unformatted;
-int c8_line_count;
+/**
+ * @struct assembler_t
+ * @brief State of a `c8_encode()` call
+ *
+ * Bytecode is emitted as soon as an instruction is complete. Operands that
+ * reference labels which are not defined yet are emitted as 0 and recorded in
+ * `fixups`, to be patched once the whole source has been read.
+ *
+ * @param out bytecode output
+ * @param byte bytes emitted
+ * @param labels label list
+ * @param fixups unresolved label references
+ * @param ins instruction whose operands are being read
+ * @param pending 1 if `ins` has not been emitted yet
+ * @param label label index of each operand of `ins`, or -1
+ * @param lexer tokenizer over the source
+ * @param args arguments given by user
+ */
+typedef struct {
+    uint8_t* out;
+    int byte;
+    label_list_t labels;
+    fixup_list_t fixups;
+    instruction_t ins;
+    int pending;
+    int label[3];
+    lexer_t lexer;
+    int args;
+} assembler_t;
+
+static int add_fixup(assembler_t*, uint16_t, int);
+static int add_operand(assembler_t*, const symbol_t*);
+static int assemble_token(assembler_t*, const token_t*);
+static int define_label(assembler_t*, const char*, size_t);
+static int emit(assembler_t*, uint16_t, int);
+static int emit_data(assembler_t*, Symbol);
+static int emit_instruction(assembler_t*);
+static int initialize_labels(label_list_t*, arena_t*);
+static int parse_word(const char*, size_t, int, symbol_t*, label_list_t*);
+static int patch_fixups(assembler_t*);
+static inline void put16(uint8_t*, uint16_t, int);
 
 /**
  * @brief Parse the given string
  *
- * This is the main assembler function.
- *
- * This function generates bytecode from the given assembly code.
+ * This is the main assembler function (see `c8_encode_mem`).
  *
- * @param s string containing assembly code
+ * @param s null-terminated string containing assembly code
  * @param out pointer to write bytecode to
  * @param args command line arguments
  *
- * @return length of resulting bytecode.
+ * @return length of resulting bytecode, exception code if assembly failed
  */
 int c8_encode(const char* s, uint8_t* out, int args) {
-    char* scpy;
-    int len = strlen(s);
-    int count = 0;
-    c8_line_count = line_count(s);
-    label_list_t labels;
-    symbol_list_t symbols;
+    return c8_encode_mem(s, strlen(s), out, args);
+}
 
-    initialize_labels(&labels);
-    initialize_symbols(&symbols);
+/**
+ * @brief Assemble a source file
+ *
+ * The file is mapped into memory read-only and assembled in place (see
+ * `c8_encode_mem`).
+ *
+ * @param path source path
+ * @param out pointer to write bytecode to
+ * @param args command line arguments
+ *
+ * @return length of resulting bytecode, exception code if assembly failed
+ */
+int c8_encode_file(const char* path, uint8_t* out, int args) {
+    struct stat st;
+    int fd = open(path, O_RDONLY);
 
-    /* copy string and ensure newline at end */
-    if (s[len - 1] == '\n') {
-        scpy = strndup(s, len);
-    }
-    else {
-        scpy = strndup(s, len + 1);
-        scpy[len] = '\n';
-        scpy[len + 1] = '\0';
-    }
-
-    VERBOSE_PRINT(args, "Getting tokens from input");
-    c8_lines = (char**)malloc(c8_line_count * sizeof(char*));
-    c8_line_count = tokenize(c8_lines, scpy, "\n", c8_line_count);
-
-    /*Copy lines to c8_lines_unformatted */
-    c8_lines_unformatted = (char**)malloc(c8_line_count * sizeof(char*));
-    for (int i = 0; i < c8_line_count; i++) {
-        c8_lines_unformatted[i] = strdup(c8_lines[i]);
-        trim(c8_lines[i]);
-        if (strlen(c8_lines[i]) == 0) {
-            // empty line
-            free(c8_lines_unformatted[i]);
-            c8_lines_unformatted[i] = NULL;
-        }
+    if (fd < 0) {
+        C8_EXCEPTION(LOAD_FILE_FAILURE_EXCEPTION, "Could not open source: %s", path);
+        return LOAD_FILE_FAILURE_EXCEPTION;
     }
 
-    VERBOSE_PRINT(args, "Populating identifiers in label map\n");
-    populate_labels(&labels);
+    if (fstat(fd, &st)) {
+        C8_EXCEPTION(LOAD_FILE_FAILURE_EXCEPTION, "Could not open source: %s", path);
+        close(fd);
+        return LOAD_FILE_FAILURE_EXCEPTION;
+    }
+    if (st.st_size == 0) {
+        close(fd);
+        return c8_encode_mem("", 0, out, args);
+    }
 
-    VERBOSE_PRINT(args, "Populating symbol list\n");
-    for (int i = 0; i < c8_line_count; i++) {
-        parse_line(c8_lines[i], i + 1, &symbols, &labels);
+    void* data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        C8_EXCEPTION(LOAD_FILE_FAILURE_EXCEPTION, "Could not map source: %s", path);
+        return LOAD_FILE_FAILURE_EXCEPTION;
     }
 
-    VERBOSE_PRINT(args, "Resolving label addresses\n");
-    resolve_labels(&symbols, &labels);
+    int ret = c8_encode_mem(data, st.st_size, out, args);
+    munmap(data, st.st_size);
+    return ret;
+}
+
+/**
+ * @brief Assemble source in memory
+ *
+ * This function generates bytecode from the given assembly code in a single
+ * pass over the source, which is read in place. Forward label references are
+ * patched at the end.
+ *
+ * @param s assembly code (need not be null-terminated)
+ * @param len length of `s`
+ * @param out pointer to write bytecode to
+ * @param args command line arguments
+ *
+ * @return length of resulting bytecode, exception code if assembly failed
+ */
+int c8_encode_mem(const char* s, size_t len, uint8_t* out, int args) {
+    arena_t arena = { NULL };
+    assembler_t a = { out, 0 };
+    token_t token;
+    int ret = 1;
 
-    VERBOSE_PRINT(args, "Substituting label addresses in symbol table\n");
-    substitute_labels(&symbols, &labels);
+    if (initialize_labels(&a.labels, &arena) < 0) {
+        return MEMORY_ALLOCATION_EXCEPTION;
+    }
+    a.fixups.arena = &arena;
+    a.args = args;
+    lexer_init(&a.lexer, s, len);
+    c8_source_end = s + len;
+
+    VERBOSE_PRINT(args, "Assembling\n");
+    while (ret >= 0 && next_token(&a.lexer, &token) != TOKEN_END) {
+        c8_line = s + a.lexer.line;
+        ret = assemble_token(&a, &token);
+    }
 
-    VERBOSE_PRINT(args, "Writing output\n");
-    count = write(out, &symbols, args);
+    if (ret >= 0 && (ret = emit_instruction(&a)) >= 0) {
+        VERBOSE_PRINT(args, "Resolving %d forward label references\n", a.fixups.len);
+        ret = patch_fixups(&a);
+    }
 
-    free(scpy);
-    free(symbols.s);
-    free(labels.l);
-    free(c8_lines);
-    free(c8_lines_unformatted);
-    return count;
+    arena_free(&arena);
+    c8_line = NULL;
+    c8_source_end = NULL;
+    return ret < 0 ? ret : a.byte;
 }
 
 /**
- * @brief Remove comment from string if exists
+ * @brief Record a label reference to patch once the label is defined
+ *
+ * @param a assembler
+ * @param mask bits of the instruction at the current byte the address goes in
+ * @param label label index
  *
- * @param s string to remove comment from
- * @return string without comment
+ * @return 1 if success, exception code otherwise
  */
-char* remove_comment(char* s) {
-    if (s[0] == ';') {
-        s[0] = '\0';
-        return s;
+static int add_fixup(assembler_t* a, uint16_t mask, int label) {
+    fixup_list_t* fixups = &a->fixups;
+    if (fixups->len == fixups->ceil) {
+        int ceil = fixups->ceil ? fixups->ceil * 2 : FIXUP_CEILING;
+        fixup_t* f = (fixup_t*)arena_alloc(fixups->arena, ceil * sizeof(fixup_t));
+        if (!f) {
+            return MEMORY_ALLOCATION_EXCEPTION;
+        }
+        if (fixups->len) {
+            memcpy(f, fixups->f, fixups->len * sizeof(fixup_t));
+        }
+        fixups->f = f;
+        fixups->ceil = ceil;
     }
 
-    if (strlen(s) < 2) {
-        return s;
+    fixup_t* f = &fixups->f[fixups->len++];
+    f->byte = a->byte;
+    f->mask = mask;
+    f->label = label;
+    f->ln = a->lexer.ln;
+    return 1;
+}
+
+/**
+ * @brief Add an operand to the pending instruction
+ *
+ * Operands outside an instruction are ignored. A label becomes a 12-bit
+ * integer, holding its address if it is already defined.
+ *
+ * @param a assembler
+ * @param sym operand
+ *
+ * @return 1 if success, exception code otherwise
+ */
+static int add_operand(assembler_t* a, const symbol_t* sym) {
+    instruction_t* ins = &a->ins;
+    if (!a->pending) {
+        return 1;
+    }
+    if (ins->pcount == 3) {
+        C8_EXCEPTION(INVALID_INSTRUCTION_EXCEPTION, "Too many operands.\nLine %d: %.*s", a->lexer.ln, line_length(c8_line, c8_source_end), c8_line);
+        return INVALID_INSTRUCTION_EXCEPTION;
     }
 
-    for (size_t i = 1; i < strlen(s); i++) {
-        if (s[i] == ';' && isspace(s[i - 1])) {
-            s[i - 1] = '\0';
+    int j = ins->pcount++;
+    ins->ptype[j] = sym->type;
+    ins->p[j] = sym->value;
+    a->label[j] = -1;
+    if (sym->type == SYM_LABEL) {
+        const label_t* l = &a->labels.l[sym->value];
+        if (l->byte >= C8_MEMSIZE) {
+            C8_EXCEPTION(FILE_TOO_BIG_EXCEPTION, "Label is past the end of memory.\nLine %d: %s", a->lexer.ln, l->identifier);
+            return FILE_TOO_BIG_EXCEPTION;
         }
+        ins->ptype[j] = SYM_INT12;
+        ins->p[j] = l->byte >= 0 ? l->byte : 0;
+        a->label[j] = l->byte >= 0 ? -1 : sym->value;
+    }
+    return 1;
+}
+
+/**
+ * @brief Generate bytecode for a token
+ *
+ * @param a assembler
+ * @param token token to assemble
+ *
+ * @return 1 if success, exception code otherwise
+ */
+static int assemble_token(assembler_t* a, const token_t* token) {
+    const char* s = a->lexer.s + token->offset;
+    symbol_t sym = { SYM_NULL };
+    int ret;
+
+    switch (token->kind) {
+    case TOKEN_NEWLINE:
+        /* operands do not continue on the next line */
+        return emit_instruction(a);
+    case TOKEN_LABEL_DEFINITION:
+        return define_label(a, s, token->len);
+    default:
+        break;
+    }
+
+    if ((ret = parse_word(s, token->len, a->lexer.ln, &sym, &a->labels)) < 0) {
+        return ret;
     }
 
-    return s;
+    switch (sym.type) {
+    case SYM_INSTRUCTION:
+        if ((ret = emit_instruction(a)) < 0) {
+            return ret;
+        }
+        memset(&a->ins, 0, sizeof(a->ins));
+        a->ins.cmd = (Instruction)sym.value;
+        a->ins.line = a->lexer.ln;
+        a->pending = 1;
+        return 1;
+    case SYM_DB:
+    case SYM_DW:
+        return emit_data(a, sym.type);
+    default:
+        return add_operand(a, &sym);
+    }
 }
 
 /**
- * @brief Initialize label list
+ * @brief Define a label at the current byte
  *
- * @param labels label list to initialize
+ * @param a assembler
+ * @param s identifier (need not be null-terminated)
+ * @param len length of identifier
  *
  * @return 1 if success, exception code otherwise
  */
-static int initialize_labels(label_list_t* labels) {
-    labels->l = (label_t*)calloc(LABEL_CEILING, sizeof(label_t));
-    if (!labels->l) {
-        C8_EXCEPTION(MEMORY_ALLOCATION_EXCEPTION, "At function %s", __func__);
-        return MEMORY_ALLOCATION_EXCEPTION;
+static int define_label(assembler_t* a, const char* s, size_t len) {
+    int ret;
+    if ((ret = emit_instruction(a)) < 0) {
+        return ret;
+    }
+    if ((ret = get_label(&a->labels, s, len)) < 0) {
+        return ret;
     }
 
-    labels->len = 0;
-    labels->ceil = LABEL_CEILING;
+    label_t* l = &a->labels.l[ret];
+    if (l->byte >= 0) {
+        C8_EXCEPTION(DUPLICATE_LABEL_EXCEPTION, "Duplicate label definition.\nLine %d: %.*s", a->lexer.ln, line_length(c8_line, c8_source_end), c8_line);
+        return DUPLICATE_LABEL_EXCEPTION;
+    }
+    l->byte = C8_PROG_START + a->byte;
     return 1;
 }
 
 /**
- * @brief Initialize symbol list
+ * @brief Write 1 or 2 bytes of bytecode
  *
- * @param symbols symbol list to initialize
+ * @param a assembler
+ * @param n value to write
+ * @param size number of bytes
  *
  * @return 1 if success, exception code otherwise
  */
-static int initialize_symbols(symbol_list_t* symbols) {
-    symbols->s = (symbol_t*)calloc(SYMBOL_CEILING, sizeof(symbol_t));
-    if (!symbols->s) {
-        C8_EXCEPTION(MEMORY_ALLOCATION_EXCEPTION, "At function %s", __func__);
-        return MEMORY_ALLOCATION_EXCEPTION;
+static int emit(assembler_t* a, uint16_t n, int size) {
+    if (a->byte + size > PROGRAM_SIZE) {
+        C8_EXCEPTION(FILE_TOO_BIG_EXCEPTION, "Program too big.\nLine %d: %.*s", a->lexer.ln, line_length(c8_line, c8_source_end), c8_line);
+        return FILE_TOO_BIG_EXCEPTION;
     }
 
-    symbols->len = 0;
-    symbols->ceil = SYMBOL_CEILING;
+    if (size == 1) {
+        a->out[a->byte] = n;
+    }
+    else {
+        put16(a->out, n, a->byte);
+    }
+    a->byte += size;
     return 1;
 }
 
 /**
- * @brief Get line count of s
+ * @brief Write the value of a `.DB` or `.DW` directive
+ *
+ * The value is the next word on the line.
  *
- * @param s string to count lines from
+ * @param a assembler
+ * @param type `SYM_DB` or `SYM_DW`
  *
- * @return line count
+ * @return 1 if success, exception code otherwise
  */
-static int line_count(const char* s) {
-    int ln = 1;
-    while (*s) {
-        if (*s == '\n') {
-            ln++;
-        }
-        s++;
+static int emit_data(assembler_t* a, Symbol type) {
+    token_t token;
+    int value = -1;
+    int max = type == SYM_DB ? UINT8_MAX : UINT16_MAX;
+    int ret;
+
+    if ((ret = emit_instruction(a)) < 0) {
+        return ret;
+    }
+    if (next_token(&a->lexer, &token) == TOKEN_WORD) {
+        value = parse_int_n(a->lexer.s + token.offset, token.len);
+    }
+    if (value < 0 || value > max) {
+        C8_EXCEPTION(INVALID_ARGUMENT_EXCEPTION, "Invalid %s value.\nLine %d: %.*s", type == SYM_DB ? S_DB : S_DW, a->lexer.ln, line_length(c8_line, c8_source_end), c8_line);
+        return INVALID_ARGUMENT_EXCEPTION;
     }
-    return ln;
+
+    return emit(a, value, type == SYM_DB ? 1 : 2);
 }
 
 /**
- * @brief Generate symbols for the given line
+ * @brief Write the pending instruction, if any
  *
- * @param s line string
- * @param ln line number
- * @param symbols symbol list
- * @param labels label list
+ * Operands referencing labels that are not defined yet are recorded as
+ * fixups.
+ *
+ * @param a assembler
  *
  * @return 1 if success, exception code otherwise
  */
-static int parse_line(char* s, int ln, symbol_list_t* symbols, label_list_t* labels) {
-    if (strlen(s) == 0 || strlen(remove_comment(s)) == 0 || strlen((s = trim(s))) == 0) {
-        // empty line
+static int emit_instruction(assembler_t* a) {
+    if (!a->pending) {
         return 1;
     }
+    a->pending = 0;
 
-    symbol_t* sym = next_symbol(symbols);
-    char* words[C8_ENCODE_MAX_WORDS];
-    int wc = tokenize(words, s, " ", C8_ENCODE_MAX_WORDS);
-    int ret = 0;
+    int ret = build_instruction(&a->ins);
+    if (ret < 0) {
+        return ret;
+    }
 
-    for (int i = 0; i < wc; i++) {
-        if (i == wc - 1) {
-            i += parse_word(words[i], NULL, ln, sym, labels);
-        }
-        else {
-            i += parse_word(words[i], words[i + 1], ln, sym, labels);
+    for (int j = 0; j < a->ins.pcount; j++) {
+        if (a->label[j] >= 0 && add_fixup(a, a->ins.format->pmask[j], a->label[j]) < 0) {
+            return MEMORY_ALLOCATION_EXCEPTION;
         }
-        sym = next_symbol(symbols);
+    }
+    return emit(a, ret, 2);
+}
+
+/**
+ * @brief Initialize label list
+ *
+ * @param labels label list to initialize
+ * @param arena arena to allocate labels from
+ *
+ * @return 1 if success, exception code otherwise
+ */
+static int initialize_labels(label_list_t* labels, arena_t* arena) {
+    labels->l = (label_t*)arena_calloc(arena, LABEL_CEILING, sizeof(label_t));
+    if (!labels->l) {
+        return MEMORY_ALLOCATION_EXCEPTION;
     }
 
+    labels->len = 0;
+    labels->ceil = LABEL_CEILING;
+    labels->table = NULL;
+    labels->tableSize = 0;
+    labels->arena = arena;
     return 1;
 }
 
 /**
  * @brief Generate symbol for the given word
  *
- * @param s word string
- * @param next next word string
+ * Words are matched ignoring case. Words that are nothing else and start with
+ * a letter or `_` are label references. Labels that are not in the label list
+ * yet are added to it, undefined, so they can be referenced before their
+ * definition.
+ *
+ * @param s word (need not be null-terminated)
+ * @param len length of word
  * @param ln line number
  * @param sym symbol to populate
  * @param labels label list
  *
- * @return number of words to skip
+ * @return 0 if success, exception code if the word is invalid
  */
-static int parse_word(char* s, const char* next, int ln, symbol_t* sym, const label_list_t* labels) {
+static int parse_word(const char* s, size_t len, int ln, symbol_t* sym, label_list_t* labels) {
     int value;
     sym->ln = ln;
-    s = remove_comma(s);
-    s = trim(s);
-    to_upper(s);
-
-    if (is_label_definition(s) == 1) {
-        sym->type = SYM_LABEL_DEFINITION;
-        for (int j = 0; j < labels->len; j++) {
-            if (!strcmp(s, labels->l[j].identifier)) {
-                sym->value = j;
-            }
-        }
-        return 0;
-    }
-    else if ((value = is_instruction(s)) >= 0) {
+
+    if ((value = is_instruction(s, len)) >= 0) {
         sym->type = SYM_INSTRUCTION;
         sym->value = value;
         return 0;
     }
-    else if (is_db(s) && next) {
-        sym->type = SYM_DB;
-        sym->value = parse_int(next);
-        return 1;
-    }
-    else if (is_dw(s) && next) {
-        sym->type = SYM_DW;
-        sym->value = parse_int(next);
-        return 1;
-    }
-    else if ((value = is_register(s)) >= 0) {
+    else if ((value = is_register(s, len)) >= 0) {
         sym->type = SYM_V;
         sym->value = value;
         return 0;
     }
-    else if ((value = is_reserved_identifier(s)) >= 0) {
+    else if ((value = is_reserved_identifier(s, len)) > 0) {
         sym->type = (Symbol)value;
         return 0;
     }
-    else if ((value = parse_int(s)) > -1) {
+    else if ((value = parse_int_n(s, len)) > -1) {
         if (value < 0x10) {
             sym->type = SYM_INT4;
         }
@@ -289,122 +468,56 @@ static int parse_word(char* s, const char* next, int ln, symbol_t* sym, const la
         sym->value = value;
         return 0;
     }
-    else if ((value = is_label(s, labels)) >= 0) {
+    else if (len && (isalpha((unsigned char)s[0]) || s[0] == '_')) {
+        if ((value = get_label(labels, s, len)) < 0) {
+            return value;
+        }
         sym->type = SYM_LABEL;
         sym->value = value;
         return 0;
     }
 
-    C8_EXCEPTION(INVALID_SYMBOL_EXCEPTION, "Line %d: Invalid symbol '%s'", ln, s);
+    C8_EXCEPTION(INVALID_SYMBOL_EXCEPTION, "Line %d: Invalid symbol '%.*s'", ln, (int)len, s);
     return INVALID_SYMBOL_EXCEPTION;
 }
 
 /**
- * @brief Write 16 bit int to f
+ * @brief Patch forward label references with the labels' addresses
  *
- * @param output where to write
- * @param n index to write to
- */
-static inline void put16(uint8_t* output, uint16_t n, int idx) {
-    output[idx] = (n >> 8) & 0xFF;
-    output[idx + 1] = n & 0xFF;
-}
-
-/**
- * @brief split string into token array separated by delimeter
+ * If a referenced label was never defined, it throws an
+ * `INVALID_SYMBOL_EXCEPTION`.
  *
- * @param tok token array
- * @param s string to tokenize
- * @param delim delimeter to separate tokens
- * @param maxTokens maximum number of tokens
+ * @param a assembler
  *
- * @return number of tokens
+ * @return 1 if success, exception code otherwise
  */
-static int tokenize(char** tok, char* s, const char* delim, int maxTokens) {
-    int tokenCount = 0;
-    char* token = strtok(s, delim);
-    while (token && tokenCount < maxTokens) {
-        tok[tokenCount++] = token;
-        token = strtok(NULL, delim);
-    }
-
-    return tokenCount;
-}
+static int patch_fixups(assembler_t* a) {
+    for (int i = 0; i < a->fixups.len; i++) {
+        const fixup_t* f = &a->fixups.f[i];
+        const label_t* l = &a->labels.l[f->label];
+        if (l->byte < 0) {
+            C8_EXCEPTION(INVALID_SYMBOL_EXCEPTION, "Label does not exist.\nLine %d: %s", f->ln, l->identifier);
+            return INVALID_SYMBOL_EXCEPTION;
+        }
+        if (l->byte >= C8_MEMSIZE) {
+            C8_EXCEPTION(FILE_TOO_BIG_EXCEPTION, "Label is past the end of memory.\nLine %d: %s", f->ln, l->identifier);
+            return FILE_TOO_BIG_EXCEPTION;
+        }
 
-/**
- * @brief Trim and remove comma from s if exists
- *
- * @param s string to remove comma from
- * @return string without comma
- */
-static char* remove_comma(char* s) {
-    trim(s);
-    if (s[strlen(s) - 1] == ',') {
-        s[strlen(s) - 1] = '\0';
+        uint16_t ins = (a->out[f->byte] << 8) | a->out[f->byte + 1];
+        put16(a->out, ins | ((l->byte << shift(f->mask)) & f->mask), f->byte);
     }
 
-    return s;
-}
-
-/**
- * @brief Convert all characters in null-terminated string s to uppercase
- *
- * @param s string to convert
- */
-static int to_upper(char* s) {
-    while (*s) {
-        *s = toupper(*s);
-        s++;
-    }
     return 1;
 }
 
 /**
- * @brief Convert symbols to bytes and write to output
- *
- * @param output output array
- * @param symbols symbol list
- * @param args arguments given by user
+ * @brief Write 16 bit int to f
  *
- * @return length of bytecode
+ * @param output where to write
+ * @param n index to write to
  */
-static int write(uint8_t* output, symbol_list_t* symbols, int args) {
-    int ret;
-    instruction_t ins;
-    int byte = 0;
-
-    for (int i = 0; i < symbols->len; i++) {
-        if (byte >= C8_MEMSIZE - C8_PROG_START) {
-            return TOO_MANY_SYMBOLS_EXCEPTION;
-        }
-
-        int ln = symbols->s[i].ln;
-        switch (symbols->s[i].type) {
-        case SYM_INSTRUCTION:
-            ret = build_instruction(&ins, symbols, i);
-            put16(output, ret, byte);
-            i += ins.pcount;
-            byte += 2;
-            break;
-        case SYM_DB:
-            if (symbols->s[i].value > UINT8_MAX) {
-                C8_EXCEPTION(INVALID_ARGUMENT_EXCEPTION,
-                    "DB value too big.\nLine %d: %s", ln, c8_lines_unformatted[ln]);
-                return INVALID_ARGUMENT_EXCEPTION;
-            }
-            else {
-                output[byte] = symbols->s[i].value;
-                byte++;
-            }
-            break;
-        case SYM_DW:
-            put16(output, symbols->s[i].value, byte);
-            byte += 2;
-            break;
-        default:
-            break;
-        }
-    }
-
-    return byte;
+static inline void put16(uint8_t* output, uint16_t n, int idx) {
+    output[idx] = (n >> 8) & 0xFF;
+    output[idx + 1] = n & 0xFF;
 }
@@ -7,19 +7,13 @@
 #ifndef LIBC8_PARSE_H
 #define LIBC8_PARSE_H
 
+#include <stddef.h>
 #include <stdint.h>
 
 #define ARG_VERBOSE 1
 
-#define C8_ENCODE_MAX_LINE_LENGTH 100
-#define C8_ENCODE_MAX_WORDS 100
-#define C8_ENCODE_MAX_LINES 500
-
-extern char **c8_lines;
-extern char **c8_lines_unformatted;
-extern int c8_line_count;
-
 int c8_encode(const char*, uint8_t*, int);
-char* remove_comment(char*);
+int c8_encode_file(const char*, uint8_t*, int);
+int c8_encode_mem(const char*, size_t, uint8_t*, int);
 
 #endif
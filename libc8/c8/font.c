@@ -8,6 +8,7 @@
 
 #include "chip8.h"
 #include "private/exception.h"
+#include "private/instruction.h"
 
 #include <stdint.h>
 #include <string.h>
@@ -221,13 +222,15 @@ const uint8_t bigFonts[3][160] = {
  */
 void c8_set_fonts(c8_t* c8, int small, int big) {
     if (small > -1 && small < 5) {
-        c8->fonts[0] = small;
+        c8->cold->fonts[0] = small;
         memcpy(&c8->mem[C8_FONT_START], smallFonts[small], 80);
+        invalidate_code(c8, C8_FONT_START, 80);
     }
 
     if (big > -1 && big < 3) {
-        c8->fonts[1] = big;
+        c8->cold->fonts[1] = big;
         memcpy(&c8->mem[C8_HIGH_FONT_START], bigFonts[big], 160);
+        invalidate_code(c8, C8_HIGH_FONT_START, 160);
     }
 }
 
@@ -314,6 +317,6 @@ int c8_set_big_font(c8_t* c8, const char* s) {
  * @param c8 `c8_t` to get fonts from
  */
 void print_fonts(c8_t* c8) {
-    printf("SFONT: %s\tBFONT: %s\n", c8_fontNames[0][c8->fonts[0]],
-        c8_fontNames[1][c8->fonts[1]]);
+    printf("SFONT: %s\tBFONT: %s\n", c8_fontNames[0][c8->cold->fonts[0]],
+        c8_fontNames[1][c8->cold->fonts[1]]);
 }
@@ -73,16 +73,25 @@ int __attribute__((weak)) c8_tick(int* key) {
 /**
  * @brief Get the value of (x,y) from `display`
  *
+ * Coordinates wrap around the edges of the display in its current mode.
+ *
  * @param display `display_t` to get pixel from
  * @param x the x value
  * @param y the y value
  *
- * @return pointer to value of (x,y) in `display`
+ * @return 1 if (x,y) is on, 0 otherwise
  */
-uint8_t* c8_get_pixel(c8_display_t* display, int x, int y) {
+int c8_get_pixel(const c8_display_t* display, int x, int y) {
+    int w = C8_LOW_DISPLAY_WIDTH;
+    int h = C8_LOW_DISPLAY_HEIGHT;
+
     if (display->mode == C8_DISPLAYMODE_HIGH) {
         x += display->x;
         y += display->y;
+        w = C8_HIGH_DISPLAY_WIDTH;
+        h = C8_HIGH_DISPLAY_HEIGHT;
     }
-    return &display->p[y * C8_LOW_DISPLAY_WIDTH + x];
+    x &= w - 1;
+    y &= h - 1;
+    return (display->p[y][x / 64] & C8_PIXEL_MASK(x)) != 0;
 }
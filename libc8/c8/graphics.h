@@ -3,7 +3,7 @@
  *
  * Function declarations for graphics display are here.
  *
- * Only `get_pixel` is strongly defined in graphics.c. Declarations are library
+ * Only `c8_get_pixel` is strongly defined in graphics.c. Declarations are library
  * agnostic so a different graphics backend can be used.
  */
 
@@ -26,21 +26,30 @@
 #define C8_DISPLAYMODE_LOW 0
 #define C8_DISPLAYMODE_HIGH 1
 
+#define C8_DISPLAY_WORDS (C8_HIGH_DISPLAY_WIDTH / 64)
+
+/* Mask of pixel `x` in its row word (the leftmost pixel is the MSB) */
+#define C8_PIXEL_MASK(x) (UINT64_C(0x8000000000000000) >> ((x) & 63))
+
  /**
   * @struct display_t
   *
-  * @param p pixels (1D array)
+  * Pixels are bit-packed, one bit per pixel, with `C8_DISPLAY_WORDS` words per
+  * row. Pixel (x,y) is `p[y][x / 64] & C8_PIXEL_MASK(x)`. In low resolution
+  * mode only the first word of the first `C8_LOW_DISPLAY_HEIGHT` rows is used.
+  *
+  * @param p pixel rows
   * @param mode display mode (`DISPLAY_STANDARD` or `DISPLAY_EXTENDED`)
   * @param x x offset (for `DISPLAY_EXTENDED`)
   * @param y y offset (for `DISPLAY_EXTENDED`)
   */
 typedef struct {
-    uint8_t p[C8_HIGH_DISPLAY_WIDTH * C8_HIGH_DISPLAY_HEIGHT];
+    uint64_t p[C8_HIGH_DISPLAY_HEIGHT][C8_DISPLAY_WORDS];
     uint8_t mode;
     uint8_t x, y;
 } c8_display_t;
 
-uint8_t* c8_get_pixel(c8_display_t*, int, int);
+int c8_get_pixel(const c8_display_t*, int, int);
 
 extern void c8_beep(void);
 extern void c8_deinit_graphics(void);
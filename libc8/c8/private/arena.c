@@ -0,0 +1,136 @@
+/**
+ * @file c8/private/arena.c
+ * @note NOT EXPORTED
+ *
+ * Bump allocator that grows in chunks and is freed in one shot.
+ */
+
+#include "arena.h"
+
+#include "exception.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ALIGN(n) (((n) + sizeof(max_align_t) - 1) & ~(sizeof(max_align_t) - 1))
+
+static arena_chunk_t* new_chunk(size_t);
+
+/**
+ * @brief Allocate memory from an arena
+ *
+ * The memory is aligned for any type and lives until `arena_free()`.
+ * Allocations larger than a quarter of `ARENA_CHUNK_SIZE` get a chunk of
+ * their own, behind the current one, so they do not waste what is left of it.
+ *
+ * @param arena arena to allocate from
+ * @param size bytes to allocate
+ *
+ * @return pointer to memory, NULL if allocation failed
+ */
+void* arena_alloc(arena_t* arena, size_t size) {
+    arena_chunk_t* c = arena->head;
+
+    size = ALIGN(size ? size : 1);
+    if (size > ARENA_CHUNK_SIZE / 4) {
+        if (!(c = new_chunk(size))) {
+            return NULL;
+        }
+        if (arena->head) {
+            c->next = arena->head->next;
+            arena->head->next = c;
+        }
+        else {
+            arena->head = c;
+        }
+    }
+    else if (!c || c->size - c->used < size) {
+        if (!(c = new_chunk(ARENA_CHUNK_SIZE))) {
+            return NULL;
+        }
+        c->next = arena->head;
+        arena->head = c;
+    }
+
+    void* p = (uint8_t*)c->data + c->used;
+    c->used += size;
+    return p;
+}
+
+/**
+ * @brief Allocate zeroed memory for an array from an arena
+ *
+ * @param arena arena to allocate from
+ * @param n number of elements
+ * @param size size of an element
+ *
+ * @return pointer to memory, NULL if allocation failed
+ */
+void* arena_calloc(arena_t* arena, size_t n, size_t size) {
+    if (size && n > SIZE_MAX / size) {
+        C8_EXCEPTION(MEMORY_ALLOCATION_EXCEPTION, "At function %s", __func__);
+        return NULL;
+    }
+
+    void* p = arena_alloc(arena, n * size);
+    if (p) {
+        memset(p, 0, n * size);
+    }
+    return p;
+}
+
+/**
+ * @brief Free all memory allocated from an arena
+ *
+ * The arena can be used again afterwards.
+ *
+ * @param arena arena to free
+ */
+void arena_free(arena_t* arena) {
+    arena_chunk_t* c = arena->head;
+    while (c) {
+        arena_chunk_t* next = c->next;
+        free(c);
+        c = next;
+    }
+    arena->head = NULL;
+}
+
+/**
+ * @brief Copy a string into an arena
+ *
+ * @param arena arena to allocate from
+ * @param s string to copy
+ * @param len length of `s` (need not be null-terminated)
+ *
+ * @return null-terminated copy, NULL if allocation failed
+ */
+char* arena_strndup(arena_t* arena, const char* s, size_t len) {
+    char* p = (char*)arena_alloc(arena, len + 1);
+    if (p) {
+        memcpy(p, s, len);
+        p[len] = '\0';
+    }
+    return p;
+}
+
+/**
+ * @brief Allocate a chunk
+ *
+ * @param size usable bytes in the chunk
+ *
+ * @return chunk, NULL if allocation failed
+ */
+static arena_chunk_t* new_chunk(size_t size) {
+    arena_chunk_t* c = (arena_chunk_t*)malloc(sizeof(arena_chunk_t) + size);
+    if (!c) {
+        C8_EXCEPTION(MEMORY_ALLOCATION_EXCEPTION, "At function %s", __func__);
+        return NULL;
+    }
+
+    c->next = NULL;
+    c->size = size;
+    c->used = 0;
+    return c;
+}
@@ -0,0 +1,46 @@
+/**
+ * @file c8/private/arena.h
+ * @note NOT EXPORTED
+ *
+ * Bump allocator that grows in chunks and is freed in one shot.
+ */
+
+#ifndef C8_ARENA_H
+#define C8_ARENA_H
+
+#include <stddef.h>
+
+#define ARENA_CHUNK_SIZE 0x10000
+
+/**
+ * @struct arena_chunk_t
+ * @brief A block of memory allocations are bumped from
+ *
+ * @param next next (older) chunk
+ * @param size usable bytes in `data`
+ * @param used bytes of `data` already handed out
+ * @param data memory handed out
+ */
+typedef struct arena_chunk {
+    struct arena_chunk* next;
+    size_t size;
+    size_t used;
+    max_align_t data[];
+} arena_chunk_t;
+
+/**
+ * @struct arena_t
+ * @brief Bump allocator, zero-initialize before use
+ *
+ * @param head chunk allocations are made from
+ */
+typedef struct {
+    arena_chunk_t* head;
+} arena_t;
+
+void* arena_alloc(arena_t*, size_t);
+void* arena_calloc(arena_t*, size_t, size_t);
+void arena_free(arena_t*);
+char* arena_strndup(arena_t*, const char*, size_t);
+
+#endif
@@ -10,7 +10,10 @@
 #include "../chip8.h"
 #include "..//font.h"
 #include "..//decode.h"
+#include "../state.h"
 #include "exception.h"
+#include "instruction.h"
+#include "undo.h"
 #include "util.h"
 
 #include <ctype.h>
@@ -38,6 +41,9 @@ typedef enum {
     CMD_QUIT,
     CMD_LOADFLAGS,
     CMD_SAVEFLAGS,
+    CMD_REWIND,
+    CMD_RSTEP,
+    CMD_RCONTINUE,
 } Command;
 
 /**
@@ -125,8 +131,12 @@ static void print_r_registers(const c8_t*);
 static void print_stack(const c8_t*);
 static void print_v_registers(const c8_t*);
 static void print_value(c8_t*, cmd_t*);
+static void reverse_continue(c8_t*);
+static void reverse_step(c8_t*, int);
+static void rewind_state(c8_t*, int);
 static void save_flags(const c8_t*, const char*);
 static void save_state(c8_t*, const char*);
+static void set_breakpoint(c8_t*, int, int);
 static int set_value(c8_t*, cmd_t*);
 
 /**
@@ -165,6 +175,9 @@ const char* cmds[] = {
     "quit",
     "loadflags",
     "saveflags",
+    "rewind",
+    "rstep",
+    "rcontinue",
 };
 
 /**
@@ -192,18 +205,18 @@ int debug_repl(c8_t* c8) {
             switch (cmd.id) {
             case CMD_ADD_BREAKPOINT:
                 if (cmd.arg.type == -1) {
-                    c8->breakpoints[c8->pc] = 1;
+                    set_breakpoint(c8, c8->pc, 1);
                 }
                 else {
-                    c8->breakpoints[cmd.arg.value.i] = 1;
+                    set_breakpoint(c8, cmd.arg.value.i, 1);
                 }
                 break;
             case CMD_RM_BREAKPOINT:
                 if (cmd.arg.value.i == -1) {
-                    c8->breakpoints[c8->pc] = 0;
+                    set_breakpoint(c8, c8->pc, 0);
                 }
                 else {
-                    c8->breakpoints[cmd.arg.value.i] = 0;
+                    set_breakpoint(c8, cmd.arg.value.i, 0);
                 }
                 break;
             case CMD_CONTINUE: return DEBUG_CONTINUE;
@@ -216,6 +229,9 @@ int debug_repl(c8_t* c8) {
             case CMD_QUIT: return DEBUG_QUIT;
             case CMD_LOADFLAGS: load_flags(c8, cmd.arg.value.s); break;
             case CMD_SAVEFLAGS: save_flags(c8, cmd.arg.value.s); break;
+            case CMD_REWIND: rewind_state(c8, cmd.arg.value.i); break;
+            case CMD_RSTEP: reverse_step(c8, cmd.arg.value.i); break;
+            case CMD_RCONTINUE: reverse_continue(c8); break;
             case CMD_NONE: printf("Invalid command\n"); break;
             }
         }
@@ -246,7 +262,7 @@ int debug_repl(c8_t* c8) {
  * @return 1 if yes, 0 if no
  */
 int has_breakpoint(c8_t* c8, uint16_t pc) {
-    return c8->breakpoints[pc];
+    return C8_BREAKPOINT(c8, pc);
 }
 
 /**
@@ -310,21 +326,21 @@ static void load_flags(c8_t* c8, const char* path) {
 }
 
 /**
- * @brief Load `c8_t` from file.
+ * @brief Load `c8_t` from a savestate (see `c8_load_state`).
+ *
+ * An invalid savestate is reported without leaving debug mode.
  *
  * @param c8 struct to load to
  * @param path path to load from
  */
 static void load_state(c8_t* c8, const char* path) {
-    FILE* f = fopen(path, "rb");
-    if (!f) {
+    int exitOnException = c8_exception_exit;
+
+    c8_exception_exit = 0;
+    if (!c8_load_state(c8, path)) {
         printf("Invalid file\n");
-        return;
     }
-    fread(c8, sizeof(c8_t), 1, f);
-    fclose(f);
-
-    c8->draw = 1;
+    c8_exception_exit = exitOnException;
 }
 
 /**
@@ -403,6 +419,10 @@ static int parse_arg(cmd_t* cmd, char* s) {
     case CMD_SAVE:
     case CMD_LOADFLAGS:
     case CMD_SAVEFLAGS: return load_file_arg(cmd, s);
+    case CMD_REWIND:
+    case CMD_RSTEP:
+        cmd->arg.value.i = parse_int(s);
+        return cmd->arg.value.i > 0;
     default: break;
     }
 
@@ -525,7 +545,7 @@ static void print_value(c8_t* c8, cmd_t* cmd) {
         printf("PC: %03x\t\tSP: %02x\n", c8->pc, c8->sp);
         printf("DT: %02x\t\tST: %02x\n", c8->dt, c8->st);
         printf("I:  %03x\t\tK:  V%01x\n", c8->I, c8->VK);
-        printf("BG: %06x\tFG: %06x\n", c8->colors[0], c8->colors[1]);
+        printf("BG: %06x\tFG: %06x\n", c8->cold->colors[0], c8->cold->colors[1]);
         print_fonts(c8);
         print_v_registers(c8);
         print_r_registers(c8);
@@ -557,10 +577,10 @@ static void print_value(c8_t* c8, cmd_t* cmd) {
     case ARG_ST: printf("ST: %02x\n", c8->st); break;
     case ARG_I: printf("I:  %03x\n", c8->I); break;
     case ARG_VK: printf("VK: V%01x\n", c8->VK); break;
-    case ARG_BG: printf("BG: %06x\n", c8->colors[0]); break;
-    case ARG_FG: printf("FG: %06x\n", c8->colors[1]); break;
-    case ARG_BFONT: printf("BFONT: %s\n", c8_fontNames[1][c8->fonts[1]]); break;
-    case ARG_SFONT: printf("SFONT: %s\n", c8_fontNames[0][c8->fonts[0]]); break;
+    case ARG_BG: printf("BG: %06x\n", c8->cold->colors[0]); break;
+    case ARG_FG: printf("FG: %06x\n", c8->cold->colors[1]); break;
+    case ARG_BFONT: printf("BFONT: %s\n", c8_fontNames[1][c8->cold->fonts[1]]); break;
+    case ARG_SFONT: printf("SFONT: %s\n", c8_fontNames[0][c8->cold->fonts[0]]); break;
     case ARG_QUIRKS: print_quirks(c8->flags); break;
     case ARG_STACK: print_stack(c8); break;
     case ARG_ADDR:
@@ -571,6 +591,75 @@ static void print_value(c8_t* c8, cmd_t* cmd) {
     }
 }
 
+/**
+ * @brief Undo instructions until one at a breakpoint is undone.
+ *
+ * Stops at the oldest recorded instruction if there is no breakpoint before
+ * the current one.
+ *
+ * @param c8 `c8_t` to step back
+ */
+static void reverse_continue(c8_t* c8) {
+    int n = 0;
+
+    while (undo_step(c8)) {
+        n++;
+        if (has_breakpoint(c8, c8->pc)) {
+            break;
+        }
+    }
+
+    if (!n) {
+        printf("No instructions to step back to\n");
+        return;
+    }
+    printf("Stepped back %d instruction%s, PC: $%03X\n", n, n == 1 ? "" : "s", c8->pc);
+}
+
+/**
+ * @brief Undo the last `n` instructions.
+ *
+ * @param c8 `c8_t` to step back
+ * @param n number of instructions to undo (1 if <= 0)
+ */
+static void reverse_step(c8_t* c8, int n) {
+    int i = 0;
+
+    if (n <= 0) {
+        n = 1;
+    }
+
+    while (i < n && undo_step(c8)) {
+        i++;
+    }
+
+    if (!i) {
+        printf("No instructions to step back to\n");
+        return;
+    }
+    printf("Stepped back %d instruction%s, PC: $%03X\n", i, i == 1 ? "" : "s", c8->pc);
+}
+
+/**
+ * @brief Go back `n` rewind snapshots.
+ *
+ * @param c8 `c8_t` to rewind
+ * @param n number of snapshots to go back (1 if not positive)
+ */
+static void rewind_state(c8_t* c8, int n) {
+    if (!c8->cold->rewind) {
+        printf("Rewind is disabled\n");
+        return;
+    }
+
+    n = c8_rewind(c8, n > 0 ? n : 1);
+    if (!n) {
+        printf("No snapshots to rewind to\n");
+        return;
+    }
+    printf("Rewound %d snapshot%s, PC: $%03X\n", n, n == 1 ? "" : "s", c8->pc);
+}
+
 /**
  * @brief Save flag registers to file.
  *
@@ -589,20 +678,38 @@ static void save_flags(const c8_t* c8, const char* path) {
 }
 
 /**
- * @brief Save `c8_t` to file.
+ * @brief Save `c8_t` to a compressed savestate (see `c8_save_state`).
  *
  * @param c8 `c8_t` to save
  * @param path path to save to
  */
 static void save_state(c8_t* c8, const char* path) {
-    FILE* f = fopen(path, "wb");
-    if (!f) {
+    int exitOnException = c8_exception_exit;
+
+    c8_exception_exit = 0;
+    if (!c8_save_state(c8, path, C8_STATE_COMPRESS)) {
         printf("Invalid file\n");
-        return;
     }
+    c8_exception_exit = exitOnException;
+}
 
-    fwrite(c8, sizeof(c8_t), 1, f);
-    fclose(f);
+/**
+ * @brief Set or clear the breakpoint at `addr`
+ *
+ * @param c8 `c8_t` to set the breakpoint of
+ * @param addr address of the breakpoint
+ * @param enable 1 to set, 0 to clear
+ */
+static void set_breakpoint(c8_t* c8, int addr, int enable) {
+    uint8_t bit = 1 << (addr & 7);
+
+    addr = (addr & (C8_MEMSIZE - 1)) >> 3;
+    if (enable) {
+        c8->cold->breakpoints[addr] |= bit;
+    }
+    else {
+        c8->cold->breakpoints[addr] &= ~bit;
+    }
 }
 
 /**
@@ -617,7 +724,10 @@ static void save_state(c8_t* c8, const char* path) {
 static int set_value(c8_t* c8, cmd_t* cmd) {
     switch (cmd->arg.type) {
     case ARG_NONE:  return 0;
-    case ARG_ADDR: c8->mem[cmd->arg.value.i] = cmd->setValue; return 1;
+    case ARG_ADDR:
+        c8->mem[cmd->arg.value.i] = cmd->setValue;
+        invalidate_code(c8, cmd->arg.value.i, 1);
+        return 1;
     case ARG_DT: c8->dt = cmd->arg.value.i; return 1;
     case ARG_I: c8->I = cmd->arg.value.i; return 1;
     case ARG_PC: c8->pc = cmd->arg.value.i; return 1;
@@ -625,8 +735,8 @@ static int set_value(c8_t* c8, cmd_t* cmd) {
     case ARG_ST: c8->st = cmd->arg.value.i; return 1;
     case ARG_V: c8->V[cmd->arg.value.i] = cmd->setValue; return 1;
     case ARG_VK: c8->VK = cmd->arg.value.i; return 1;
-    case ARG_BG: c8->colors[0] = cmd->arg.value.i; return 1;
-    case ARG_FG: c8->colors[1] = cmd->arg.value.i; return 1;
+    case ARG_BG: c8->cold->colors[0] = cmd->arg.value.i; return 1;
+    case ARG_FG: c8->cold->colors[1] = cmd->arg.value.i; return 1;
     case ARG_QUIRKS: c8_load_quirks(c8, cmd->arg.value.s); return 1;
     case ARG_BFONT: c8_set_big_font(c8, cmd->arg.value.s); return 1;
     case ARG_SFONT: c8_set_small_font(c8, cmd->arg.value.s); return 1;
@@ -22,6 +22,9 @@ help: Print this help string\n\
 load PATH: Load program state from PATH\n\
 next: Step to the next instruction\n\
 print [ATTRIBUTE]: Print current value of ATTRIBUTE\n\
+rewind [N]: Go back 1 or N rewind snapshots\n\
+rstep [N]: Undo the last 1 or N instructions\n\
+rcontinue: Undo instructions back to the previous breakpoint\n\
 save PATH: Save program state to the given file\n\
 set ATTRIBUTE VALUE: Set the given attribute to the given value\n\
 quit: Terminate the program\n\
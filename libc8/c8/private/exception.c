@@ -30,6 +30,7 @@
 #define INVALID_FONT_EXCEPTION_MESSAGE "Invalid font."
 #define INVALID_CLOCK_SPEED_EXCEPTION_MESSAGE "Clock speed cannot be less than 1."
 #define STACK_UNDERFLOW_EXCEPTION_MESSAGE "Stack underflow occurred during execution."
+#define INVALID_STATE_EXCEPTION_MESSAGE "Invalid or unsupported savestate."
 
 typedef struct {
     exception_code_t code;
@@ -55,9 +56,13 @@ exception_t exceptions[] = {
     { INVALID_FONT_EXCEPTION, INVALID_FONT_EXCEPTION_MESSAGE },
     { INVALID_CLOCK_SPEED_EXCEPTION, INVALID_CLOCK_SPEED_EXCEPTION_MESSAGE },
     { STACK_UNDERFLOW_EXCEPTION, STACK_UNDERFLOW_EXCEPTION_MESSAGE },
+    { INVALID_STATE_EXCEPTION, INVALID_STATE_EXCEPTION_MESSAGE },
 };
 
-char c8_exception[EXCEPTION_MESSAGE_SIZE];
+_Thread_local char c8_exception[EXCEPTION_MESSAGE_SIZE];
+int c8_exception_exit = 1;
+_Thread_local void (*c8_exception_hook)(void*, int);
+_Thread_local void* c8_exception_hook_arg;
 
 void handle_exception(int code) {
     for (size_t i = 0; i < sizeof(exceptions) / sizeof(exception_t); i++) {
@@ -68,7 +73,17 @@ void handle_exception(int code) {
 
     fprintf(stderr, "%s\n", c8_exception);
 
-    #ifndef TEST
-    exit(code);
-    #endif
+    if (c8_exception_exit) {
+        void (*hook)(void*, int) = c8_exception_hook;
+
+        /* The hook may raise exceptions of its own */
+        c8_exception_hook = NULL;
+        if (hook) {
+            hook(c8_exception_hook_arg, code);
+        }
+
+        #ifndef TEST
+        exit(code);
+        #endif
+    }
 }
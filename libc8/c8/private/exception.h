@@ -34,14 +34,30 @@ typedef enum {
     FAILED_GRAPHICS_INITIALIZATION_EXCEPTION = -16,
     INVALID_FONT_EXCEPTION = -17,
     INVALID_CLOCK_SPEED_EXCEPTION = -18,
-    STACK_UNDERFLOW_EXCEPTION = -19
+    STACK_UNDERFLOW_EXCEPTION = -19,
+    INVALID_STATE_EXCEPTION = -20
 } exception_code_t;
 
 
 /**
   * Message to print when calling `handle_exception` with a non-zero code
+  * (one per thread)
   */
-extern char c8_exception[EXCEPTION_MESSAGE_SIZE];
+extern _Thread_local char c8_exception[EXCEPTION_MESSAGE_SIZE];
+
+/**
+  * Exit the process in `handle_exception` if non-zero (see
+  * `c8_set_exit_on_exception`)
+  */
+extern int c8_exception_exit;
+
+/**
+  * Called with `c8_exception_hook_arg` and the exception code by
+  * `handle_exception` before it exits the process, if not NULL (one per
+  * thread)
+  */
+extern _Thread_local void (*c8_exception_hook)(void*, int);
+extern _Thread_local void* c8_exception_hook_arg;
 
 void handle_exception(int);
 
@@ -0,0 +1,72 @@
+/**
+ * @file c8/private/frame.c
+ * @note NOT EXPORTED
+ *
+ * Lock-free triple-buffered frame exchange between two threads.
+ *
+ * Used by `c8_simulate` with `C8_FLAG_THREADED` to hand completed frames from
+ * the emulation thread to the rendering thread. One thread may call
+ * `frame_back`/`frame_publish` and one other thread may call `frame_latest`.
+ */
+
+#include "frame.h"
+
+#include <string.h>
+
+#define FRAME_FRESH 0x4
+#define FRAME_INDEX 0x3
+
+/**
+ * @brief Initialize `fx` with three empty frames
+ *
+ * @param fx the `frame_exchange_t` to initialize
+ */
+void frame_init(frame_exchange_t* fx) {
+    memset(fx->frames, 0, sizeof(fx->frames));
+    fx->back = 0;
+    fx->front = 1;
+    atomic_init(&fx->middle, 2);
+}
+
+/**
+ * @brief Get the frame the producer should fill in next
+ *
+ * @param fx the `frame_exchange_t` to get the frame from
+ *
+ * @return pointer to the producer's frame
+ */
+frame_t* frame_back(frame_exchange_t* fx) {
+    return &fx->frames[fx->back];
+}
+
+/**
+ * @brief Publish the frame returned by `frame_back`
+ *
+ * If the consumer has not taken the previously published frame, that frame is
+ * dropped in favor of this one.
+ *
+ * @param fx the `frame_exchange_t` to publish to
+ */
+void frame_publish(frame_exchange_t* fx) {
+    int old = atomic_exchange_explicit(&fx->middle, fx->back | FRAME_FRESH,
+        memory_order_acq_rel);
+    fx->back = old & FRAME_INDEX;
+}
+
+/**
+ * @brief Take the most recently published frame
+ *
+ * @param fx the `frame_exchange_t` to take the frame from
+ *
+ * @return pointer to the frame, or NULL if no frame has been published since
+ * the last call. The frame remains valid until the next call.
+ */
+frame_t* frame_latest(frame_exchange_t* fx) {
+    if (!(atomic_load_explicit(&fx->middle, memory_order_relaxed) & FRAME_FRESH)) {
+        return NULL;
+    }
+
+    int old = atomic_exchange_explicit(&fx->middle, fx->front, memory_order_acq_rel);
+    fx->front = old & FRAME_INDEX;
+    return &fx->frames[fx->front];
+}
@@ -0,0 +1,53 @@
+/**
+ * @file c8/private/frame.h
+ * @note NOT EXPORTED
+ *
+ * Lock-free triple-buffered frame exchange between two threads.
+ */
+
+#ifndef LIBC8_FRAME_H
+#define LIBC8_FRAME_H
+
+#include "../graphics.h"
+
+#include <stdatomic.h>
+
+/**
+ * @struct frame_t
+ * @brief A completed frame
+ *
+ * @param display display contents
+ * @param colors colors to render the display with
+ */
+typedef struct {
+    c8_display_t display;
+    int colors[2];
+} frame_t;
+
+/**
+ * @struct frame_exchange_t
+ * @brief Triple buffer of frames
+ *
+ * The producer fills `frames[back]` and swaps it with the middle buffer to
+ * publish it. The consumer swaps `front` with the middle buffer when it holds
+ * a newer frame. Neither side ever waits for the other.
+ *
+ * @param frames the three frame buffers
+ * @param back index of the buffer owned by the producer
+ * @param front index of the buffer owned by the consumer
+ * @param middle index of the shared buffer, with `FRAME_FRESH` set if it
+ * holds a frame the consumer has not seen
+ */
+typedef struct {
+    frame_t frames[3];
+    int back;
+    int front;
+    atomic_int middle;
+} frame_exchange_t;
+
+void frame_init(frame_exchange_t*);
+frame_t* frame_back(frame_exchange_t*);
+void frame_publish(frame_exchange_t*);
+frame_t* frame_latest(frame_exchange_t*);
+
+#endif
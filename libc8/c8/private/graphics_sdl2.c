@@ -9,13 +9,18 @@
 
 #include <SDL2/SDL.h>
 #include <stdint.h>
+#include <string.h>
 
-#define RGB_R(i) ((i >> 12) & 0xFF)
-#define RGB_G(i) ((i >> 8) & 0xFF)
-#define RGB_B(i) (i & 0xFF)
+#define ARGB(i) (0xFF000000 | ((i) & 0xFFFFFF))
 
 static SDL_Window* window;
 static SDL_Renderer* renderer;
+static SDL_Texture* texture;
+
+/* Last display and colors uploaded to `texture` */
+static c8_display_t shown;
+static int shownColors[2];
+static int shownValid;
 
 /**
  * Map of all keys to track.
@@ -24,8 +29,9 @@ static SDL_Renderer* renderer;
  * * `keyMap[x][]` is CHIP-8 keycode
  * * `keyMap[16]` enables debug mode / step,
  * * `keyMap[17]` disables debug mode
+ * * `keyMap[18]` rewinds while held (see `c8_set_rewind`)
  */
-static int keyMap[18][2] = {
+static int keyMap[19][2] = {
     { SDLK_1, 1 },
     { SDLK_2, 2 },
     { SDLK_3, 3 },
@@ -44,6 +50,7 @@ static int keyMap[18][2] = {
     { SDLK_v, 0xF },
     { SDLK_p, 16 }, // Enter debug mode
     { SDLK_m, 17 }, // Leave debug mode
+    { SDLK_BACKSPACE, 18 }, // Rewind
 };
 
 static int get_key(SDL_Keycode k);
@@ -52,13 +59,22 @@ static int get_key(SDL_Keycode k);
  * @brief Deinitialize the graphics library.
  */
 void c8_deinit_graphics(void) {
+    SDL_DestroyTexture(texture);
+    SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(window);
+    texture = NULL;
+    renderer = NULL;
+    window = NULL;
+    shownValid = 0;
     SDL_Quit();
 }
 
 /**
  * @brief Initialize the graphics library.
  *
+ * The display is rendered to a streaming texture the size of the high
+ * resolution display, which is scaled to the window when presented.
+ *
  * @return 1 if successful, 0 otherwise.
  */
 uint8_t c8_init_graphics(void) {
@@ -72,58 +88,77 @@ uint8_t c8_init_graphics(void) {
         return 0;
     }
     renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
-    return renderer != NULL;
+    if (!renderer) {
+        return 0;
+    }
+
+    SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "0");
+    texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888,
+        SDL_TEXTUREACCESS_STREAMING,
+        C8_HIGH_DISPLAY_WIDTH, C8_HIGH_DISPLAY_HEIGHT);
+    shownValid = 0;
+    return texture != NULL;
 }
 
 /**
  * Render the given display to the SDL2 window.
  *
+ * The visible area (64x32 in low resolution mode, 128x64 in high resolution
+ * mode) is expanded from the bit-packed display into the streaming texture,
+ * which is then copied to the window in one call. If the display and colors
+ * are unchanged since the last call, the texture is not updated.
+ *
  * @param display `display_t` to render
  * @param colors colors to render
  */
 void c8_render(c8_display_t* display, int* colors) {
-    SDL_Rect pix = {
-        .x = 0,
-        .y = 0,
-        .w = C8_WINDOW_SCALE_X,
-        .h = C8_WINDOW_SCALE_Y,
-    };
-    SDL_Rect winRect = {
-        .x = 0,
-        .y = 0,
-        .w = C8_LOW_DISPLAY_WIDTH,
-        .h = C8_LOW_DISPLAY_HEIGHT,
-    };
-
+    int w = C8_LOW_DISPLAY_WIDTH;
+    int h = C8_LOW_DISPLAY_HEIGHT;
     int dx = 0;
     int dy = 0;
 
-    SDL_RenderClear(renderer);
-    SDL_SetRenderDrawColor(renderer, RGB_R(colors[0]), RGB_G(colors[0]),
-        RGB_B(colors[0]), SDL_ALPHA_OPAQUE);
-    SDL_RenderFillRect(renderer, &winRect);
-    SDL_SetRenderDrawColor(renderer, RGB_R(colors[1]), RGB_G(colors[1]),
-        RGB_B(colors[1]), SDL_ALPHA_OPAQUE);
-
     if (display->mode == C8_DISPLAYMODE_HIGH) {
+        w = C8_HIGH_DISPLAY_WIDTH;
+        h = C8_HIGH_DISPLAY_HEIGHT;
         dx = display->x;
         dy = display->y;
     }
 
-    for (int i = 0; i < C8_LOW_DISPLAY_WIDTH; i++) {
-        for (int j = 0; j < C8_LOW_DISPLAY_HEIGHT; j++) {
-            if (*c8_get_pixel(display, i + dx, j + dy)) {
-                pix.x = i * C8_WINDOW_SCALE_X;
-                pix.y = j * C8_WINDOW_SCALE_Y;
-                SDL_RenderFillRect(renderer, &pix);
+    SDL_Rect src = {
+        .x = 0,
+        .y = 0,
+        .w = w,
+        .h = h,
+    };
+
+    if (!shownValid || memcmp(&shown, display, sizeof(shown)) ||
+        memcmp(shownColors, colors, sizeof(shownColors))) {
+        uint32_t palette[2] = { ARGB(colors[0]), ARGB(colors[1]) };
+        void* pixels;
+        int pitch;
+
+        if (SDL_LockTexture(texture, &src, &pixels, &pitch) < 0) {
+            return;
+        }
+
+        for (int j = 0; j < h; j++) {
+            const uint64_t* row = display->p[(j + dy) % C8_HIGH_DISPLAY_HEIGHT];
+            uint32_t* out = (uint32_t*)((uint8_t*)pixels + j * pitch);
+
+            for (int i = 0; i < w; i++) {
+                int x = (i + dx) % C8_HIGH_DISPLAY_WIDTH;
+                out[i] = palette[(row[x / 64] & C8_PIXEL_MASK(x)) != 0];
             }
         }
-    }
 
-    SDL_SetRenderDrawColor(renderer, RGB_R(colors[0]), RGB_G(colors[0]),
-        RGB_B(colors[0]), SDL_ALPHA_OPAQUE);
-    SDL_RenderFillRect(renderer, &winRect);
+        SDL_UnlockTexture(texture);
+        memcpy(&shown, display, sizeof(shown));
+        memcpy(shownColors, colors, sizeof(shownColors));
+        shownValid = 1;
+    }
 
+    SDL_RenderClear(renderer);
+    SDL_RenderCopy(renderer, texture, &src, NULL);
     SDL_RenderPresent(renderer);
 }
 
@@ -169,7 +204,7 @@ int c8_tick(int* key) {
  * @return the CHIP-8 keycode
  */
 static int get_key(SDL_Keycode k) {
-    for (int i = 0; i < 18; i++) {
+    for (int i = 0; i < 19; i++) {
         if (keyMap[i][0] == k) {
             return keyMap[i][1];
         }
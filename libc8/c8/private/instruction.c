@@ -11,12 +11,17 @@
 #include "c8/defs.h"
 #include "c8/font.h"
 #include "c8/private/exception.h"
+#include "c8/private/jit.h"
+#include "c8/private/profile.h"
+#include "c8/private/random.h"
+#include "c8/private/trace.h"
 
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 
 #define VERBOSE(c) (c->flags & C8_FLAG_VERBOSE)
+#define TRACED(c) (c->flags & (C8_FLAG_VERBOSE | C8_FLAG_TRACE | C8_FLAG_PROFILE))
 
 #define SCHIP_EXCLUSIVE(c) \
     if (c->mode == C8_MODE_CHIP8) { \
@@ -54,12 +59,16 @@
 #define BORROWS(x, y) ((((int) x) - y) < 0)
 #define CARRIES(x, y) ((((int) x) + y) > UINT8_MAX)
 
-/* instruction groups */
-static int base_instruction(c8_t*, uint16_t, uint8_t);
-static int bitwise_instruction(c8_t*, uint16_t, uint8_t, uint8_t, uint8_t);
-static int key_instruction(c8_t*, uint16_t, uint8_t, uint8_t);
-static int misc_instruction(c8_t*, uint16_t, uint8_t, uint8_t);
+/* decoding */
+static uint8_t decode(uint16_t);
+static uint8_t decode_base(uint8_t);
+static uint8_t decode_bitwise(uint8_t);
+static uint8_t decode_key(uint8_t);
+static uint8_t decode_misc(uint8_t);
 
+static int i_invalid(c8_t*);
+static void close_on_exception(void*, int);
+static int trace_instruction(c8_t*, const c8_predecoded_t*);
 static inline int i_scd_b(c8_t*, uint8_t);
 
 /* base (00kk) instructions */
@@ -115,111 +124,350 @@ static inline int i_ld_r_vx(c8_t*, uint8_t);
 static inline int i_ld_vx_r(c8_t*, uint8_t);
 
 
+typedef int (*handler_t)(c8_t*, const c8_predecoded_t*);
+
+#define HANDLER(name, call) \
+    static int h_##name(c8_t* c8, const c8_predecoded_t* p) { return call; }
+
+HANDLER(invalid, i_invalid(c8))
+HANDLER(scd_b, i_scd_b(c8, p->b))
+HANDLER(cls, i_cls(c8))
+HANDLER(ret, i_ret(c8))
+HANDLER(scr, i_scr(c8))
+HANDLER(scl, i_scl(c8))
+HANDLER(exit, i_exit(c8))
+HANDLER(low, i_low(c8))
+HANDLER(high, i_high(c8))
+HANDLER(jp_nnn, i_jp_nnn(c8, p->nnn))
+HANDLER(call_nnn, i_call_nnn(c8, p->nnn))
+HANDLER(se_vx_kk, i_se_vx_kk(c8, p->x, p->kk))
+HANDLER(sne_vx_kk, i_sne_vx_kk(c8, p->x, p->kk))
+HANDLER(se_vx_vy, i_se_vx_vy(c8, p->x, p->y))
+HANDLER(ld_vx_kk, i_ld_vx_kk(c8, p->x, p->kk))
+HANDLER(add_vx_kk, i_add_vx_kk(c8, p->x, p->kk))
+HANDLER(ld_vx_vy, i_ld_vx_vy(c8, p->x, p->y))
+HANDLER(or_vx_vy, i_or_vx_vy(c8, p->x, p->y))
+HANDLER(and_vx_vy, i_and_vx_vy(c8, p->x, p->y))
+HANDLER(xor_vx_vy, i_xor_vx_vy(c8, p->x, p->y))
+HANDLER(add_vx_vy, i_add_vx_vy(c8, p->x, p->y))
+HANDLER(sub_vx_vy, i_sub_vx_vy(c8, p->x, p->y))
+HANDLER(shr_vx_vy, i_shr_vx_vy(c8, p->x, p->y))
+HANDLER(subn_vx_vy, i_subn_vx_vy(c8, p->x, p->y))
+HANDLER(shl_vx_vy, i_shl_vx_vy(c8, p->x, p->y))
+HANDLER(sne_vx_vy, i_sne_vx_vy(c8, p->x, p->y))
+HANDLER(ld_i_nnn, i_ld_i_nnn(c8, p->nnn))
+HANDLER(jp_v0_nnn, i_jp_v0_nnn(c8, p->nnn))
+HANDLER(rnd_vx_kk, i_rnd_vx_kk(c8, p->x, p->kk))
+HANDLER(drw_vx_vy_b, i_drw_vx_vy_b(c8, p->x, p->y, p->b))
+HANDLER(skp_vx, i_skp_vx(c8, p->x))
+HANDLER(sknp_vx, i_sknp_vx(c8, p->x))
+HANDLER(ld_vx_dt, i_ld_vx_dt(c8, p->x))
+HANDLER(ld_vx_k, i_ld_vx_k(c8, p->x))
+HANDLER(ld_dt_vx, i_ld_dt_vx(c8, p->x))
+HANDLER(ld_st_vx, i_ld_st_vx(c8, p->x))
+HANDLER(add_i_vx, i_add_i_vx(c8, p->x))
+HANDLER(ld_f_vx, i_ld_f_vx(c8, p->x))
+HANDLER(ld_hf_vx, i_ld_hf_vx(c8, p->x))
+HANDLER(ld_b_vx, i_ld_b_vx(c8, p->x))
+HANDLER(ld_ip_vx, i_ld_ip_vx(c8, p->x))
+HANDLER(ld_vx_ip, i_ld_vx_ip(c8, p->x))
+HANDLER(ld_r_vx, i_ld_r_vx(c8, p->x))
+HANDLER(ld_vx_r, i_ld_vx_r(c8, p->x))
+
+/**
+ * Instruction handlers, indexed by `Operation`.
+ */
+static const handler_t handlers[OP_COUNT] = {
+    [OP_INVALID] = h_invalid,
+    [OP_SCD_B] = h_scd_b,
+    [OP_CLS] = h_cls,
+    [OP_RET] = h_ret,
+    [OP_SCR] = h_scr,
+    [OP_SCL] = h_scl,
+    [OP_EXIT] = h_exit,
+    [OP_LOW] = h_low,
+    [OP_HIGH] = h_high,
+    [OP_JP_NNN] = h_jp_nnn,
+    [OP_CALL_NNN] = h_call_nnn,
+    [OP_SE_VX_KK] = h_se_vx_kk,
+    [OP_SNE_VX_KK] = h_sne_vx_kk,
+    [OP_SE_VX_VY] = h_se_vx_vy,
+    [OP_LD_VX_KK] = h_ld_vx_kk,
+    [OP_ADD_VX_KK] = h_add_vx_kk,
+    [OP_LD_VX_VY] = h_ld_vx_vy,
+    [OP_OR_VX_VY] = h_or_vx_vy,
+    [OP_AND_VX_VY] = h_and_vx_vy,
+    [OP_XOR_VX_VY] = h_xor_vx_vy,
+    [OP_ADD_VX_VY] = h_add_vx_vy,
+    [OP_SUB_VX_VY] = h_sub_vx_vy,
+    [OP_SHR_VX_VY] = h_shr_vx_vy,
+    [OP_SUBN_VX_VY] = h_subn_vx_vy,
+    [OP_SHL_VX_VY] = h_shl_vx_vy,
+    [OP_SNE_VX_VY] = h_sne_vx_vy,
+    [OP_LD_I_NNN] = h_ld_i_nnn,
+    [OP_JP_V0_NNN] = h_jp_v0_nnn,
+    [OP_RND_VX_KK] = h_rnd_vx_kk,
+    [OP_DRW_VX_VY_B] = h_drw_vx_vy_b,
+    [OP_SKP_VX] = h_skp_vx,
+    [OP_SKNP_VX] = h_sknp_vx,
+    [OP_LD_VX_DT] = h_ld_vx_dt,
+    [OP_LD_VX_K] = h_ld_vx_k,
+    [OP_LD_DT_VX] = h_ld_dt_vx,
+    [OP_LD_ST_VX] = h_ld_st_vx,
+    [OP_ADD_I_VX] = h_add_i_vx,
+    [OP_LD_F_VX] = h_ld_f_vx,
+    [OP_LD_HF_VX] = h_ld_hf_vx,
+    [OP_LD_B_VX] = h_ld_b_vx,
+    [OP_LD_IP_VX] = h_ld_ip_vx,
+    [OP_LD_VX_IP] = h_ld_vx_ip,
+    [OP_LD_R_VX] = h_ld_r_vx,
+    [OP_LD_VX_R] = h_ld_vx_r,
+};
+
 /**
  * @brief Execute the instruction at `c8->pc`
  *
- * This function parses and executes the instruction at the current program
- * counter.
+ * This function executes the instruction at the current program counter.
+ * Instructions are decoded once per address and cached in `c8->predecoded`,
+ * so repeated executions skip straight to the handler.
  *
- * If verbose flag is set, this will print the instruction to `stdout` as well.
+ * If the verbose flag is set, this will print the instruction to `stdout` as
+ * well. If a trace is open, a record is appended to it (see trace.c), and if
+ * profiling, the instruction is counted (see profile.c).
  *
  * @param c8 the `c8_t` to execute the instruction from
  * @return amount to increase the program counter, or an exception code if an
  * error occurs.
  */
 int parse_instruction(c8_t* c8) {
-    uint16_t in = (((uint16_t)c8->mem[c8->pc]) << 8) | c8->mem[c8->pc + 1];
-    C8_EXPAND(in);
+    c8_predecoded_t* p = &c8->predecoded[c8->pc & (C8_MEMSIZE - 1)];
+
+    if (p->op == OP_NONE) {
+        p = predecode(c8, c8->pc);
+    }
+
+    if (TRACED(c8)) {
+        return trace_instruction(c8, p);
+    }
+
+    return handlers[p->op](c8, p);
+}
+
+/**
+ * @brief Execute the instruction at `c8->pc` with verbose output, tracing, or
+ * profiling
+ *
+ * Kept out of `parse_instruction` so the untraced path stays small.
+ *
+ * @param c8 the `c8_t` to execute the instruction from
+ * @param p predecoded instruction at `c8->pc`
+ *
+ * @return amount to increase the program counter by, or an exception code if
+ * an error occurs.
+ */
+static int trace_instruction(c8_t* c8, const c8_predecoded_t* p) {
+    uint16_t pc = c8->pc;
+    uint8_t op = p->op;
+    uint16_t in = (((uint16_t)c8->mem[pc & (C8_MEMSIZE - 1)]) << 8) |
+        c8->mem[(pc + 1) & (C8_MEMSIZE - 1)];
 
     if (VERBOSE(c8)) {
-        printf("%04x: %s\n", c8->pc, c8_decode_instruction(in, NULL));
+        printf("%04x: %s\n", pc, c8_decode_instruction(in, NULL));
+    }
+
+    c8_exception_hook = close_on_exception;
+    c8_exception_hook_arg = c8;
+    int ret = handlers[op](c8, p);
+    c8_exception_hook = NULL;
+
+    if (c8->flags & C8_FLAG_TRACE) {
+        trace_write(c8, pc, in);
+        if (ret < 0) {
+            trace_flush(c8);
+        }
+    }
+    if (c8->flags & C8_FLAG_PROFILE) {
+        profile_instruction(c8, op, pc, ret);
+    }
+    return ret;
+}
+
+/**
+ * @brief Record the instruction at `c8->pc`, then close the trace and write
+ * the profile of `c8`
+ *
+ * Called by `handle_exception` when an instruction raises an exception that
+ * exits the process, so buffered records and counts are not lost.
+ *
+ * @param arg the `c8_t` executing the instruction
+ * @param code exception code
+ */
+static void close_on_exception(void* arg, int code) {
+    c8_t* c8 = arg;
+    uint16_t pc = c8->pc & (C8_MEMSIZE - 1);
+    uint16_t in = (((uint16_t)c8->mem[pc]) << 8) |
+        c8->mem[(pc + 1) & (C8_MEMSIZE - 1)];
+
+    if (c8->flags & C8_FLAG_TRACE) {
+        trace_write(c8, pc, in);
+        trace_close(c8);
+    }
+    if (c8->flags & C8_FLAG_PROFILE) {
+        profile_instruction(c8, c8->predecoded[pc].op, pc, code);
+        profile_close(c8);
+    }
+}
+
+/**
+ * @brief Decode the instruction at `addr` into `c8->predecoded`
+ *
+ * @param c8 the `c8_t` to decode the instruction from
+ * @param addr address of the instruction
+ *
+ * @return pointer to the cache entry for `addr`
+ */
+c8_predecoded_t* predecode(c8_t* c8, uint16_t addr) {
+    addr &= C8_MEMSIZE - 1;
+
+    c8_predecoded_t* p = &c8->predecoded[addr];
+    uint16_t in = (((uint16_t)c8->mem[addr]) << 8) |
+        c8->mem[(addr + 1) & (C8_MEMSIZE - 1)];
+    C8_EXPAND(in);
+
+    p->x = x;
+    p->y = y;
+    p->b = b;
+    p->kk = kk;
+    p->nnn = nnn;
+    p->op = decode(in);
+    return p;
+}
+
+/**
+ * @brief Invalidate predecoded instructions overlapping a memory range
+ *
+ * This must be called whenever `c8->mem` is written to after execution has
+ * started, so self-modifying programs are decoded again. The instruction
+ * starting one byte before `addr` is invalidated as well, since its second
+ * byte is at `addr`. Translated code covering the range is flushed too.
+ *
+ * @param c8 the `c8_t` that was written to
+ * @param addr first address written
+ * @param len number of bytes written
+ */
+void invalidate_code(c8_t* c8, uint16_t addr, int len) {
+    int start = addr > 0 ? addr - 1 : 0;
+    int end = addr + len;
+
+    if (end > C8_MEMSIZE) {
+        end = C8_MEMSIZE;
+    }
+
+    for (int i = start; i < end; i++) {
+        c8->predecoded[i].op = OP_NONE;
     }
 
+    jit_invalidate(c8, addr, len);
+}
+
+/**
+ * @brief Get the handler index for instruction `in`
+ *
+ * @param in instruction to decode
+ *
+ * @return `Operation` for `in`, `OP_INVALID` if `in` is not an instruction
+ */
+static uint8_t decode(uint16_t in) {
+    C8_EXPAND(in);
+
     switch (a) {
-    case 0x0: return y == 0xC ? i_scd_b(c8, b) : base_instruction(c8, in, kk);
-    case 0x1: return i_jp_nnn(c8, nnn);
-    case 0x2: return i_call_nnn(c8, nnn);
-    case 0x3: return i_se_vx_kk(c8, x, kk);
-    case 0x4: return i_sne_vx_kk(c8, x, kk);
-    case 0x5: return i_se_vx_vy(c8, x, y);
-    case 0x6: return i_ld_vx_kk(c8, x, kk);
-    case 0x7: return i_add_vx_kk(c8, x, kk);
-    case 0x8: return bitwise_instruction(c8, in, x, y, b);
-    case 0x9: return i_sne_vx_vy(c8, x, y);
-    case 0xA: return i_ld_i_nnn(c8, nnn);
-    case 0xB: return i_jp_v0_nnn(c8, nnn);
-    case 0xC: return i_rnd_vx_kk(c8, x, kk);
-    case 0xD: return i_drw_vx_vy_b(c8, x, y, b);
-    case 0xE: return key_instruction(c8, in, x, kk);
-    case 0xF: return misc_instruction(c8, in, x, kk);
-    default: // unreachable
-        C8_EXCEPTION(INVALID_INSTRUCTION_EXCEPTION, "Unreachable Invalid instruction: %04x", in);
-        return INVALID_INSTRUCTION_EXCEPTION;
+    case 0x0: return y == 0xC ? OP_SCD_B : decode_base(kk);
+    case 0x1: return OP_JP_NNN;
+    case 0x2: return OP_CALL_NNN;
+    case 0x3: return OP_SE_VX_KK;
+    case 0x4: return OP_SNE_VX_KK;
+    case 0x5: return OP_SE_VX_VY;
+    case 0x6: return OP_LD_VX_KK;
+    case 0x7: return OP_ADD_VX_KK;
+    case 0x8: return decode_bitwise(b);
+    case 0x9: return OP_SNE_VX_VY;
+    case 0xA: return OP_LD_I_NNN;
+    case 0xB: return OP_JP_V0_NNN;
+    case 0xC: return OP_RND_VX_KK;
+    case 0xD: return OP_DRW_VX_VY_B;
+    case 0xE: return decode_key(kk);
+    case 0xF: return decode_misc(kk);
+    default: return OP_INVALID; // unreachable
     }
 }
 
-static int base_instruction(c8_t* c8, uint16_t in, uint8_t kk) {
+static uint8_t decode_base(uint8_t kk) {
     switch (kk) {
-    case 0xE0: return i_cls(c8);
-    case 0xEE: return i_ret(c8);
-    case 0xFB: return i_scr(c8);
-    case 0xFC: return i_scl(c8);
-    case 0xFD: return i_exit(c8);
-    case 0xFE: return i_low(c8);
-    case 0xFF: return i_high(c8);
-    default:
-        C8_EXCEPTION(INVALID_INSTRUCTION_EXCEPTION, "Invalid instruction: %04x", in);
-        return INVALID_INSTRUCTION_EXCEPTION;
+    case 0xE0: return OP_CLS;
+    case 0xEE: return OP_RET;
+    case 0xFB: return OP_SCR;
+    case 0xFC: return OP_SCL;
+    case 0xFD: return OP_EXIT;
+    case 0xFE: return OP_LOW;
+    case 0xFF: return OP_HIGH;
+    default: return OP_INVALID;
     }
 }
 
-static int bitwise_instruction(c8_t* c8, uint16_t in, uint8_t x, uint8_t y, uint8_t b) {
+static uint8_t decode_bitwise(uint8_t b) {
     switch (b) {
-    case 0x0: return i_ld_vx_vy(c8, x, y);
-    case 0x1: return i_or_vx_vy(c8, x, y);
-    case 0x2: return i_and_vx_vy(c8, x, y);
-    case 0x3: return i_xor_vx_vy(c8, x, y);
-    case 0x4: return i_add_vx_vy(c8, x, y);
-    case 0x5: return i_sub_vx_vy(c8, x, y);
-    case 0x6: return i_shr_vx_vy(c8, x, y);
-    case 0x7: return i_subn_vx_vy(c8, x, y);
-    case 0xE: return i_shl_vx_vy(c8, x, y);
-    default:
-        C8_EXCEPTION(INVALID_INSTRUCTION_EXCEPTION, "Invalid instruction: %04x", in);
-        return INVALID_INSTRUCTION_EXCEPTION;
+    case 0x0: return OP_LD_VX_VY;
+    case 0x1: return OP_OR_VX_VY;
+    case 0x2: return OP_AND_VX_VY;
+    case 0x3: return OP_XOR_VX_VY;
+    case 0x4: return OP_ADD_VX_VY;
+    case 0x5: return OP_SUB_VX_VY;
+    case 0x6: return OP_SHR_VX_VY;
+    case 0x7: return OP_SUBN_VX_VY;
+    case 0xE: return OP_SHL_VX_VY;
+    default: return OP_INVALID;
     }
 }
 
-static int key_instruction(c8_t* c8, uint16_t in, uint8_t x, uint8_t kk) {
+static uint8_t decode_key(uint8_t kk) {
     switch (kk) {
-    case 0x9E: return i_skp_vx(c8, x);
-    case 0xA1: return i_sknp_vx(c8, x);
-    default:
-        C8_EXCEPTION(INVALID_INSTRUCTION_EXCEPTION, "Invalid instruction: %04x", in);
-        return INVALID_INSTRUCTION_EXCEPTION;
+    case 0x9E: return OP_SKP_VX;
+    case 0xA1: return OP_SKNP_VX;
+    default: return OP_INVALID;
     }
 }
 
-static int misc_instruction(c8_t* c8, uint16_t in, uint8_t x, uint8_t kk) {
+static uint8_t decode_misc(uint8_t kk) {
     switch (kk) {
-    case 0x07: return i_ld_vx_dt(c8, x);
-    case 0x0A: return i_ld_vx_k(c8, x);
-    case 0x15: return i_ld_dt_vx(c8, x);
-    case 0x18: return i_ld_st_vx(c8, x);
-    case 0x1E: return i_add_i_vx(c8, x);
-    case 0x29: return i_ld_f_vx(c8, x);
-    case 0x30: return i_ld_hf_vx(c8, x);
-    case 0x33: return i_ld_b_vx(c8, x);
-    case 0x55: return i_ld_ip_vx(c8, x);
-    case 0x65: return i_ld_vx_ip(c8, x);
-    case 0x75: return i_ld_r_vx(c8, x);
-    case 0x85: return i_ld_vx_r(c8, x);
-    default:
-        C8_EXCEPTION(INVALID_INSTRUCTION_EXCEPTION, "Invalid instruction: %04x", in);
-        return INVALID_INSTRUCTION_EXCEPTION;
+    case 0x07: return OP_LD_VX_DT;
+    case 0x0A: return OP_LD_VX_K;
+    case 0x15: return OP_LD_DT_VX;
+    case 0x18: return OP_LD_ST_VX;
+    case 0x1E: return OP_ADD_I_VX;
+    case 0x29: return OP_LD_F_VX;
+    case 0x30: return OP_LD_HF_VX;
+    case 0x33: return OP_LD_B_VX;
+    case 0x55: return OP_LD_IP_VX;
+    case 0x65: return OP_LD_VX_IP;
+    case 0x75: return OP_LD_R_VX;
+    case 0x85: return OP_LD_VX_R;
+    default: return OP_INVALID;
     }
 }
 
+/**
+ * @brief Handler for bytes that do not decode to an instruction
+ *
+ * @param c8 the `c8_t` to execute the instruction from
+ *
+ * @return INVALID_INSTRUCTION_EXCEPTION
+ */
+static int i_invalid(c8_t* c8) {
+    uint16_t in = (((uint16_t)c8->mem[c8->pc]) << 8) | c8->mem[c8->pc + 1];
+    C8_EXCEPTION(INVALID_INSTRUCTION_EXCEPTION, "Invalid instruction: %04x", in);
+    return INVALID_INSTRUCTION_EXCEPTION;
+}
+
 /**
  * @brief `SCD b` instruction (`00Cb`)
  *
@@ -254,7 +502,7 @@ static inline int i_scd_b(c8_t* c8, uint8_t b) {
  * @return 2, the number of bytes to increase the program counter by.
  */
 static inline int i_cls(c8_t* c8) {
-    memset(&c8->display.p, 0, C8_HIGH_DISPLAY_WIDTH * C8_HIGH_DISPLAY_HEIGHT);
+    memset(c8->display.p, 0, sizeof(c8->display.p));
     c8->draw = 1;
     return 2;
 }
@@ -752,7 +1000,8 @@ static inline int i_jp_v0_nnn(c8_t* c8, uint16_t nnn) {
  * @brief `RND Vx, kk` instruction (`Cxkk`)
  *
  * This instruction generates a random number and performs a bitwise AND operation
- * with `kk`, storing the result in register Vx.
+ * with `kk`, storing the result in register Vx. The number comes from the
+ * `c8_t`'s own generator (see `c8_seed`).
  *
  * @param c8 the `c8_t` to execute the instruction from
  * @param x the index of the register Vx (0-15)
@@ -761,7 +1010,7 @@ static inline int i_jp_v0_nnn(c8_t* c8, uint16_t nnn) {
  * @return 2, the number of bytes to increase the program counter by.
  */
 static inline int i_rnd_vx_kk(c8_t* c8, uint8_t x, uint8_t kk) {
-    c8->V[x] = rand() & kk;
+    c8->V[x] = random_next(&c8->rng) & kk;
     return 2;
 }
 
@@ -774,6 +1023,13 @@ static inline int i_rnd_vx_kk(c8_t* c8, uint8_t x, uint8_t kk) {
  * pixels are turned off that were previously on, the VF register is set to 1.
  * Then the draw flag is set to 1.
  *
+ * In high resolution mode, a sprite with `b` = 0 is a 16x16 SCHIP sprite of 16
+ * two-byte rows. Pixels past the edge of the display wrap around, or are
+ * clipped if `C8_FLAG_QUIRK_DRAW` is set.
+ *
+ * Each sprite row is shifted into position and XOR'd into the (at most two)
+ * display words it covers at once, so no per-pixel work is done.
+ *
  * @param c8 the `c8_t` to execute the instruction from
  * @param x the index of the register Vx (0-15)
  * @param y the index of the register Vy (0-15)
@@ -782,46 +1038,64 @@ static inline int i_rnd_vx_kk(c8_t* c8, uint8_t x, uint8_t kk) {
  * @return 2, the number of bytes to increase the program counter by.
  */
 static inline int i_drw_vx_vy_b(c8_t* c8, uint8_t x, uint8_t y, uint8_t b) {
-    c8->V[0xF] = 0;
-    int dw = C8_LOW_DISPLAY_WIDTH;
+    int clip = c8->flags & C8_FLAG_QUIRK_DRAW;
+    int words = 1;
     int dh = C8_LOW_DISPLAY_HEIGHT;
-    int h = 8;
+    int w = 8;
     int ox = 0;
     int oy = 0;
+    uint64_t hit = 0;
 
     if (c8->display.mode == C8_DISPLAYMODE_HIGH) {
         if (b == 0) {
             b = 16;
+            w = 16;
         }
-        dw = C8_HIGH_DISPLAY_WIDTH;
+        words = C8_DISPLAY_WORDS;
         dh = C8_HIGH_DISPLAY_HEIGHT;
         ox = c8->display.x;
         oy = c8->display.y;
     }
 
+    int px = (c8->V[x] + ox) % (words * 64);
+    int py = (c8->V[y] + oy) % dh;
+    int k = px / 64;
+    int shift = px % 64;
+
+    /* Word the part of the row shifted out of word `k` lands in, -1 if clipped */
+    int next = k + 1 < words ? k + 1 : (clip ? -1 : 0);
+
     for (int i = 0; i < b; i++) {
-        for (int j = 0; j < h; j++) {
-            int dx = (c8->V[x] + j + ox) % dw;
-            int dy = (c8->V[y] + i + oy) % dh;
-
-            if (c8->flags & C8_FLAG_QUIRK_DRAW) {
-                if (((dx % dw) + b >= dw) || (dy % dh) + h >= dh) {
-                    continue;
-                }
+        int dy = py + i;
+        if (dy >= dh) {
+            if (clip) {
+                break;
             }
+            dy -= dh;
+        }
 
-            int before = *c8_get_pixel(&c8->display, dx, dy);
-            int pix = c8->mem[c8->I + i];
+        uint64_t sprite;
+        if (w == 16) {
+            sprite = (uint64_t)c8->mem[(c8->I + 2 * i) % C8_MEMSIZE] << 56 |
+                (uint64_t)c8->mem[(c8->I + 2 * i + 1) % C8_MEMSIZE] << 48;
+        } else {
+            sprite = (uint64_t)c8->mem[(c8->I + i) % C8_MEMSIZE] << 56;
+        }
 
-            if (pix & (0x80 >> j)) {
-                if (before) {
-                    c8->V[0xF] = 1;
-                }
-                c8_get_pixel(&c8->display, dx, dy)[0] ^= 1;
-            }
+        uint64_t* row = c8->display.p[dy];
+        uint64_t left = sprite >> shift;
+
+        hit |= row[k] & left;
+        row[k] ^= left;
+
+        if (shift && next >= 0) {
+            uint64_t right = sprite << (64 - shift);
+            hit |= row[next] & right;
+            row[next] ^= right;
         }
     }
 
+    c8->V[0xF] = hit != 0;
     c8->draw = 1;
     return 2;
 }
@@ -838,7 +1112,7 @@ static inline int i_drw_vx_vy_b(c8_t* c8, uint8_t x, uint8_t y, uint8_t b) {
  * @return 2, the number of bytes to increase the program counter by.
  */
 static inline int i_skp_vx(c8_t* c8, uint8_t x) {
-    if (c8->key[c8->V[x]]) {
+    if (C8_KEY_DOWN(c8, c8->V[x] & 0xF)) {
         c8->pc += 2;
     }
     return 2;
@@ -856,7 +1130,7 @@ static inline int i_skp_vx(c8_t* c8, uint8_t x) {
  * @return 2, the number of bytes to increase the program counter by.
  */
 static inline int i_sknp_vx(c8_t* c8, uint8_t x) {
-    if (!c8->key[c8->V[x]]) {
+    if (!C8_KEY_DOWN(c8, c8->V[x] & 0xF)) {
         c8->pc += 2;
     }
     return 2;
@@ -892,7 +1166,7 @@ static inline int i_ld_vx_dt(c8_t* c8, uint8_t x) {
 static inline int i_ld_vx_k(c8_t* c8, uint8_t x) {
     // Check if a key is already pressed
     for (int i = 0; i < 16; i++) {
-        if (c8->key[i]) {
+        if (C8_KEY_DOWN(c8, i)) {
             c8->V[x] = i;
             return 2;
         }
@@ -1005,6 +1279,7 @@ static inline int i_ld_b_vx(c8_t* c8, uint8_t x) {
     c8->mem[c8->I] = (c8->V[x] / 100) % 10; // hundreds
     c8->mem[c8->I + 1] = (c8->V[x] / 10) % 10; // tens
     c8->mem[c8->I + 2] = c8->V[x] % 10; // ones
+    invalidate_code(c8, c8->I, 3);
     return 2;
 }
 
@@ -1023,6 +1298,7 @@ static inline int i_ld_ip_vx(c8_t* c8, uint8_t x) {
     for (int i = 0; i < x; i++) {
         c8->mem[c8->I + i] = c8->V[i];
     }
+    invalidate_code(c8, c8->I, x);
     QUIRK_LOADSTORE(c8);
     return 2;
 }
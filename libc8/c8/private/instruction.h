@@ -11,6 +11,64 @@
 
 #include "c8/chip8.h"
 
+/**
+ * @enum Operation
+ * @brief Handler indexes stored in `c8_predecoded_t.op`
+ *
+ * `OP_NONE` marks an address that has not been decoded yet (or was written to
+ * since), so a zeroed `c8_t` starts with an empty cache.
+ */
+typedef enum {
+    OP_NONE = 0,
+    OP_INVALID,
+    OP_SCD_B,
+    OP_CLS,
+    OP_RET,
+    OP_SCR,
+    OP_SCL,
+    OP_EXIT,
+    OP_LOW,
+    OP_HIGH,
+    OP_JP_NNN,
+    OP_CALL_NNN,
+    OP_SE_VX_KK,
+    OP_SNE_VX_KK,
+    OP_SE_VX_VY,
+    OP_LD_VX_KK,
+    OP_ADD_VX_KK,
+    OP_LD_VX_VY,
+    OP_OR_VX_VY,
+    OP_AND_VX_VY,
+    OP_XOR_VX_VY,
+    OP_ADD_VX_VY,
+    OP_SUB_VX_VY,
+    OP_SHR_VX_VY,
+    OP_SUBN_VX_VY,
+    OP_SHL_VX_VY,
+    OP_SNE_VX_VY,
+    OP_LD_I_NNN,
+    OP_JP_V0_NNN,
+    OP_RND_VX_KK,
+    OP_DRW_VX_VY_B,
+    OP_SKP_VX,
+    OP_SKNP_VX,
+    OP_LD_VX_DT,
+    OP_LD_VX_K,
+    OP_LD_DT_VX,
+    OP_LD_ST_VX,
+    OP_ADD_I_VX,
+    OP_LD_F_VX,
+    OP_LD_HF_VX,
+    OP_LD_B_VX,
+    OP_LD_IP_VX,
+    OP_LD_VX_IP,
+    OP_LD_R_VX,
+    OP_LD_VX_R,
+    OP_COUNT,
+} Operation;
+
+void invalidate_code(c8_t* c8, uint16_t addr, int len);
 int parse_instruction(c8_t* c8);
+c8_predecoded_t* predecode(c8_t* c8, uint16_t addr);
 
 #endif
\ No newline at end of file
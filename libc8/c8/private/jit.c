@@ -0,0 +1,649 @@
+/**
+ * @file c8/private/jit.c
+ * @note NOT EXPORTED
+ *
+ * Dynamic binary translator from CHIP-8 basic blocks to x86-64.
+ *
+ * A basic block is a run of straight-line instructions ending at the first
+ * instruction that may change the program counter (`JP`, `CALL`, `RET`, skips,
+ * `DRW`, `LD Vx, K`, ...) or write to memory. Register, `I` and timer
+ * arithmetic is emitted as native code operating directly on the `c8_t`. Every
+ * other instruction calls back into `parse_instruction`, so its semantics are
+ * shared with the interpreter.
+ *
+ * Blocks are chained through a dispatch stub which looks up the block at the
+ * new program counter without returning to C. Any write to memory covered by a
+ * translated block (see `invalidate_code`) flushes the translation cache.
+ *
+ * On other architectures, `jit_execute` falls back to the interpreter.
+ */
+#include "c8/private/jit.h"
+
+#include "c8/defs.h"
+#include "c8/font.h"
+#include "c8/private/exception.h"
+#include "c8/private/instruction.h"
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__)
+#define JIT_NATIVE
+#include <sys/mman.h>
+#endif
+
+#define JIT_BUFFER_SIZE (1 << 20)
+#define JIT_MAX_BLOCK 64
+#define JIT_MAX_INSTRUCTION_BYTES 48
+#define JIT_MAX_BLOCK_BYTES (JIT_MAX_BLOCK * JIT_MAX_INSTRUCTION_BYTES + 64)
+
+/* quirks that change the generated code */
+#define JIT_QUIRKS (C8_FLAG_QUIRK_BITWISE | C8_FLAG_QUIRK_SHIFT)
+
+#define OFF_V(i) (offsetof(c8_t, V) + (i))
+#define OFF_VF OFF_V(0xF)
+#define OFF_PC offsetof(c8_t, pc)
+#define OFF_I offsetof(c8_t, I)
+#define OFF_DT offsetof(c8_t, dt)
+#define OFF_ST offsetof(c8_t, st)
+#define OFF_RUNNING offsetof(c8_t, running)
+#define OFF_WAITING offsetof(c8_t, waitingForKey)
+
+/* x86 register numbers used in ModRM fields */
+#define AL 0
+#define CL 1
+
+/**
+ * @struct c8_jit
+ * @brief Translation cache for one `c8_t`
+ *
+ * @param code executable buffer, NULL if it could not be mapped
+ * @param used bytes of `code` in use
+ * @param stubs bytes of `code` used by the stubs, which are never flushed
+ * @param writable 1 if `code` is currently mapped writable instead of executable
+ * @param quirks quirk flags the cached blocks were translated with
+ * @param enter entry stub, `int enter(c8_t* c8, int budget, void* block)`
+ * @param exit exit stub, returns the number of instructions executed
+ * @param error error stub, returns the exception code in `eax`
+ * @param dispatch block chaining stub
+ * @param entry native entry point of the block starting at each address
+ * @param length number of instructions in the block starting at each address
+ * @param covered 1 for each byte of memory covered by a translated block
+ */
+struct c8_jit {
+    uint8_t* code;
+    size_t used;
+    size_t stubs;
+    int writable;
+    int quirks;
+    uint8_t* enter;
+    uint8_t* exit;
+    uint8_t* error;
+    uint8_t* dispatch;
+    uint8_t* entry[C8_MEMSIZE];
+    uint8_t length[C8_MEMSIZE];
+    uint8_t covered[C8_MEMSIZE];
+};
+
+typedef int (*jit_enter_t)(c8_t*, int, void*);
+
+static struct c8_jit* jit_alloc(c8_t*);
+static void flush(struct c8_jit*);
+static int interpret(c8_t*, int);
+
+#ifdef JIT_NATIVE
+typedef struct {
+    uint8_t* p;
+} emitter_t;
+
+static void emit8(emitter_t*, uint8_t);
+static void emit16(emitter_t*, uint16_t);
+static void emit32(emitter_t*, uint32_t);
+static void emit64(emitter_t*, uint64_t);
+static void emit_mem(emitter_t*, int, size_t);
+static void emit_rel32(emitter_t*, const uint8_t*);
+static void emit_stubs(struct c8_jit*);
+static int emit_instruction(struct c8_jit*, emitter_t*, int, const c8_predecoded_t*, uint16_t);
+static void emit_call(struct c8_jit*, emitter_t*, uint16_t, int);
+static void emit_skip(emitter_t*, uint16_t, uint8_t);
+static void protect(struct c8_jit*, int);
+static uint8_t* translate(c8_t*, struct c8_jit*, uint16_t);
+#endif
+
+/**
+ * @brief Execute up to `budget` instructions using translated code
+ *
+ * Execution also stops early if `c8->running` is cleared or the program starts
+ * waiting for a key press. The translation cache is allocated on first use and
+ * flushed whenever the quirk flags it was built with change.
+ *
+ * @param c8 the `c8_t` to execute
+ * @param budget maximum number of instructions to execute
+ *
+ * @return number of instructions executed, or an exception code if an error
+ * occurs.
+ */
+int jit_execute(c8_t* c8, int budget) {
+    struct c8_jit* jit = c8->jit ? c8->jit : jit_alloc(c8);
+
+    if (!jit || !jit->code) {
+        return interpret(c8, budget);
+    }
+
+#ifdef JIT_NATIVE
+    int count = 0;
+    jit_enter_t enter;
+    memcpy(&enter, &jit->enter, sizeof(enter));
+
+    if ((c8->flags & JIT_QUIRKS) != jit->quirks) {
+        flush(jit);
+        jit->quirks = c8->flags & JIT_QUIRKS;
+    }
+
+    while (count < budget && c8->running && !c8->waitingForKey) {
+        uint8_t* block = NULL;
+
+        if (c8->pc <= C8_MEMSIZE - 2) {
+            block = jit->entry[c8->pc];
+            if (!block) {
+                block = translate(c8, jit, c8->pc);
+            }
+        }
+
+        if (!block || jit->length[c8->pc] > budget - count) {
+            /* Runs off the end of memory or exceeds the budget */
+            int ret = interpret(c8, 1);
+            if (ret < 0) {
+                return ret;
+            }
+            count++;
+            continue;
+        }
+
+        protect(jit, 0);
+        int ret = enter(c8, budget - count, block);
+        if (ret < 0) {
+            return ret;
+        }
+        count += ret;
+    }
+
+    return count;
+#else
+    return interpret(c8, budget);
+#endif
+}
+
+/**
+ * @brief Free the translation cache of `c8`, if any
+ *
+ * @param c8 the `c8_t` to free the translation cache of
+ */
+void jit_free(c8_t* c8) {
+    if (!c8->jit) {
+        return;
+    }
+
+#ifdef JIT_NATIVE
+    if (c8->jit->code) {
+        munmap(c8->jit->code, JIT_BUFFER_SIZE);
+    }
+#endif
+
+    free(c8->jit);
+    c8->jit = NULL;
+}
+
+/**
+ * @brief Flush translated code if it overlaps a memory range
+ *
+ * @param c8 the `c8_t` that was written to
+ * @param addr first address written
+ * @param len number of bytes written
+ */
+void jit_invalidate(c8_t* c8, uint16_t addr, int len) {
+    struct c8_jit* jit = c8->jit;
+
+    if (!jit) {
+        return;
+    }
+
+    for (int i = addr; i < addr + len && i < C8_MEMSIZE; i++) {
+        if (jit->covered[i]) {
+            flush(jit);
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Allocate the translation cache of `c8`
+ *
+ * If no executable memory can be mapped, the cache is still allocated with a
+ * NULL `code` buffer so that `jit_execute` uses the interpreter.
+ *
+ * @param c8 the `c8_t` to allocate the translation cache for
+ *
+ * @return the translation cache, or NULL if allocation failed
+ */
+static struct c8_jit* jit_alloc(c8_t* c8) {
+    struct c8_jit* jit = calloc(1, sizeof(struct c8_jit));
+    if (!jit) {
+        C8_EXCEPTION(MEMORY_ALLOCATION_EXCEPTION, "At %s", __func__);
+        return NULL;
+    }
+
+#ifdef JIT_NATIVE
+    void* code = mmap(NULL, JIT_BUFFER_SIZE, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (code != MAP_FAILED) {
+        jit->code = code;
+        jit->writable = 1;
+        jit->quirks = c8->flags & JIT_QUIRKS;
+        emit_stubs(jit);
+    }
+#endif
+
+    c8->jit = jit;
+    return jit;
+}
+
+/**
+ * @brief Drop all translated blocks
+ *
+ * This only resets bookkeeping, so it is safe to call from an instruction
+ * called by translated code.
+ *
+ * @param jit the translation cache to flush
+ */
+static void flush(struct c8_jit* jit) {
+    memset(jit->entry, 0, sizeof(jit->entry));
+    memset(jit->length, 0, sizeof(jit->length));
+    memset(jit->covered, 0, sizeof(jit->covered));
+    jit->used = jit->stubs;
+}
+
+/**
+ * @brief Execute up to `budget` instructions with `parse_instruction`
+ *
+ * @param c8 the `c8_t` to execute
+ * @param budget maximum number of instructions to execute
+ *
+ * @return number of instructions executed, or an exception code if an error
+ * occurs.
+ */
+static int interpret(c8_t* c8, int budget) {
+    int count = 0;
+
+    while (count < budget && c8->running && !c8->waitingForKey) {
+        int ret = parse_instruction(c8);
+        if (ret < 0) {
+            return ret;
+        }
+        c8->pc += ret;
+        count++;
+    }
+
+    return count;
+}
+
+#ifdef JIT_NATIVE
+static void emit8(emitter_t* e, uint8_t v) {
+    *e->p++ = v;
+}
+
+static void emit16(emitter_t* e, uint16_t v) {
+    memcpy(e->p, &v, sizeof(v));
+    e->p += sizeof(v);
+}
+
+static void emit32(emitter_t* e, uint32_t v) {
+    memcpy(e->p, &v, sizeof(v));
+    e->p += sizeof(v);
+}
+
+static void emit64(emitter_t* e, uint64_t v) {
+    memcpy(e->p, &v, sizeof(v));
+    e->p += sizeof(v);
+}
+
+/**
+ * @brief Emit a ModRM byte and displacement addressing `[rbx + off]`
+ *
+ * The registers are at the start of `c8_t`, so most accesses fit in an 8-bit
+ * displacement.
+ *
+ * @param e emitter
+ * @param reg register number or opcode extension for the ModRM reg field
+ * @param off offset into `c8_t`
+ */
+static void emit_mem(emitter_t* e, int reg, size_t off) {
+    if (off < 0x80) {
+        emit8(e, 0x43 | (reg << 3));
+        emit8(e, (uint8_t)off);
+    } else {
+        emit8(e, 0x83 | (reg << 3));
+        emit32(e, (uint32_t)off);
+    }
+}
+
+/**
+ * @brief Emit a 32-bit displacement to `target`, relative to the next byte
+ *
+ * @param e emitter
+ * @param target address to branch to
+ */
+static void emit_rel32(emitter_t* e, const uint8_t* target) {
+    emit32(e, (uint32_t)(int32_t)(target - (e->p + 4)));
+}
+
+/**
+ * @brief Emit the entry, exit, error, and dispatch stubs
+ *
+ * Translated code keeps the `c8_t` in `rbx`, the remaining instruction budget
+ * in `r12d`, and the number of instructions executed in `r13d`.
+ *
+ * @param jit translation cache to emit the stubs into
+ */
+static void emit_stubs(struct c8_jit* jit) {
+    emitter_t e = { jit->code };
+    uint64_t table = (uint64_t)(uintptr_t)jit->entry;
+
+    /* enter: save callee-saved registers, jump to the block in rdx */
+    jit->enter = e.p;
+    emit8(&e, 0x53);                                    // push rbx
+    emit8(&e, 0x41); emit8(&e, 0x54);                   // push r12
+    emit8(&e, 0x41); emit8(&e, 0x55);                   // push r13
+    emit8(&e, 0x48); emit8(&e, 0x89); emit8(&e, 0xFB);  // mov rbx, rdi
+    emit8(&e, 0x41); emit8(&e, 0x89); emit8(&e, 0xF4);  // mov r12d, esi
+    emit8(&e, 0x45); emit8(&e, 0x31); emit8(&e, 0xED);  // xor r13d, r13d
+    emit8(&e, 0xFF); emit8(&e, 0xE2);                   // jmp rdx
+
+    /* exit: return instruction count; error: return eax */
+    jit->exit = e.p;
+    emit8(&e, 0x44); emit8(&e, 0x89); emit8(&e, 0xE8);  // mov eax, r13d
+    jit->error = e.p;
+    emit8(&e, 0x41); emit8(&e, 0x5D);                   // pop r13
+    emit8(&e, 0x41); emit8(&e, 0x5C);                   // pop r12
+    emit8(&e, 0x5B);                                    // pop rbx
+    emit8(&e, 0xC3);                                    // ret
+
+    /* dispatch: chain into the block at pc, or exit; blocks start by checking
+     * that the budget covers their length */
+    jit->dispatch = e.p;
+    emit8(&e, 0x45); emit8(&e, 0x85); emit8(&e, 0xE4);  // test r12d, r12d
+    emit8(&e, 0x0F); emit8(&e, 0x8E); emit_rel32(&e, jit->exit); // jle exit
+    emit8(&e, 0x83); emit_mem(&e, 7, OFF_RUNNING); emit8(&e, 0); // cmp running, 0
+    emit8(&e, 0x0F); emit8(&e, 0x84); emit_rel32(&e, jit->exit); // je exit
+    emit8(&e, 0x83); emit_mem(&e, 7, OFF_WAITING); emit8(&e, 0); // cmp waitingForKey, 0
+    emit8(&e, 0x0F); emit8(&e, 0x85); emit_rel32(&e, jit->exit); // jne exit
+    emit8(&e, 0x0F); emit8(&e, 0xB7); emit_mem(&e, AL, OFF_PC);  // movzx eax, pc
+    emit8(&e, 0x3D); emit32(&e, C8_MEMSIZE);            // cmp eax, C8_MEMSIZE
+    emit8(&e, 0x0F); emit8(&e, 0x83); emit_rel32(&e, jit->exit); // jae exit
+    emit8(&e, 0x48); emit8(&e, 0xB9); emit64(&e, table); // mov rcx, entry
+    emit8(&e, 0x48); emit8(&e, 0x8B); emit8(&e, 0x04); emit8(&e, 0xC1); // mov rax, [rcx+rax*8]
+    emit8(&e, 0x48); emit8(&e, 0x85); emit8(&e, 0xC0);  // test rax, rax
+    emit8(&e, 0x0F); emit8(&e, 0x84); emit_rel32(&e, jit->exit); // je exit
+    emit8(&e, 0xFF); emit8(&e, 0xE0);                   // jmp rax
+
+    jit->stubs = jit->used = e.p - jit->code;
+}
+
+/**
+ * @brief Switch the code buffer between writable and executable
+ *
+ * @param jit translation cache
+ * @param writable 1 to make the buffer writable, 0 to make it executable
+ */
+static void protect(struct c8_jit* jit, int writable) {
+    if (jit->writable == writable) {
+        return;
+    }
+
+    mprotect(jit->code, JIT_BUFFER_SIZE,
+        writable ? PROT_READ | PROT_WRITE : PROT_READ | PROT_EXEC);
+    jit->writable = writable;
+}
+
+/**
+ * @brief Translate the basic block starting at `start`
+ *
+ * @param c8 the `c8_t` to translate code from
+ * @param jit translation cache to store the block in
+ * @param start address of the first instruction
+ *
+ * @return native entry point of the block
+ */
+static uint8_t* translate(c8_t* c8, struct c8_jit* jit, uint16_t start) {
+    if (jit->used + JIT_MAX_BLOCK_BYTES > JIT_BUFFER_SIZE) {
+        flush(jit);
+    }
+
+    protect(jit, 1);
+
+    emitter_t e = { jit->code + jit->used };
+    uint8_t* block = e.p;
+    uint16_t addr = start;
+    int n = 0;
+    int end = 0;
+
+    emit8(&e, 0x41); emit8(&e, 0x83); emit8(&e, 0xFC); emit8(&e, 0); // cmp r12d, n
+    uint8_t* length = e.p - 1;
+    emit8(&e, 0x0F); emit8(&e, 0x8C); emit_rel32(&e, jit->exit);     // jl exit
+
+    while (!end && n < JIT_MAX_BLOCK && addr <= C8_MEMSIZE - 2) {
+        c8_predecoded_t* p = &c8->predecoded[addr];
+        if (p->op == OP_NONE) {
+            p = predecode(c8, addr);
+        }
+
+        jit->covered[addr] = 1;
+        jit->covered[addr + 1] = 1;
+        end = emit_instruction(jit, &e, c8->flags, p, addr);
+        addr += 2;
+        n++;
+    }
+
+    if (!end) {
+        /* Fall through to the next block */
+        emit8(&e, 0x66); emit8(&e, 0xC7); emit_mem(&e, AL, OFF_PC); emit16(&e, addr);
+    }
+
+    emit8(&e, 0x41); emit8(&e, 0x83); emit8(&e, 0xEC); emit8(&e, n); // sub r12d, n
+    emit8(&e, 0x41); emit8(&e, 0x83); emit8(&e, 0xC5); emit8(&e, n); // add r13d, n
+    emit8(&e, 0xE9); emit_rel32(&e, jit->dispatch);                  // jmp dispatch
+
+    *length = n;
+    jit->used = e.p - jit->code;
+    jit->entry[start] = block;
+    jit->length[start] = n;
+    return block;
+}
+
+/**
+ * @brief Emit native code for one instruction
+ *
+ * The generated code mirrors the matching `i_*` function in instruction.c,
+ * including the order in which VF and Vx are written when x is F.
+ *
+ * @param jit translation cache
+ * @param e emitter
+ * @param flags flags of the `c8_t` being translated
+ * @param p predecoded instruction
+ * @param addr address of the instruction
+ *
+ * @return 1 if the instruction ends the block, 0 otherwise
+ */
+static int emit_instruction(struct c8_jit* jit, emitter_t* e, int flags, const c8_predecoded_t* p, uint16_t addr) {
+    uint8_t x = p->x;
+    uint8_t y = p->y;
+
+    switch (p->op) {
+    case OP_JP_NNN:
+        emit8(e, 0x66); emit8(e, 0xC7); emit_mem(e, AL, OFF_PC); emit16(e, p->nnn);
+        return 1;
+    case OP_SE_VX_KK:
+    case OP_SNE_VX_KK:
+        emit8(e, 0x80); emit_mem(e, 7, OFF_V(x)); emit8(e, p->kk); // cmp Vx, kk
+        emit_skip(e, addr, p->op == OP_SE_VX_KK ? 0x44 : 0x45);
+        return 1;
+    case OP_SE_VX_VY:
+    case OP_SNE_VX_VY:
+        emit8(e, 0x8A); emit_mem(e, AL, OFF_V(x));        // mov al, Vx
+        emit8(e, 0x3A); emit_mem(e, AL, OFF_V(y));        // cmp al, Vy
+        emit_skip(e, addr, p->op == OP_SE_VX_VY ? 0x44 : 0x45);
+        return 1;
+    case OP_LD_VX_KK:
+        emit8(e, 0xC6); emit_mem(e, AL, OFF_V(x)); emit8(e, p->kk);
+        return 0;
+    case OP_ADD_VX_KK:
+        emit8(e, 0x0F); emit8(e, 0xB6); emit_mem(e, AL, OFF_V(x)); // movzx eax, Vx
+        emit8(e, 0x05); emit32(e, p->kk);                  // add eax, kk
+        emit8(e, 0xC1); emit8(e, 0xE8); emit8(e, 8);       // shr eax, 8
+        emit8(e, 0x88); emit_mem(e, AL, OFF_VF);           // mov VF, al
+        emit8(e, 0x80); emit_mem(e, 0, OFF_V(x)); emit8(e, p->kk); // add Vx, kk
+        return 0;
+    case OP_LD_VX_VY:
+        emit8(e, 0x8A); emit_mem(e, AL, OFF_V(y));
+        emit8(e, 0x88); emit_mem(e, AL, OFF_V(x));
+        return 0;
+    case OP_OR_VX_VY:
+    case OP_AND_VX_VY:
+    case OP_XOR_VX_VY:
+        emit8(e, 0x8A); emit_mem(e, AL, OFF_V(x));
+        emit8(e, p->op == OP_OR_VX_VY ? 0x0A : p->op == OP_AND_VX_VY ? 0x22 : 0x32);
+        emit_mem(e, AL, OFF_V(y));
+        emit8(e, 0x88); emit_mem(e, AL, OFF_V(x));
+        if (flags & C8_FLAG_QUIRK_BITWISE) {
+            emit8(e, 0xC6); emit_mem(e, AL, OFF_VF); emit8(e, 0);
+        }
+        return 0;
+    case OP_ADD_VX_VY:
+        emit8(e, 0x0F); emit8(e, 0xB6); emit_mem(e, AL, OFF_V(x)); // movzx eax, Vx
+        emit8(e, 0x0F); emit8(e, 0xB6); emit_mem(e, CL, OFF_V(y)); // movzx ecx, Vy
+        emit8(e, 0x01); emit8(e, 0xC8);                    // add eax, ecx
+        emit8(e, 0xC1); emit8(e, 0xE8); emit8(e, 8);       // shr eax, 8
+        emit8(e, 0x88); emit_mem(e, AL, OFF_VF);           // mov VF, al
+        emit8(e, 0x8A); emit_mem(e, AL, OFF_V(y));         // mov al, Vy
+        emit8(e, 0x00); emit_mem(e, AL, OFF_V(x));         // add Vx, al
+        return 0;
+    case OP_SUB_VX_VY:
+        emit8(e, 0x8A); emit_mem(e, AL, OFF_V(x));         // mov al, Vx
+        emit8(e, 0x3A); emit_mem(e, AL, OFF_V(y));         // cmp al, Vy
+        emit8(e, 0x0F); emit8(e, 0x93); emit8(e, 0xC0);    // setae al
+        emit8(e, 0x88); emit_mem(e, AL, OFF_VF);           // mov VF, al
+        emit8(e, 0x8A); emit_mem(e, AL, OFF_V(y));         // mov al, Vy
+        emit8(e, 0x28); emit_mem(e, AL, OFF_V(x));         // sub Vx, al
+        return 0;
+    case OP_SUBN_VX_VY:
+        emit8(e, 0x8A); emit_mem(e, AL, OFF_V(y));         // mov al, Vy
+        emit8(e, 0x3A); emit_mem(e, AL, OFF_V(x));         // cmp al, Vx
+        emit8(e, 0x0F); emit8(e, 0x93); emit8(e, 0xC0);    // setae al
+        emit8(e, 0x88); emit_mem(e, AL, OFF_VF);           // mov VF, al
+        emit8(e, 0x8A); emit_mem(e, AL, OFF_V(y));         // mov al, Vy
+        emit8(e, 0x2A); emit_mem(e, AL, OFF_V(x));         // sub al, Vx
+        emit8(e, 0x88); emit_mem(e, AL, OFF_V(x));         // mov Vx, al
+        return 0;
+    case OP_SHR_VX_VY:
+    case OP_SHL_VX_VY:
+        if (flags & C8_FLAG_QUIRK_SHIFT) {
+            y = x;
+        }
+        emit8(e, 0x8A); emit_mem(e, AL, OFF_V(y));         // mov al, Vy
+        if (p->op == OP_SHR_VX_VY) {
+            emit8(e, 0xD0); emit8(e, 0xE8);                // shr al, 1
+            emit8(e, 0x88); emit_mem(e, AL, OFF_V(x));     // mov Vx, al
+            emit8(e, 0x24); emit8(e, 0x01);                // and al, 1
+        } else {
+            emit8(e, 0xD0); emit8(e, 0xE0);                // shl al, 1
+            emit8(e, 0x88); emit_mem(e, AL, OFF_V(x));     // mov Vx, al
+            emit8(e, 0xC0); emit8(e, 0xE8); emit8(e, 7);   // shr al, 7
+        }
+        emit8(e, 0x88); emit_mem(e, AL, OFF_VF);           // mov VF, al
+        return 0;
+    case OP_LD_I_NNN:
+        emit8(e, 0x66); emit8(e, 0xC7); emit_mem(e, AL, OFF_I); emit16(e, p->nnn);
+        return 0;
+    case OP_ADD_I_VX:
+        emit8(e, 0x0F); emit8(e, 0xB6); emit_mem(e, AL, OFF_V(x)); // movzx eax, Vx
+        emit8(e, 0x66); emit8(e, 0x01); emit_mem(e, AL, OFF_I);    // add I, ax
+        return 0;
+    case OP_LD_F_VX:
+        emit8(e, 0x0F); emit8(e, 0xB6); emit_mem(e, AL, OFF_V(x)); // movzx eax, Vx
+        emit8(e, 0x8D); emit8(e, 0x04); emit8(e, 0x80);    // lea eax, [rax+rax*4]
+        emit8(e, 0x05); emit32(e, C8_FONT_START);          // add eax, C8_FONT_START
+        emit8(e, 0x66); emit8(e, 0x89); emit_mem(e, AL, OFF_I);    // mov I, ax
+        return 0;
+    case OP_LD_VX_DT:
+        emit8(e, 0x8A); emit_mem(e, AL, OFF_DT);
+        emit8(e, 0x88); emit_mem(e, AL, OFF_V(x));
+        return 0;
+    case OP_LD_DT_VX:
+    case OP_LD_ST_VX:
+        emit8(e, 0x8A); emit_mem(e, AL, OFF_V(x));
+        emit8(e, 0x88); emit_mem(e, AL, p->op == OP_LD_DT_VX ? OFF_DT : OFF_ST);
+        return 0;
+    case OP_CLS:
+    case OP_SCD_B:
+    case OP_SCR:
+    case OP_SCL:
+    case OP_LOW:
+    case OP_HIGH:
+    case OP_RND_VX_KK:
+    case OP_LD_HF_VX:
+    case OP_LD_VX_IP:
+    case OP_LD_R_VX:
+    case OP_LD_VX_R:
+        emit_call(jit, e, addr, 0);
+        return 0;
+    default:
+        /* Control flow, stores, and invalid instructions */
+        emit_call(jit, e, addr, 1);
+        return 1;
+    }
+}
+
+/**
+ * @brief Emit a call to `parse_instruction` for the instruction at `addr`
+ *
+ * If `parse_instruction` returns an exception code, translated code exits
+ * through the error stub. Otherwise, if `end` is set, its return value is
+ * added to the program counter.
+ *
+ * @param jit translation cache
+ * @param e emitter
+ * @param addr address of the instruction
+ * @param end 1 if the instruction ends the block
+ */
+static void emit_call(struct c8_jit* jit, emitter_t* e, uint16_t addr, int end) {
+    int (*fn)(c8_t*) = parse_instruction;
+    uint64_t target;
+    memcpy(&target, &fn, sizeof(target));
+
+    emit8(e, 0x66); emit8(e, 0xC7); emit_mem(e, AL, OFF_PC); emit16(e, addr); // mov pc, addr
+    emit8(e, 0x48); emit8(e, 0x89); emit8(e, 0xDF);        // mov rdi, rbx
+    emit8(e, 0x48); emit8(e, 0xB8); emit64(e, target);     // mov rax, parse_instruction
+    emit8(e, 0xFF); emit8(e, 0xD0);                        // call rax
+    emit8(e, 0x85); emit8(e, 0xC0);                        // test eax, eax
+    emit8(e, 0x0F); emit8(e, 0x88); emit_rel32(e, jit->error); // js error
+
+    if (end) {
+        emit8(e, 0x66); emit8(e, 0x01); emit_mem(e, AL, OFF_PC); // add pc, ax
+    }
+}
+
+/**
+ * @brief Emit a conditional skip from flags set by a preceding compare
+ *
+ * @param e emitter
+ * @param addr address of the skip instruction
+ * @param cmov second opcode byte of the `cmovcc` taking the skip
+ */
+static void emit_skip(emitter_t* e, uint16_t addr, uint8_t cmov) {
+    emit8(e, 0xB8); emit32(e, addr + 2);                   // mov eax, addr + 2
+    emit8(e, 0xB9); emit32(e, addr + 4);                   // mov ecx, addr + 4
+    emit8(e, 0x0F); emit8(e, cmov); emit8(e, 0xC1);        // cmovcc eax, ecx
+    emit8(e, 0x66); emit8(e, 0x89); emit_mem(e, AL, OFF_PC); // mov pc, ax
+}
+#endif
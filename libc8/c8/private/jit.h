@@ -0,0 +1,19 @@
+/**
+ * @file c8/private/jit.h
+ * @note NOT EXPORTED
+ *
+ * Dynamic binary translator from CHIP-8 basic blocks to native code.
+ */
+
+#ifndef LIBC8_JIT_H
+#define LIBC8_JIT_H
+
+#include "../chip8.h"
+
+#include <stdint.h>
+
+int jit_execute(c8_t*, int);
+void jit_free(c8_t*);
+void jit_invalidate(c8_t*, uint16_t, int);
+
+#endif
@@ -0,0 +1,120 @@
+/**
+ * @file c8/private/lexer.c
+ * @note NOT EXPORTED
+ *
+ * Tokenizer for CHIP-8 "assembly" that works in place on the source.
+ *
+ * Words are separated by blanks and commas. A `;` at the start of a word
+ * starts a comment that runs to the end of the line.
+ */
+
+#include "lexer.h"
+
+#include <string.h>
+
+_Thread_local const char* c8_line;
+_Thread_local const char* c8_source_end;
+
+static inline int is_separator(char);
+
+/**
+ * @brief Initialize a lexer at the start of the given source
+ *
+ * @param lexer lexer to initialize
+ * @param s source (need not be null-terminated)
+ * @param len length of the source
+ */
+void lexer_init(lexer_t* lexer, const char* s, size_t len) {
+    lexer->s = s;
+    lexer->len = len;
+    lexer->pos = 0;
+    lexer->ln = 1;
+    lexer->line = 0;
+}
+
+/**
+ * @brief Get the length of a line, without its line ending
+ *
+ * This scans the line, so it is only meant for error messages.
+ *
+ * @param line start of the line
+ * @param end end of the source
+ *
+ * @return length of the line
+ */
+int line_length(const char* line, const char* end) {
+    if (!line || line >= end) {
+        return 0;
+    }
+
+    const char* eol = memchr(line, '\n', end - line);
+    size_t len = (eol ? eol : end) - line;
+    if (len && line[len - 1] == '\r') {
+        len--;
+    }
+    return len;
+}
+
+/**
+ * @brief Read the next token
+ *
+ * A `TOKEN_NEWLINE` is returned at the end of every line, and `lexer->ln`
+ * is advanced when the token after it is read.
+ *
+ * @param lexer lexer to read from
+ * @param token token to populate
+ *
+ * @return kind of the token
+ */
+Token next_token(lexer_t* lexer, token_t* token) {
+    const char* s = lexer->s;
+    size_t pos = lexer->pos;
+
+    if (pos > lexer->line && s[pos - 1] == '\n') {
+        lexer->ln++;
+        lexer->line = pos;
+    }
+
+    while (pos < lexer->len && is_separator(s[pos])) {
+        pos++;
+    }
+    if (pos < lexer->len && s[pos] == ';') {
+        const char* eol = memchr(s + pos, '\n', lexer->len - pos);
+        pos = eol ? (size_t)(eol - s) : lexer->len;
+    }
+
+    token->offset = pos;
+    if (pos >= lexer->len) {
+        token->kind = TOKEN_END;
+        token->len = 0;
+    }
+    else if (s[pos] == '\n') {
+        token->kind = TOKEN_NEWLINE;
+        token->len = 1;
+        pos++;
+    }
+    else {
+        while (pos < lexer->len && s[pos] != '\n' && !is_separator(s[pos])) {
+            pos++;
+        }
+        token->len = pos - token->offset;
+        token->kind = TOKEN_WORD;
+        if (token->len > 1 && s[pos - 1] == ':') {
+            token->kind = TOKEN_LABEL_DEFINITION;
+            token->len--;
+        }
+    }
+
+    lexer->pos = pos;
+    return token->kind;
+}
+
+/**
+ * @brief Check if a character separates words
+ *
+ * @param c character to check
+ * @return 1 if true, 0 if false
+ */
+static inline int is_separator(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == ',' || c == '\v' || c == '\f' || c == '\0';
+}
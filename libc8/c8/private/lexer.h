@@ -0,0 +1,69 @@
+/**
+ * @file c8/private/lexer.h
+ * @note NOT EXPORTED
+ *
+ * Tokenizer for CHIP-8 "assembly" that works in place on the source.
+ */
+
+#ifndef C8_LEXER_H
+#define C8_LEXER_H
+
+#include <stddef.h>
+
+/**
+ * @enum Token
+ * @brief Represents token kinds
+ */
+typedef enum {
+    TOKEN_END,
+    TOKEN_NEWLINE,
+    TOKEN_WORD,
+    TOKEN_LABEL_DEFINITION,
+} Token;
+
+/**
+ * @struct token_t
+ * @brief Represents a token in the source
+ *
+ * Tokens are never copied out of the source: they are a span of it. The span
+ * of a label definition does not include its trailing `:`.
+ *
+ * @param kind token kind
+ * @param offset offset of the first character in the source
+ * @param len length of the token
+ */
+typedef struct {
+    Token kind;
+    size_t offset;
+    size_t len;
+} token_t;
+
+/**
+ * @struct lexer_t
+ * @brief State of a tokenizer over a source buffer
+ *
+ * The source need not be null-terminated.
+ *
+ * @param s source
+ * @param len length of the source
+ * @param pos offset of the next character to read
+ * @param ln line number of the next token
+ * @param line offset of the start of line `ln`
+ */
+typedef struct {
+    const char* s;
+    size_t len;
+    size_t pos;
+    int ln;
+    size_t line;
+} lexer_t;
+
+/* Source line being assembled on this thread, for error messages */
+extern _Thread_local const char* c8_line;
+extern _Thread_local const char* c8_source_end;
+
+void lexer_init(lexer_t*, const char*, size_t);
+int line_length(const char*, const char*);
+Token next_token(lexer_t*, token_t*);
+
+#endif
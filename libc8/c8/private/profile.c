@@ -0,0 +1,417 @@
+/**
+ * @file c8/private/profile.c
+ * @note NOT EXPORTED
+ *
+ * Instruction profiler.
+ *
+ * Every executed instruction is counted by operation (the `parse_instruction`
+ * handler it dispatches to) and by address. `CALL` and `RET` maintain a shadow
+ * call stack, so the instructions executed inside each subroutine (including
+ * the subroutines it calls) are counted as well, both per subroutine and per
+ * call site.
+ *
+ * When the profile is closed, the counts are written to a callgrind file, with
+ * one function per subroutine (named after its address) and one position per
+ * instruction address, and a summary is printed to `stderr`. This also happens
+ * when an instruction raises an exception that exits the process.
+ */
+
+#include "profile.h"
+
+#include "../decode.h"
+#include "exception.h"
+#include "instruction.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PROFILE_MAX_EDGES 4096
+#define PROFILE_TOP 10
+
+/**
+ * @struct edge_t
+ * @brief Calls from one call site to one subroutine
+ *
+ * @param site address of the `CALL` instruction
+ * @param target address of the subroutine
+ * @param calls number of calls that returned (0 if the entry is unused)
+ * @param cost instructions executed by those calls
+ */
+typedef struct {
+    uint16_t site;
+    uint16_t target;
+    uint64_t calls;
+    uint64_t cost;
+} edge_t;
+
+/**
+ * @struct frame_t
+ * @brief Subroutine call in progress
+ *
+ * @param target address of the subroutine
+ * @param site address of the `CALL` instruction
+ * @param start instruction count after the `CALL`
+ */
+typedef struct {
+    uint16_t target;
+    uint16_t site;
+    uint64_t start;
+} frame_t;
+
+/**
+ * @struct c8_profile
+ * @brief Profile of a `c8_t`
+ *
+ * @param path path to write the callgrind file to
+ * @param total instructions executed
+ * @param ops instructions executed per `Operation`
+ * @param pcs instructions executed per address
+ * @param fn subroutine each address last executed in
+ * @param inclusive instructions executed per subroutine, including callees
+ * @param calls number of calls per subroutine
+ * @param edges call sites and their costs (open addressing)
+ * @param frames shadow call stack, `frames[0]` is the program itself
+ * @param depth number of calls in progress
+ */
+struct c8_profile {
+    char* path;
+    uint64_t total;
+    uint64_t ops[OP_COUNT];
+    uint64_t pcs[C8_MEMSIZE];
+    uint16_t fn[C8_MEMSIZE];
+    uint64_t inclusive[C8_MEMSIZE];
+    uint64_t calls[C8_MEMSIZE];
+    edge_t edges[PROFILE_MAX_EDGES];
+    frame_t frames[C8_STACK_SIZE + 1];
+    int depth;
+};
+
+/**
+ * Names of the operations, indexed by `Operation`
+ */
+static const char* opNames[OP_COUNT] = {
+    [OP_NONE] = "NONE",
+    [OP_INVALID] = "INVALID",
+    [OP_SCD_B] = "SCD n",
+    [OP_CLS] = "CLS",
+    [OP_RET] = "RET",
+    [OP_SCR] = "SCR",
+    [OP_SCL] = "SCL",
+    [OP_EXIT] = "EXIT",
+    [OP_LOW] = "LOW",
+    [OP_HIGH] = "HIGH",
+    [OP_JP_NNN] = "JP nnn",
+    [OP_CALL_NNN] = "CALL nnn",
+    [OP_SE_VX_KK] = "SE Vx, kk",
+    [OP_SNE_VX_KK] = "SNE Vx, kk",
+    [OP_SE_VX_VY] = "SE Vx, Vy",
+    [OP_LD_VX_KK] = "LD Vx, kk",
+    [OP_ADD_VX_KK] = "ADD Vx, kk",
+    [OP_LD_VX_VY] = "LD Vx, Vy",
+    [OP_OR_VX_VY] = "OR Vx, Vy",
+    [OP_AND_VX_VY] = "AND Vx, Vy",
+    [OP_XOR_VX_VY] = "XOR Vx, Vy",
+    [OP_ADD_VX_VY] = "ADD Vx, Vy",
+    [OP_SUB_VX_VY] = "SUB Vx, Vy",
+    [OP_SHR_VX_VY] = "SHR Vx, Vy",
+    [OP_SUBN_VX_VY] = "SUBN Vx, Vy",
+    [OP_SHL_VX_VY] = "SHL Vx, Vy",
+    [OP_SNE_VX_VY] = "SNE Vx, Vy",
+    [OP_LD_I_NNN] = "LD I, nnn",
+    [OP_JP_V0_NNN] = "JP V0, nnn",
+    [OP_RND_VX_KK] = "RND Vx, kk",
+    [OP_DRW_VX_VY_B] = "DRW Vx, Vy, n",
+    [OP_SKP_VX] = "SKP Vx",
+    [OP_SKNP_VX] = "SKNP Vx",
+    [OP_LD_VX_DT] = "LD Vx, DT",
+    [OP_LD_VX_K] = "LD Vx, K",
+    [OP_LD_DT_VX] = "LD DT, Vx",
+    [OP_LD_ST_VX] = "LD ST, Vx",
+    [OP_ADD_I_VX] = "ADD I, Vx",
+    [OP_LD_F_VX] = "LD F, Vx",
+    [OP_LD_HF_VX] = "LD HF, Vx",
+    [OP_LD_B_VX] = "LD B, Vx",
+    [OP_LD_IP_VX] = "LD [I], Vx",
+    [OP_LD_VX_IP] = "LD Vx, [I]",
+    [OP_LD_R_VX] = "LD R, Vx",
+    [OP_LD_VX_R] = "LD Vx, R",
+};
+
+static edge_t* find_edge(struct c8_profile*, uint16_t, uint16_t);
+static void pop(struct c8_profile*);
+static void print_report(const c8_t*, const struct c8_profile*, FILE*);
+static int top(const uint64_t*, int, int*, int);
+static int write_callgrind(const struct c8_profile*, FILE*);
+
+/**
+ * @brief Stop profiling `c8`, write the callgrind file, and print a summary
+ *
+ * Instructions executed by calls still in progress count towards their
+ * subroutines, but the calls are not counted as returned.
+ *
+ * @param c8 the `c8_t` to stop profiling
+ *
+ * @return 1 if successful or not profiling, 0 if the file could not be written
+ */
+int profile_close(c8_t* c8) {
+    struct c8_profile* p = c8->cold->profile;
+    int ret = 1;
+
+    c8->flags &= ~C8_FLAG_PROFILE;
+    if (!p) {
+        return 1;
+    }
+
+    while (p->depth) {
+        frame_t* f = &p->frames[p->depth--];
+        p->inclusive[f->target] += p->total - f->start;
+    }
+
+    FILE* f = fopen(p->path, "w");
+    if (!f || !write_callgrind(p, f)) {
+        C8_EXCEPTION(LOAD_FILE_FAILURE_EXCEPTION, "Could not write profile: %s", p->path);
+        ret = 0;
+    }
+    if (f) {
+        fclose(f);
+    }
+
+    print_report(c8, p, stderr);
+    free(p->path);
+    free(p);
+    c8->cold->profile = NULL;
+    return ret;
+}
+
+/**
+ * @brief Count an instruction that was just executed
+ *
+ * @param c8 the `c8_t` that executed the instruction
+ * @param op `Operation` of the instruction
+ * @param pc address of the instruction
+ * @param ret return value of the instruction handler
+ */
+void profile_instruction(c8_t* c8, uint8_t op, uint16_t pc, int ret) {
+    struct c8_profile* p = c8->cold->profile;
+
+    pc &= C8_MEMSIZE - 1;
+    p->total++;
+    p->ops[op]++;
+    p->pcs[pc]++;
+    p->fn[pc] = p->frames[p->depth].target;
+
+    if (ret < 0) {
+        return;
+    }
+
+    if (op == OP_CALL_NNN && p->depth < C8_STACK_SIZE) {
+        frame_t* f = &p->frames[++p->depth];
+        f->target = c8->pc & (C8_MEMSIZE - 1);
+        f->site = pc;
+        f->start = p->total;
+        p->calls[f->target]++;
+    }
+    else if (op == OP_RET && p->depth) {
+        pop(p);
+    }
+}
+
+/**
+ * @brief Start profiling `c8`
+ *
+ * Counts are reset if `c8` was already being profiled.
+ *
+ * @param c8 the `c8_t` to profile
+ * @param path path to write the callgrind file to when profiling stops
+ *
+ * @return 1 if successful, 0 otherwise
+ */
+int profile_open(c8_t* c8, const char* path) {
+    struct c8_profile* p = c8->cold->profile;
+
+    if (p) {
+        free(p->path);
+    }
+    else {
+        p = malloc(sizeof(struct c8_profile));
+        if (!p) {
+            C8_EXCEPTION(MEMORY_ALLOCATION_EXCEPTION, "At %s", __func__);
+            return 0;
+        }
+    }
+
+    memset(p, 0, sizeof(*p));
+    p->path = malloc(strlen(path) + 1);
+    if (!p->path) {
+        C8_EXCEPTION(MEMORY_ALLOCATION_EXCEPTION, "At %s", __func__);
+        free(p);
+        c8->cold->profile = NULL;
+        return 0;
+    }
+    strcpy(p->path, path);
+
+    p->frames[0].target = c8->pc & (C8_MEMSIZE - 1);
+    c8->cold->profile = p;
+    c8->flags |= C8_FLAG_PROFILE;
+    return 1;
+}
+
+/**
+ * @brief Find or add the edge from `site` to `target`
+ *
+ * @param p profile
+ * @param site address of the `CALL` instruction
+ * @param target address of the subroutine
+ *
+ * @return the edge, or NULL if the table is full
+ */
+static edge_t* find_edge(struct c8_profile* p, uint16_t site, uint16_t target) {
+    uint32_t h = ((uint32_t)site * 2654435761u) ^ target;
+
+    for (int i = 0; i < PROFILE_MAX_EDGES; i++) {
+        edge_t* e = &p->edges[(h + i) % PROFILE_MAX_EDGES];
+        if (!e->calls) {
+            e->site = site;
+            e->target = target;
+            return e;
+        }
+        if (e->site == site && e->target == target) {
+            return e;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Return from the innermost call in progress
+ *
+ * @param p profile
+ */
+static void pop(struct c8_profile* p) {
+    frame_t* f = &p->frames[p->depth--];
+    uint64_t cost = p->total - f->start;
+    edge_t* e = find_edge(p, f->site, f->target);
+
+    p->inclusive[f->target] += cost;
+    if (e) {
+        e->calls++;
+        e->cost += cost;
+    }
+}
+
+/**
+ * @brief Print the busiest operations, addresses, and subroutines
+ *
+ * @param c8 the `c8_t` that was profiled
+ * @param p profile
+ * @param f where to print to
+ */
+static void print_report(const c8_t* c8, const struct c8_profile* p, FILE* f) {
+    int idx[PROFILE_TOP];
+    double total = p->total ? (double)p->total : 1;
+    int n;
+
+    fprintf(f, "Profile: %" PRIu64 " instructions\n", p->total);
+
+    fprintf(f, "\nOperations:\n");
+    n = top(p->ops, OP_COUNT, idx, PROFILE_TOP);
+    for (int i = 0; i < n; i++) {
+        fprintf(f, "  %-14s %12" PRIu64 " %6.2f%%\n", opNames[idx[i]],
+            p->ops[idx[i]], 100 * p->ops[idx[i]] / total);
+    }
+
+    fprintf(f, "\nAddresses:\n");
+    n = top(p->pcs, C8_MEMSIZE, idx, PROFILE_TOP);
+    for (int i = 0; i < n; i++) {
+        char buf[C8_DECODE_MAX_LENGTH];
+        uint16_t in = (c8->mem[idx[i]] << 8) | c8->mem[(idx[i] + 1) & (C8_MEMSIZE - 1)];
+
+        fprintf(f, "  $%03X %-20s %12" PRIu64 " %6.2f%%\n", idx[i],
+            c8_decode_instruction_r(in, NULL, buf, sizeof(buf)),
+            p->pcs[idx[i]], 100 * p->pcs[idx[i]] / total);
+    }
+
+    fprintf(f, "\nSubroutines (inclusive):\n");
+    n = top(p->inclusive, C8_MEMSIZE, idx, PROFILE_TOP);
+    for (int i = 0; i < n; i++) {
+        fprintf(f, "  $%03X %10" PRIu64 " calls %12" PRIu64 " %6.2f%%\n", idx[i],
+            p->calls[idx[i]], p->inclusive[idx[i]],
+            100 * p->inclusive[idx[i]] / total);
+    }
+}
+
+/**
+ * @brief Find the indexes of the largest non-zero counts
+ *
+ * @param counts counts
+ * @param size number of counts
+ * @param idx where to store the indexes, largest count first
+ * @param max size of `idx`
+ *
+ * @return number of indexes stored
+ */
+static int top(const uint64_t* counts, int size, int* idx, int max) {
+    int n = 0;
+
+    for (int i = 0; i < size; i++) {
+        if (!counts[i] || (n == max && counts[i] <= counts[idx[n - 1]])) {
+            continue;
+        }
+
+        int j = n < max ? n++ : n - 1;
+        while (j > 0 && counts[idx[j - 1]] < counts[i]) {
+            idx[j] = idx[j - 1];
+            j--;
+        }
+        idx[j] = i;
+    }
+    return n;
+}
+
+/**
+ * @brief Write the profile in callgrind format
+ *
+ * @param p profile
+ * @param f where to write to
+ *
+ * @return 1 if successful, 0 otherwise
+ */
+static int write_callgrind(const struct c8_profile* p, FILE* f) {
+    uint8_t isFn[C8_MEMSIZE] = { 0 };
+
+    isFn[p->frames[0].target] = 1;
+    for (int pc = 0; pc < C8_MEMSIZE; pc++) {
+        if (p->pcs[pc]) {
+            isFn[p->fn[pc]] = 1;
+        }
+    }
+
+    fprintf(f, "# callgrind format\nversion: 1\ncreator: libc8\n");
+    fprintf(f, "positions: instr\nevents: Instructions\n");
+    fprintf(f, "summary: %" PRIu64 "\n\nfl=rom\n", p->total);
+
+    for (int fn = 0; fn < C8_MEMSIZE; fn++) {
+        if (!isFn[fn]) {
+            continue;
+        }
+
+        fprintf(f, "\nfn=sub_%03X\n", fn);
+        for (int pc = 0; pc < C8_MEMSIZE; pc++) {
+            if (p->pcs[pc] && p->fn[pc] == fn) {
+                fprintf(f, "0x%03X %" PRIu64 "\n", pc, p->pcs[pc]);
+            }
+        }
+
+        for (int i = 0; i < PROFILE_MAX_EDGES; i++) {
+            const edge_t* e = &p->edges[i];
+            if (e->calls && p->fn[e->site] == fn) {
+                fprintf(f, "cfn=sub_%03X\ncalls=%" PRIu64 " 0x%03X\n0x%03X %" PRIu64 "\n",
+                    e->target, e->calls, e->target, e->site, e->cost);
+            }
+        }
+    }
+
+    return !ferror(f);
+}
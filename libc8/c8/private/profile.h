@@ -0,0 +1,19 @@
+/**
+ * @file c8/private/profile.h
+ * @note NOT EXPORTED
+ *
+ * Instruction profiler.
+ */
+
+#ifndef C8_PROFILE_H
+#define C8_PROFILE_H
+
+#include "../chip8.h"
+
+#include <stdint.h>
+
+int profile_close(c8_t*);
+void profile_instruction(c8_t*, uint8_t, uint16_t, int);
+int profile_open(c8_t*, const char*);
+
+#endif
@@ -0,0 +1,44 @@
+/**
+ * @file c8/private/random.c
+ * @note NOT EXPORTED
+ *
+ * Per-instance pseudorandom number generator.
+ *
+ * This is PCG32 (XSH RR) with its default stream. The whole state is one
+ * 64-bit word stored in the `c8_t`, so instances do not share state, and the
+ * same seed gives the same sequence on every platform.
+ */
+
+#include "random.h"
+
+#define PCG_MULTIPLIER 6364136223846793005ULL
+#define PCG_INCREMENT 1442695040888963407ULL
+
+/**
+ * @brief Generate the next 32-bit number and advance `state`
+ *
+ * @param state generator state
+ *
+ * @return pseudorandom number
+ */
+uint32_t random_next(uint64_t* state) {
+    uint64_t old = *state;
+    uint32_t xorshifted = (uint32_t)(((old >> 18) ^ old) >> 27);
+    uint32_t rot = (uint32_t)(old >> 59);
+
+    *state = old * PCG_MULTIPLIER + PCG_INCREMENT;
+    return (xorshifted >> rot) | (xorshifted << ((-rot) & 31));
+}
+
+/**
+ * @brief Seed the generator
+ *
+ * @param state generator state to initialize
+ * @param seed seed
+ */
+void random_seed(uint64_t* state, uint64_t seed) {
+    *state = 0;
+    random_next(state);
+    *state += seed;
+    random_next(state);
+}
@@ -0,0 +1,16 @@
+/**
+ * @file c8/private/random.h
+ * @note NOT EXPORTED
+ *
+ * Per-instance pseudorandom number generator.
+ */
+
+#ifndef C8_RANDOM_H
+#define C8_RANDOM_H
+
+#include <stdint.h>
+
+uint32_t random_next(uint64_t*);
+void random_seed(uint64_t*, uint64_t);
+
+#endif
@@ -0,0 +1,466 @@
+/**
+ * @file c8/private/rewind.c
+ * @note NOT EXPORTED
+ *
+ * In-memory rewind buffer of delta-compressed snapshots.
+ *
+ * Every `interval` frames, the emulated machine state (everything in `c8_t`
+ * before `predecoded`) is snapshotted into a ring. Most snapshots are stored
+ * as the XOR of the state with the newest keyframe (a full snapshot),
+ * run-length encoded as a sequence of tokens:
+ *
+ *     uint16_t zeros;        // unchanged bytes to skip
+ *     uint16_t literals;     // changed bytes that follow
+ *     uint8_t xor[literals]; // state XOR keyframe
+ *
+ * Bytes after the last token are unchanged. A snapshot only needs its own
+ * keyframe to be restored, so restoring never walks a chain of deltas. When
+ * the ring is over its memory budget, the oldest keyframe and its deltas are
+ * dropped together.
+ */
+
+#include "rewind.h"
+
+#include "exception.h"
+#include "instruction.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SNAPSHOT_SIZE offsetof(c8_t, predecoded)
+#define REWIND_MAX_SNAPSHOTS 4096
+/* Every `REWIND_KEYFRAME_INTERVAL`th snapshot is a keyframe */
+#define REWIND_KEYFRAME_INTERVAL 32
+#define RUN_MAX 0xFFFF
+#define RUN_MIN_ZEROS 4
+
+/* Deltas larger than this are stored as keyframes instead */
+#define DELTA_MAX (SNAPSHOT_SIZE / 2)
+#define DELTA_NONE SIZE_MAX
+
+/**
+ * @struct snapshot_t
+ * @brief One snapshot in the rewind ring
+ *
+ * @param data full state if `keyframe`, encoded delta otherwise
+ * @param size size of `data` in bytes
+ * @param keyframe 1 if this is a keyframe, 0 if it is a delta
+ */
+typedef struct {
+    uint8_t* data;
+    size_t size;
+    int keyframe;
+} snapshot_t;
+
+/**
+ * @struct c8_rewind
+ * @brief Rewind ring of a `c8_t`
+ *
+ * @param ring snapshots, oldest at `first`
+ * @param first ring index of the oldest snapshot
+ * @param count number of snapshots
+ * @param keyframe ring index of the newest keyframe (-1 if none)
+ * @param deltas number of deltas after the newest keyframe
+ * @param used bytes of snapshot data in the ring
+ * @param budget maximum bytes of snapshot data
+ * @param interval frames between snapshots
+ * @param frames frames since the last snapshot
+ * @param current 1 if the newest snapshot is the current state
+ * @param scratch buffer to encode deltas into
+ * @param state buffer to decode snapshots into
+ */
+struct c8_rewind {
+    snapshot_t ring[REWIND_MAX_SNAPSHOTS];
+    int first;
+    int count;
+    int keyframe;
+    int deltas;
+    size_t used;
+    size_t budget;
+    int interval;
+    int frames;
+    int current;
+    uint8_t scratch[DELTA_MAX];
+    uint8_t state[SNAPSHOT_SIZE];
+};
+
+static void apply(c8_t*, const uint8_t*);
+static void decode(const uint8_t*, size_t, uint8_t*);
+static size_t encode(const uint8_t*, const uint8_t*, uint8_t*);
+static void drop_oldest(struct c8_rewind*);
+static void drop_newest(struct c8_rewind*);
+static void find_keyframe(struct c8_rewind*);
+static void snapshot(c8_t*, struct c8_rewind*);
+
+#define RING(rw, i) ((rw)->ring[((rw)->first + (i)) % REWIND_MAX_SNAPSHOTS])
+
+/**
+ * @brief Enable, reconfigure, or disable rewinding
+ *
+ * @param c8 the `c8_t` to configure
+ * @param budget maximum bytes of snapshot data to keep (0 to disable)
+ * @param interval frames between snapshots (`C8_REWIND_INTERVAL` if <= 0)
+ *
+ * @return 1 if successful, 0 otherwise
+ */
+int rewind_configure(c8_t* c8, size_t budget, int interval) {
+    struct c8_rewind* rw = c8->cold->rewind;
+
+    if (!budget) {
+        rewind_free(c8);
+        return 1;
+    }
+
+    if (!rw) {
+        rw = calloc(1, sizeof(struct c8_rewind));
+        if (!rw) {
+            C8_EXCEPTION(MEMORY_ALLOCATION_EXCEPTION, "At %s", __func__);
+            return 0;
+        }
+        rw->keyframe = -1;
+        c8->cold->rewind = rw;
+    }
+
+    rw->budget = budget;
+    rw->interval = interval > 0 ? interval : C8_REWIND_INTERVAL;
+    while (rw->used > rw->budget && rw->count && rw->first != rw->keyframe) {
+        drop_oldest(rw);
+    }
+    return 1;
+}
+
+/**
+ * @brief Count a frame, and snapshot `c8` if it is time to
+ *
+ * @param c8 the `c8_t` that just finished a frame
+ */
+void rewind_frame(c8_t* c8) {
+    struct c8_rewind* rw = c8->cold->rewind;
+
+    if (!rw) {
+        return;
+    }
+
+    rw->current = 0;
+    if (++rw->frames < rw->interval) {
+        return;
+    }
+
+    rw->frames = 0;
+    snapshot(c8, rw);
+}
+
+/**
+ * @brief Free the rewind ring of `c8`
+ *
+ * @param c8 the `c8_t` to free the rewind ring of
+ */
+void rewind_free(c8_t* c8) {
+    struct c8_rewind* rw = c8->cold->rewind;
+
+    if (!rw) {
+        return;
+    }
+
+    while (rw->count) {
+        drop_newest(rw);
+    }
+    free(rw);
+    c8->cold->rewind = NULL;
+}
+
+/**
+ * @brief Restore the `n`th newest snapshot
+ *
+ * A snapshot of the current state (taken at the end of the last frame) does
+ * not count. The restored snapshot and all newer ones are removed from the
+ * ring, so calling this repeatedly goes further back in time.
+ *
+ * @param c8 the `c8_t` to rewind
+ * @param n number of snapshots to go back
+ *
+ * @return number of snapshots gone back (0 if there are none)
+ */
+int rewind_restore(c8_t* c8, int n) {
+    struct c8_rewind* rw = c8->cold->rewind;
+
+    if (!rw || n <= 0) {
+        return 0;
+    }
+
+    if (rw->current) {
+        drop_newest(rw);
+        rw->current = 0;
+    }
+
+    if (!rw->count) {
+        return 0;
+    }
+
+    if (n > rw->count) {
+        n = rw->count;
+    }
+
+    for (int i = 1; i < n; i++) {
+        drop_newest(rw);
+    }
+
+    int k = rw->count - 1;
+    while (!RING(rw, k).keyframe) {
+        k--;
+    }
+
+    snapshot_t* s = &RING(rw, rw->count - 1);
+    memcpy(rw->state, RING(rw, k).data, SNAPSHOT_SIZE);
+    if (!s->keyframe) {
+        decode(s->data, s->size, rw->state);
+    }
+
+    drop_newest(rw);
+    apply(c8, rw->state);
+    rw->frames = 0;
+    return n;
+}
+
+/**
+ * @brief Copy a snapshot into `c8`
+ *
+ * Pointers, host settings (flags and clock speed) and held keys are kept.
+ * Predecoded and translated code is invalidated where memory changed.
+ *
+ * @param c8 the `c8_t` to restore
+ * @param state snapshot to restore
+ */
+static void apply(c8_t* c8, const uint8_t* state) {
+    const uint8_t* mem = state + offsetof(c8_t, mem);
+    struct c8_jit* jit = c8->jit;
+    int (*recompiled)(struct c8*) = c8->recompiled;
+    c8_cold_t* cold = c8->cold;
+    int flags = c8->flags;
+    int cs = c8->cs;
+    uint32_t keys = c8->keys;
+    int lo = 0;
+    int hi = C8_MEMSIZE - 1;
+
+    while (lo < C8_MEMSIZE && c8->mem[lo] == mem[lo]) {
+        lo++;
+    }
+    while (hi > lo && c8->mem[hi] == mem[hi]) {
+        hi--;
+    }
+
+    memcpy(c8, state, SNAPSHOT_SIZE);
+    c8->jit = jit;
+    c8->recompiled = recompiled;
+    c8->cold = cold;
+    c8->flags = flags;
+    c8->cs = cs;
+    c8->keys = keys;
+    c8->draw = 1;
+
+    if (lo < C8_MEMSIZE) {
+        invalidate_code(c8, lo, hi - lo + 1);
+    }
+}
+
+/**
+ * @brief Apply an encoded delta to a copy of its keyframe
+ *
+ * @param in encoded delta
+ * @param size size of `in`
+ * @param out keyframe to apply the delta to
+ */
+static void decode(const uint8_t* in, size_t size, uint8_t* out) {
+    const uint8_t* end = in + size;
+    uint16_t zeros, literals;
+
+    while (in < end) {
+        memcpy(&zeros, in, sizeof(zeros));
+        memcpy(&literals, in + 2, sizeof(literals));
+        in += 4;
+        out += zeros;
+        for (int i = 0; i < literals; i++) {
+            *out++ ^= *in++;
+        }
+    }
+}
+
+/**
+ * @brief Encode `cur` as a delta against `key`
+ *
+ * A run of unchanged bytes only ends a token if it is at least
+ * `RUN_MIN_ZEROS` long, so tokens never cost more than they save.
+ *
+ * @param key keyframe
+ * @param cur state to encode
+ * @param out where to store the delta (`DELTA_MAX` bytes)
+ *
+ * @return size of the delta, or `DELTA_NONE` if it would be larger than
+ * `DELTA_MAX`
+ */
+static size_t encode(const uint8_t* key, const uint8_t* cur, uint8_t* out) {
+    size_t i = 0;
+    size_t o = 0;
+
+    while (i < SNAPSHOT_SIZE) {
+        uint16_t zeros = 0;
+        uint16_t literals = 0;
+
+        while (i < SNAPSHOT_SIZE && key[i] == cur[i] && zeros < RUN_MAX) {
+            i++;
+            zeros++;
+        }
+        if (i == SNAPSHOT_SIZE) {
+            break;
+        }
+
+        size_t start = i;
+        while (i < SNAPSHOT_SIZE && literals < RUN_MAX) {
+            if (key[i] == cur[i]) {
+                size_t j = i;
+                while (j < SNAPSHOT_SIZE && j - i < RUN_MIN_ZEROS && key[j] == cur[j]) {
+                    j++;
+                }
+                if (j - i == RUN_MIN_ZEROS || j == SNAPSHOT_SIZE ||
+                    literals + (j - i) > RUN_MAX) {
+                    break;
+                }
+                literals += j - i;
+                i = j;
+            }
+            else {
+                literals++;
+                i++;
+            }
+        }
+
+        if (o + 4 + literals > DELTA_MAX) {
+            return DELTA_NONE;
+        }
+
+        memcpy(out + o, &zeros, sizeof(zeros));
+        memcpy(out + o + 2, &literals, sizeof(literals));
+        o += 4;
+        for (size_t j = start; j < i; j++) {
+            out[o++] = key[j] ^ cur[j];
+        }
+    }
+
+    return o;
+}
+
+/**
+ * @brief Drop the oldest keyframe and its deltas
+ *
+ * @param rw rewind ring (must not be empty)
+ */
+static void drop_oldest(struct c8_rewind* rw) {
+    do {
+        snapshot_t* s = &RING(rw, 0);
+        rw->used -= s->size;
+        free(s->data);
+        s->data = NULL;
+        rw->first = (rw->first + 1) % REWIND_MAX_SNAPSHOTS;
+        rw->count--;
+    } while (rw->count && !RING(rw, 0).keyframe);
+
+    find_keyframe(rw);
+}
+
+/**
+ * @brief Drop the newest snapshot
+ *
+ * @param rw rewind ring (must not be empty)
+ */
+static void drop_newest(struct c8_rewind* rw) {
+    snapshot_t* s = &RING(rw, rw->count - 1);
+    int keyframe = s->keyframe;
+
+    rw->used -= s->size;
+    free(s->data);
+    s->data = NULL;
+    rw->count--;
+
+    if (keyframe) {
+        find_keyframe(rw);
+    }
+    else {
+        rw->deltas--;
+    }
+}
+
+/**
+ * @brief Find the newest keyframe and count the deltas after it
+ *
+ * @param rw rewind ring
+ */
+static void find_keyframe(struct c8_rewind* rw) {
+    rw->keyframe = -1;
+    rw->deltas = 0;
+
+    for (int i = rw->count - 1; i >= 0; i--) {
+        if (RING(rw, i).keyframe) {
+            rw->keyframe = (rw->first + i) % REWIND_MAX_SNAPSHOTS;
+            return;
+        }
+        rw->deltas++;
+    }
+}
+
+/**
+ * @brief Add a snapshot of `c8` to the ring
+ *
+ * The snapshot is stored as a delta against the newest keyframe, unless it is
+ * time for a new keyframe or the delta would be too large.
+ *
+ * @param c8 the `c8_t` to snapshot
+ * @param rw rewind ring of `c8`
+ */
+static void snapshot(c8_t* c8, struct c8_rewind* rw) {
+    const uint8_t* cur = (const uint8_t*)c8;
+    snapshot_t s = { NULL, DELTA_NONE, 0 };
+
+    if (rw->keyframe >= 0 && rw->deltas < REWIND_KEYFRAME_INTERVAL - 1) {
+        s.size = encode(rw->ring[rw->keyframe].data, cur, rw->scratch);
+        if (s.size != DELTA_NONE) {
+            /* Allocate at least a byte, an unchanged state is an empty delta */
+            s.data = malloc(s.size ? s.size : 1);
+            if (!s.data) {
+                return;
+            }
+            memcpy(s.data, rw->scratch, s.size);
+        }
+    }
+
+    if (s.size == DELTA_NONE) {
+        s.data = malloc(SNAPSHOT_SIZE);
+        if (!s.data) {
+            return;
+        }
+        memcpy(s.data, cur, SNAPSHOT_SIZE);
+        s.size = SNAPSHOT_SIZE;
+        s.keyframe = 1;
+    }
+
+    if (rw->count == REWIND_MAX_SNAPSHOTS) {
+        drop_oldest(rw);
+    }
+
+    int i = (rw->first + rw->count) % REWIND_MAX_SNAPSHOTS;
+    rw->ring[i] = s;
+    rw->count++;
+    rw->used += s.size;
+    if (s.keyframe) {
+        rw->keyframe = i;
+        rw->deltas = 0;
+    }
+    else {
+        rw->deltas++;
+    }
+    rw->current = 1;
+
+    while (rw->used > rw->budget && rw->first != rw->keyframe) {
+        drop_oldest(rw);
+    }
+}
@@ -0,0 +1,20 @@
+/**
+ * @file c8/private/rewind.h
+ * @note NOT EXPORTED
+ *
+ * In-memory rewind buffer of delta-compressed snapshots.
+ */
+
+#ifndef C8_REWIND_H
+#define C8_REWIND_H
+
+#include "../chip8.h"
+
+#include <stddef.h>
+
+int rewind_configure(c8_t*, size_t, int);
+void rewind_frame(c8_t*);
+void rewind_free(c8_t*);
+int rewind_restore(c8_t*, int);
+
+#endif
@@ -10,6 +10,7 @@
 #include "../encode.h"
 #include "../defs.h"
 #include "exception.h"
+#include "lexer.h"
 #include "util.h"
 
 #include <ctype.h>
@@ -101,7 +102,7 @@ instruction_format_t formats[] = {
     { I_SNE,   0x9000, 2, {SYM_V, SYM_V},           {0x0F00, 0x00F0} },
     { I_LD,    0xA000, 2, {SYM_I, SYM_INT12},       {0x0000, 0x0FFF} },
     { I_JP_V0, 0xB000, 1, {SYM_INT12},              {0x0FFF} }, // For decoding
-    { I_JP,    0xB000, 1, {SYM_V, SYM_INT12},       {0x0000, 0x0FFF} }, // For encoding
+    { I_JP,    0xB000, 2, {SYM_V, SYM_INT12},       {0x0000, 0x0FFF} }, // For encoding
     { I_RND,   0xC000, 2, {SYM_V, SYM_INT8},        {0x0F00, 0x00FF} },
     { I_DRW,   0xD000, 3, {SYM_V, SYM_V, SYM_INT4}, {0x0F00, 0x00F0, 0x000F} },
     { I_SKP,   0xE09E, 1, {SYM_V},                  {0x0F00} },
@@ -121,70 +122,173 @@ instruction_format_t formats[] = {
     { I_NULL,  0,      0, {SYM_NULL},               {0} },
 };
 
-static int get_instruction_args(instruction_t* ins, symbol_list_t* symbols, int idx);
-static int parse_instruction(instruction_t*);
-static int reallocate_symbols(symbol_list_t* symbols);
-static int validate_instruction(instruction_t*);
-
 /**
- * @brief Build an instruction from symbols beginning at idx
- *
- * This function builds an instruction from a completely parsed set of symbols
- * (with labels expanded).
+ * @struct keyword_t
+ * @brief An instruction or reserved identifier string
  *
- * @param ins instruction_t to store instruction contents
- * @param symbols symbol list
- * @param idx symbols index of start of instruction
- * @return instruction bytecode
+ * @param s string
+ * @param len length of `s`
+ * @param instruction `Instruction` of `s`, or -1
+ * @param identifier `Symbol` of `s`, or -1
  */
-int build_instruction(instruction_t* ins, symbol_list_t* symbols, int idx) {
-    ins->cmd = (Instruction)symbols->s[idx].value;
-    ins->line = symbols->s[idx].ln;
-    ins->pcount = 0;
-
-    get_instruction_args(ins, symbols, idx + 1);
-    validate_instruction(ins);
-    return parse_instruction(ins);
-}
+typedef struct {
+    const char* s;
+    size_t len;
+    int instruction;
+    int identifier;
+} keyword_t;
+
+/*
+ * Perfect hash of a keyword from its first, second and last characters and
+ * its length (the second character is 0 in strings shorter than 2). It has no
+ * collisions for the strings below: a collision would initialize the same
+ * slot twice, which -Woverride-init rejects.
+ */
+#define KEYWORD_TABLE_SIZE 128
+#define KEYWORD_HASH(first, second, last, len) \
+    (((first) + 19 * (second) + 5 * (last) + (len)) & (KEYWORD_TABLE_SIZE - 1))
+#define INSTRUCTION_KEYWORD(s, first, second, last, ins) \
+    [KEYWORD_HASH(first, second, last, sizeof(s) - 1)] = { s, sizeof(s) - 1, ins, -1 }
+#define IDENTIFIER_KEYWORD(s, first, second, last, sym) \
+    [KEYWORD_HASH(first, second, last, sizeof(s) - 1)] = { s, sizeof(s) - 1, -1, sym }
 
 /**
- * @brief Check if the given string is a comment
- *
- * @param s the string to check
- * @return 1 if true, 0 if false
+ * All instruction and reserved identifier strings, indexed by `KEYWORD_HASH`
  */
-int is_comment(const char* s) {
-    return s[0] == ';';
-}
+static const keyword_t keywords[KEYWORD_TABLE_SIZE] = {
+    INSTRUCTION_KEYWORD(S_CLS,   'C', 'L', 'S', I_CLS),
+    INSTRUCTION_KEYWORD(S_RET,   'R', 'E', 'T', I_RET),
+    INSTRUCTION_KEYWORD(S_JP,    'J', 'P', 'P', I_JP),
+    INSTRUCTION_KEYWORD(S_CALL,  'C', 'A', 'L', I_CALL),
+    INSTRUCTION_KEYWORD(S_SE,    'S', 'E', 'E', I_SE),
+    INSTRUCTION_KEYWORD(S_SNE,   'S', 'N', 'E', I_SNE),
+    INSTRUCTION_KEYWORD(S_LD,    'L', 'D', 'D', I_LD),
+    INSTRUCTION_KEYWORD(S_ADD,   'A', 'D', 'D', I_ADD),
+    INSTRUCTION_KEYWORD(S_OR,    'O', 'R', 'R', I_OR),
+    INSTRUCTION_KEYWORD(S_AND,   'A', 'N', 'D', I_AND),
+    INSTRUCTION_KEYWORD(S_SUB,   'S', 'U', 'B', I_SUB),
+    INSTRUCTION_KEYWORD(S_SHR,   'S', 'H', 'R', I_SHR),
+    INSTRUCTION_KEYWORD(S_SUBN,  'S', 'U', 'N', I_SUBN),
+    INSTRUCTION_KEYWORD(S_SHL,   'S', 'H', 'L', I_SHL),
+    INSTRUCTION_KEYWORD(S_RND,   'R', 'N', 'D', I_RND),
+    INSTRUCTION_KEYWORD(S_DRW,   'D', 'R', 'W', I_DRW),
+    INSTRUCTION_KEYWORD(S_SKP,   'S', 'K', 'P', I_SKP),
+    INSTRUCTION_KEYWORD(S_SKNP,  'S', 'K', 'P', I_SKNP),
+    INSTRUCTION_KEYWORD(S_XOR,   'X', 'O', 'R', I_XOR),
+    INSTRUCTION_KEYWORD(S_SCD,   'S', 'C', 'D', I_SCD),
+    INSTRUCTION_KEYWORD(S_SCR,   'S', 'C', 'R', I_SCR),
+    INSTRUCTION_KEYWORD(S_SCL,   'S', 'C', 'L', I_SCL),
+    INSTRUCTION_KEYWORD(S_EXIT,  'E', 'X', 'T', I_EXIT),
+    INSTRUCTION_KEYWORD(S_LOW,   'L', 'O', 'W', I_LOW),
+    INSTRUCTION_KEYWORD(S_HIGH,  'H', 'I', 'H', I_HIGH),
+    INSTRUCTION_KEYWORD(S_JP_V0, 'J', 'P', ',', I_JP_V0),
+    IDENTIFIER_KEYWORD("",       0,   0,   0,   SYM_NULL),
+    IDENTIFIER_KEYWORD(S_DT,     'D', 'T', 'T', SYM_DT),
+    IDENTIFIER_KEYWORD(S_ST,     'S', 'T', 'T', SYM_ST),
+    IDENTIFIER_KEYWORD(S_I,      'I', 0,   'I', SYM_I),
+    IDENTIFIER_KEYWORD(S_IP,     '[', 'I', ']', SYM_IP),
+    IDENTIFIER_KEYWORD(S_K,      'K', 0,   'K', SYM_K),
+    IDENTIFIER_KEYWORD(S_F,      'F', 0,   'F', SYM_F),
+    IDENTIFIER_KEYWORD(S_B,      'B', 0,   'B', SYM_B),
+    IDENTIFIER_KEYWORD(S_DB,     '.', 'D', 'B', SYM_DB),
+    IDENTIFIER_KEYWORD(S_DW,     '.', 'D', 'W', SYM_DW),
+    IDENTIFIER_KEYWORD(S_DS,     '.', 'D', 'S', SYM_DS),
+    IDENTIFIER_KEYWORD(S_HF,     'H', 'F', 'F', SYM_HF),
+    IDENTIFIER_KEYWORD(S_R,      'R', 0,   'R', SYM_R),
+};
+
+static int equal_fold(const char*, const char*, size_t);
+static uint32_t hash_label(const char*, size_t);
+static const keyword_t* find_keyword(const char*, size_t);
+static int grow_label_table(label_list_t*);
+static int parse_instruction(instruction_t*);
+static int validate_instruction(instruction_t*);
 
 /**
- * @brief Check if given string is a DB identifier
+ * @brief Add a label to the label list
+ *
+ * The label list and its hash table are doubled in size when full.
+ *
+ * A duplicate label is returned but not thrown, so the caller can report it
+ * with the offending line.
+ *
+ * @param labels label list
+ * @param s identifier (need not be null-terminated)
+ * @param len length of identifier
  *
- * @return 1 if true, 0 if false
+ * @return index of the new label if success, `DUPLICATE_LABEL_EXCEPTION` if
+ * it is already defined, `MEMORY_ALLOCATION_EXCEPTION` if allocation failed
  */
-int is_db(const char* s) {
-    return !strcmp(s, S_DB);
+int add_label(label_list_t* labels, const char* s, size_t len) {
+    if (find_label(labels, s, len) >= 0) {
+        return DUPLICATE_LABEL_EXCEPTION;
+    }
+    if (labels->len >= labels->ceil) {
+        label_t* l = (label_t*)arena_alloc(labels->arena, labels->ceil * 2 * sizeof(label_t));
+        if (!l) {
+            return MEMORY_ALLOCATION_EXCEPTION;
+        }
+        memcpy(l, labels->l, labels->len * sizeof(label_t));
+        labels->l = l;
+        labels->ceil *= 2;
+    }
+    if ((labels->len + 1) * 2 > labels->tableSize && grow_label_table(labels) < 0) {
+        return MEMORY_ALLOCATION_EXCEPTION;
+    }
+
+    char* identifier = arena_strndup(labels->arena, s, len);
+    if (!identifier) {
+        return MEMORY_ALLOCATION_EXCEPTION;
+    }
+
+    int idx = labels->len++;
+    labels->l[idx].identifier = identifier;
+    labels->l[idx].byte = -1;
+
+    int mask = labels->tableSize - 1;
+    int slot = hash_label(s, len) & mask;
+    while (labels->table[slot]) {
+        slot = (slot + 1) & mask;
+    }
+    labels->table[slot] = idx + 1;
+
+    return idx;
 }
 
 /**
- * @brief Check if given string is a DW identifier
+ * @brief Build an instruction's bytecode
+ *
+ * This function validates an instruction whose command and operands have been
+ * read (with labels expanded) and generates its bytecode. If successful,
+ * `ins->format` is populated with the matching format.
  *
- * @return 1 if true, 0 if false
+ * @param ins instruction to build
+ * @return instruction bytecode, exception code if the instruction is invalid
  */
-int is_dw(const char* s) {
-    return !strcmp(s, S_DW);
+int build_instruction(instruction_t* ins) {
+    int ret = validate_instruction(ins);
+    return ret < 0 ? ret : parse_instruction(ins);
 }
 
 /**
- * @brief Check if the given string is an instruction
+ * @brief Find a label by identifier, ignoring case
  *
- * @param s the string to check
- * @return instruction enumerator if true, -1 if false
+ * @param labels label list
+ * @param s identifier (need not be null-terminated)
+ * @param len length of identifier
+ *
+ * @return label index if found, -1 otherwise
  */
-int is_instruction(const char* s) {
-    for (int i = 0; c8_instructionStrings[i]; i++) {
-        if (!strcmp(s, c8_instructionStrings[i])) {
-            return i;
+int find_label(const label_list_t* labels, const char* s, size_t len) {
+    if (!labels->table) {
+        return -1;
+    }
+
+    int mask = labels->tableSize - 1;
+    for (int slot = hash_label(s, len) & mask; labels->table[slot]; slot = (slot + 1) & mask) {
+        const label_t* l = &labels->l[labels->table[slot] - 1];
+        if (equal_fold(l->identifier, s, len) && l->identifier[len] == '\0') {
+            return labels->table[slot] - 1;
         }
     }
 
@@ -192,47 +296,31 @@ int is_instruction(const char* s) {
 }
 
 /**
- * @brief Check if the given string is a label definition
+ * @brief Find a label by identifier, adding it if it does not exist
+ *
+ * Labels added by this function are undefined (`byte` is -1).
  *
- * @param s the string to check
- * @return 1 if true, 0 if false
+ * @param labels label list
+ * @param s identifier (need not be null-terminated)
+ * @param len length of identifier
+ *
+ * @return label index if success, exception code otherwise
  */
-int is_label_definition(const char* s) {
-    int len = strlen(s);
-    if (len < 2) {
-        return 0;
-    }
-
-    return s[len - 1] == ':';
+int get_label(label_list_t* labels, const char* s, size_t len) {
+    int idx = find_label(labels, s, len);
+    return idx >= 0 ? idx : add_label(labels, s, len);
 }
 
 /**
- * @brief Check if given string is a label reference
- *
- * This function checks if the given string is a label reference by
- * comparing it against the label list.
- * It returns the index of the label in the label list
- * if it is found, or -1 if it is not.
- *
- * This function assumes that the label list has been populated
- * (e.g. `populate_labels()` has been called).
+ * @brief Check if the given string is an instruction
  *
- * @param s string to check
- * @param labels label list to check from
- * @return label index if true, -1 otherwise
+ * @param s the string to check (need not be null-terminated)
+ * @param len length of the string
+ * @return instruction enumerator if true, -1 if false
  */
-int is_label(const char* s, const label_list_t* labels) {
-    if (strlen(s) == 0) {
-        return -1;
-    }
-
-    for (int i = 0; i < labels->len; i++) {
-        if (!strcmp(s, labels->l[i].identifier)) {
-            return i;
-        }
-    }
-
-    return -1;
+int is_instruction(const char* s, size_t len) {
+    const keyword_t* k = find_keyword(s, len);
+    return k ? k->instruction : -1;
 }
 
 /**
@@ -243,11 +331,12 @@ int is_label(const char* s, const label_list_t* labels) {
  * It returns the register number if it is a valid V register,
  * or -1 if it is not.
  *
- * @param s string to check
+ * @param s string to check (need not be null-terminated)
+ * @param len length of the string
  * @return V register number if true, -1 otherwise
  */
-int is_register(const char* s) {
-    return (*s == 'V' || *s == 'v') ? parse_int(s) : -1;
+int is_register(const char* s, size_t len) {
+    return len && (*s == 'V' || *s == 'v') ? parse_int_n(s, len) : -1;
 }
 
 /**
@@ -257,239 +346,93 @@ int is_register(const char* s) {
  * defined in `c8_identifierStrings`. It returns the index of the identifier
  * if it is found, or -1 if it is not.
  *
- * @param s string to check
+ * @param s string to check (need not be null-terminated)
+ * @param len length of the string
  * @return type of identifier if true, -1 otherwise
  */
-int is_reserved_identifier(const char* s) {
-    for (int i = 0; c8_identifierStrings[i]; i++) {
-        if (!strcmp(s, c8_identifierStrings[i])) {
-            return i;
-        }
-    }
-
-    return -1;
+int is_reserved_identifier(const char* s, size_t len) {
+    const keyword_t* k = find_keyword(s, len);
+    return k ? k->identifier : -1;
 }
 
 /**
- * @brief Get the next symbol
- *
- * This function retrieves the next available symbol in the symbol list.
- * If the symbol list is empty, it initializes the first symbol.
- * If the symbol list is full, it reallocates the symbol list to accommodate
- * more symbols.
- *
- * If symbols is `NULL` or the symbol list is `NULL`, it returns `NULL`.
+ * @brief Compare two strings, ignoring case
  *
- * @param symbols symbol list to get next symbol from
+ * @param a first string
+ * @param b second string
+ * @param len number of characters to compare
  *
- * @return first empty symbol in symbol table
+ * @return 1 if equal, 0 otherwise
  */
-symbol_t* next_symbol(symbol_list_t* symbols) {
-    if (!symbols || !symbols->s) {
-        return NULL;
-    }
-    if (symbols->len == 0) {
-        symbols->len++;
-        return &symbols->s[0];
-    }
-
-    symbols->len++;
-    if (symbols->len >= symbols->ceil) {
-        reallocate_symbols(symbols);
-    }
-
-    return &symbols->s[symbols->len - 1];
-}
-
-/**
- * @brief Populate label list from lines
- *
- * This function scans through the lines of code and identifies label definitions.
- * It checks each line for a label definition (ending with a colon) and adds it
- * to the label list.
- *
- * If a duplicate label definition is found, it throws a `DUPLICATE_LABEL_EXCEPTION`.
- *
- * If too many labels are defined, it throws a `TOO_MANY_LABELS_EXCEPTION`.
- *
- * @param lines lines to search
- * @param lineCount number of lines to search
- * @param labels label list to populate
- *
- * @return 1 if success, 0 if failure
- */
-int populate_labels(label_list_t* labels) {
-    for (int i = 0; i < c8_line_count; i++) {
-        if (strlen(c8_lines[i]) == 0) {
-            continue;
-        }
-
-        c8_lines[i] = remove_comment(c8_lines[i]);
-        trim(c8_lines[i]);
-        if (strlen(remove_comment(c8_lines[i])) == 0) {
-            continue;
-        }
-
-        if (is_label_definition(c8_lines[i])) {
-            for (int j = 0; j < labels->len; j++) {
-                if (!strncmp(labels->l[j].identifier, c8_lines[i], strlen(labels->l[j].identifier))) {
-                    C8_EXCEPTION(DUPLICATE_LABEL_EXCEPTION, "Duplicate label definition.\nLine %d: %s", i + 1, c8_lines_unformatted[i + 1]);
-                    return DUPLICATE_LABEL_EXCEPTION;
-                }
-            }
-
-            snprintf(labels->l[labels->len].identifier, LABEL_IDENTIFIER_SIZE - 1, "%s", c8_lines[i]);
-
-            /* remove : */
-            int labellen = strlen(c8_lines[i]) - 1;
-            labels->l[labels->len].identifier[labellen] = '\0';
-
-            labels->len++;
-        }
-        if (labels->len == labels->ceil) {
-            C8_EXCEPTION(TOO_MANY_LABELS_EXCEPTION, "Too many labels defined in source code.\nLine %d: %s", i + 1, c8_lines[i]);
-            return TOO_MANY_LABELS_EXCEPTION;
+static int equal_fold(const char* a, const char* b, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        if (toupper((unsigned char)a[i]) != toupper((unsigned char)b[i])) {
+            return 0;
         }
     }
-
     return 1;
 }
 
 /**
- * @brief Get byte indexes of label definitions from completed symbol table
- *
- * This function resolves label definitions in the symbol list and populates
- * the label list with the byte index of each label definition. It iterates
- * through the symbols, keeping track of the current byte position in the
- * program. When it encounters a label definition, it records the current byte
- * position in the label list. It also increments the byte position based on
- * the type of symbol encountered (e.g., `SYM_DB` increments by 1,
- * `SYM_INSTRUCTION` and `SYM_DW` increment by 2).
- *
- * This function assumes that the symbol list has been populated and that
- * the symbols have been parsed correctly. It also assumes that the label list
- * has been initialized.
- *
- * This function will return 1 if all labels were resolved successfully,
- * or 0 if there was a failure (e.g., if the label list is not fully populated).
+ * @brief FNV-1a hash of a label identifier, ignoring case
  *
- * This function will throw a NULL_ARGUMENT_EXCEPTION if either
- * `symbols` or `labels` is NULL.
+ * @param s identifier
+ * @param len length of identifier
  *
- * @param symbols list of symbols
- * @param labels list of labels
- *
- * @return 1 if success, 0 if failure
+ * @return hash
  */
-int resolve_labels(symbol_list_t* symbols, label_list_t* labels) {
-    int byte = C8_PROG_START;
-    int labelIdx = 0;
-    for (int i = 0; i < symbols->len; i++) {
-        if (labelIdx == labels->len) {
-            return 1;
-        }
-
-        switch (symbols->s[i].type) {
-        case SYM_LABEL_DEFINITION:
-            labels->l[labelIdx++].byte = byte;
-            break;
-        case SYM_DB:
-            byte++;
-            break;
-        case SYM_INSTRUCTION:
-        case SYM_DW:
-            byte += 2;
-        default:
-            break;
-        }
+static uint32_t hash_label(const char* s, size_t len) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        h = (h ^ (uint8_t)toupper((unsigned char)s[i])) * 16777619u;
     }
-
-    return labelIdx == labels->len;
+    return h;
 }
 
 /**
- * @brief Substitute label symbols with their corresponding int value
- *
- * This function replaces all symbols of type `SYM_LABEL` in the symbol list
- * with their corresponding byte value from the label list. It checks if the
- * label exists and throws an `INVALID_SYMBOL_EXCEPTION` if it does not.
+ * @brief Find an instruction or reserved identifier, ignoring case
  *
- * This function assumes that the label list has been populated and that their
- * byte values have been set correctly.
+ * @param s string to find (need not be null-terminated)
+ * @param len length of the string
  *
- * @param symbols symbols to search
- * @param labels labels to search
+ * @return keyword if found, NULL otherwise
  */
-int substitute_labels(symbol_list_t* symbols, label_list_t* labels) {
-    for (int i = 0; i < symbols->len; i++) {
-        if (symbols->s[i].type == SYM_LABEL) {
-            if (symbols->s[i].value >= labels->len) {
-                C8_EXCEPTION(INVALID_SYMBOL_EXCEPTION, "Label does not exist.\nLine %d: %s", symbols->s[i].ln, c8_lines_unformatted[symbols->s[i].ln]);
-                return INVALID_SYMBOL_EXCEPTION;
-            }
-            symbols->s[i].type = SYM_INT12;
-            symbols->s[i].value = labels->l[symbols->s[i].value].byte;
-        }
-    }
+static const keyword_t* find_keyword(const char* s, size_t len) {
+    uint8_t first = len ? toupper((unsigned char)s[0]) : 0;
+    uint8_t second = len > 1 ? toupper((unsigned char)s[1]) : 0;
+    uint8_t last = len ? toupper((unsigned char)s[len - 1]) : 0;
+    const keyword_t* k = &keywords[KEYWORD_HASH(first, second, last, len)];
 
-    return 1;
+    return k->s && k->len == len && equal_fold(k->s, s, len) ? k : NULL;
 }
 
 /**
- * @brief Get instruction arguments from symbols
- *
- * This function populates the instruction's parameters from the symbols
- * starting at the given index. It checks the type of each symbol and assigns
- * the value to the instruction's parameter array.
+ * @brief Double the size of the label hash table, rehashing every label
  *
- * If an integer argument is too large for the expected type, it throws an
- * `INVALID_INSTRUCTION_EXCEPTION`.
+ * The table is allocated with `LABEL_TABLE_SIZE` slots if it does not exist.
  *
- * @param ins instruction to populate
- * @param symbols symbol list
- * @param idx index of first argument in symbols
+ * @param labels label list
  *
- * @return 1 if success, exception code otherwise.
+ * @return 1 if success, exception code otherwise
  */
-static int get_instruction_args(instruction_t* ins, symbol_list_t* symbols, int idx) {
-    int j = 0;
-    int max = 0;
-    for (int i = idx; i < symbols->len; i++) {
-        switch (symbols->s[i].type) {
-        case SYM_V:
-        case SYM_INT12:
-            max = 0xFFF;
-            // fall through
-        case SYM_INT8:
-            max = max == 0 ? 0xFF : max;
-            // fall through
-        case SYM_INT4:
-            max = max == 0 ? 0xF : max;
-            if (symbols->s[i].value > max) {
-                C8_EXCEPTION(INVALID_INSTRUCTION_EXCEPTION,
-                    "Line %d: Integer argument too big: %d", symbols->s[i].ln, symbols->s[i].value);
-                return INVALID_INSTRUCTION_EXCEPTION;
-            }
-            ins->p[j] = symbols->s[i].value;
-            // fall through
-        case SYM_B:
-        case SYM_DT:
-        case SYM_F:
-        case SYM_I:
-        case SYM_IP:
-        case SYM_K:
-        case SYM_ST:
-        case SYM_HF:
-        case SYM_R:
-            ins->ptype[j] = symbols->s[i].type;
-            ins->pcount++;
-            break;
-        default:
-            i = symbols->len;
-            break;
+static int grow_label_table(label_list_t* labels) {
+    int size = labels->table ? labels->tableSize * 2 : LABEL_TABLE_SIZE;
+    int* table = (int*)arena_calloc(labels->arena, size, sizeof(int));
+    if (!table) {
+        return MEMORY_ALLOCATION_EXCEPTION;
+    }
+
+    for (int i = 0; i < labels->len; i++) {
+        const char* id = labels->l[i].identifier;
+        int slot = hash_label(id, strlen(id)) & (size - 1);
+        while (table[slot]) {
+            slot = (slot + 1) & (size - 1);
         }
-        j++;
+        table[slot] = i + 1;
     }
+
+    labels->table = table;
+    labels->tableSize = size;
     return 1;
 }
 
@@ -556,6 +499,12 @@ static int validate_instruction(instruction_t* ins) {
                     match = 0;
                     break;
                 }
+
+                /* A register not encoded in the instruction must be V0 */
+                if (f->ptype[j] == SYM_V && !f->pmask[j] && ins->p[j]) {
+                    match = 0;
+                    break;
+                }
             }
 
             if (match) {
@@ -565,35 +514,10 @@ static int validate_instruction(instruction_t* ins) {
         }
     }
 
-    C8_EXCEPTION(INVALID_INSTRUCTION_EXCEPTION, "Line %d: %s", ins->line, c8_lines_unformatted[ins->line - 1]);
+    C8_EXCEPTION(INVALID_INSTRUCTION_EXCEPTION, "Line %d: %.*s", ins->line, line_length(c8_line, c8_source_end), c8_line);
     return INVALID_INSTRUCTION_EXCEPTION;
 }
 
-/**
- * @brief Expand symbol list
- *
- * This function expands the symbol list by allocating more memory for it.
- * It reallocates the symbol list to a block with double the size, copying
- * the existing symbols to the new memory location. This is necessary when
- * the symbol list is full and more symbols need to be added.
- *
- * If symbols is `NULL`, it will return an `NULL_ARGUMENT_EXCEPTION`.
- *
- * @param symbols symbol list
- *
- * @return 1 if success, exception code otherwise.
- */
-static int reallocate_symbols(symbol_list_t* symbols) {
-    int newCeiling = symbols->ceil + SYMBOL_CEILING;
-    symbol_t* oldsym = symbols->s;
-    symbols->s = (symbol_t*)malloc(sizeof(symbol_t) * newCeiling);
-    memcpy(symbols->s, oldsym, symbols->ceil * sizeof(symbol_t));
-    symbols->ceil = newCeiling;
-    free(oldsym);
-
-    return 1;
-}
-
 /**
  * @brief Find the bits needed to shift to OR a parameter into an instruction
  *
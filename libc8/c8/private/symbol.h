@@ -8,13 +8,14 @@
 #ifndef CHIP8_SYMBOL_H
 #define CHIP8_SYMBOL_H
 
+#include "arena.h"
+
 #include <stdint.h>
 #include <stdlib.h>
 
-#define INSTRUCTION_COUNT 64
-#define LABEL_CEILING 64
-#define LABEL_IDENTIFIER_SIZE 20
-#define SYMBOL_CEILING 64
+#define FIXUP_CEILING 64 /* initial size */
+#define LABEL_CEILING 64 /* initial size */
+#define LABEL_TABLE_SIZE 128 /* initial size, power of 2 */
 
 /* Instruction strings */
 #define S_CLS "CLS"
@@ -100,8 +101,7 @@ typedef enum {
  * @enum Symbol
  * @brief Represents symbol types
  *
- * This enumeration defines all symbol types found during the first assembler
- * pass.
+ * This enumeration defines all symbol types found by the assembler.
  *
  * NOTE: values before label need to be kept in same order as `identifierStrings`
  */
@@ -155,8 +155,8 @@ typedef struct {
  * @struct instruction_t
  * @brief Represents an instruction
  *
- * During the second pass, this structure is used to verify the instruction's
- * validity and generate the bytecode.
+ * Once all of its operands are read, this structure is used to verify the
+ * instruction's validity and generate the bytecode.
  *
  * @param line line number
  * @param cmd instruction command
@@ -180,11 +180,11 @@ typedef struct {
  *
  * Represents a label with an identifier and byte value
  *
- * @param identifier string identifier
- * @param byte location of the label
+ * @param identifier string identifier (allocated from the list's arena)
+ * @param byte location of the label, -1 until it is defined
  */
 typedef struct {
-    char identifier[LABEL_IDENTIFIER_SIZE];
+    char* identifier;
     int byte;
 } label_t;
 
@@ -192,61 +192,84 @@ typedef struct {
  * @struct label_list_t
  * @brief Represents a list of labels
  *
+ * Labels are indexed by identifier in an open-addressing hash table, whose
+ * slots hold a label index plus 1 (0 is an empty slot). The table is
+ * allocated by the first `add_label()` and grown to stay at most half full.
+ * The list and table are grown by `add_label()` and allocated from `arena`.
+ *
  * @param l pointer to first label
  * @param len length of the list
- * @param ceil maximum length of the list
+ * @param ceil amount of labels that can fit in allocated memory
+ * @param table hash table of label indexes
+ * @param tableSize number of slots in `table`, a power of 2
+ * @param arena arena the list, table and identifiers are allocated from
  */
 typedef struct {
     label_t* l;
     int len;
     int ceil;
+    int* table;
+    int tableSize;
+    arena_t* arena;
 } label_list_t;
 
 /**
- * @struct symbol_t
- * @brief Represents a symbol with a type, value, and line number
+ * @struct fixup_t
+ * @brief Represents a reference to a label that was not defined yet
  *
- * @param type symbol type
- * @param value symbol value
+ * @param byte offset of the referencing instruction in the bytecode
+ * @param mask bits of the instruction the label's address goes in
+ * @param label label index
  * @param ln line number
  */
 typedef struct {
-    Symbol type;
-    uint16_t value;
+    int byte;
+    uint16_t mask;
+    int label;
     int ln;
-} symbol_t;
+} fixup_t;
 
 /**
- * @struct symbol_list_t
- * @brief Represents a symbol with a type, value, and line number
+ * @struct fixup_list_t
+ * @brief Represents a list of fixups
  *
- * @param s pointer to first symbol
- * @param len number of symbols in list
- * @param ceil amount of symbols that can fit in allocated memory
+ * @param f pointer to first fixup
+ * @param len number of fixups in list
+ * @param ceil amount of fixups that can fit in allocated memory
+ * @param arena arena the list is allocated from
  */
 typedef struct {
-    symbol_t* s;
+    fixup_t* f;
     int len;
     int ceil;
-} symbol_list_t;
+    arena_t* arena;
+} fixup_list_t;
+
+/**
+ * @struct symbol_t
+ * @brief Represents a symbol with a type, value, and line number
+ *
+ * @param type symbol type
+ * @param value symbol value (label index for labels)
+ * @param ln line number
+ */
+typedef struct {
+    Symbol type;
+    int value;
+    int ln;
+} symbol_t;
 
 extern const char* c8_instructionStrings[];
 extern const char* c8_identifierStrings[];
 extern instruction_format_t formats[];
 
-int build_instruction(instruction_t*, symbol_list_t*, int);
-int is_comment(const char*);
-int is_db(const char*);
-int is_dw(const char*);
-int is_instruction(const char*);
-int is_label_definition(const char*);
-int is_label(const char*, const label_list_t*);
-int is_register(const char*);
-int is_reserved_identifier(const char*);
-symbol_t* next_symbol(symbol_list_t*);
-int populate_labels(label_list_t*);
-int resolve_labels(symbol_list_t*, label_list_t*);
+int add_label(label_list_t*, const char*, size_t);
+int build_instruction(instruction_t*);
+int find_label(const label_list_t*, const char*, size_t);
+int get_label(label_list_t*, const char*, size_t);
+int is_instruction(const char*, size_t);
+int is_register(const char*, size_t);
+int is_reserved_identifier(const char*, size_t);
 int shift(uint16_t);
-int substitute_labels(symbol_list_t*, label_list_t*);
 
 #endif
@@ -0,0 +1,56 @@
+/**
+ * @file c8/private/timer.c
+ * @note NOT EXPORTED
+ *
+ * Delay and sound timers.
+ *
+ * The timers count down at 60 Hz of emulated time, where one cycle (one
+ * instruction, or one idle instruction slot while waiting for a key) is
+ * `1 / c8->cs` seconds. This keeps timer behaviour independent of how fast the
+ * host actually runs the emulation.
+ */
+
+#include "timer.h"
+
+/**
+ * @brief Advance emulated time by `cycles` and tick the timers
+ *
+ * `c8->timerCycles` carries the fraction of a tick left over between calls,
+ * so the timers tick exactly `C8_FRAME_RATE` times per `c8->cs` cycles.
+ *
+ * @param c8 the `c8_t` to advance the timers of
+ * @param cycles number of cycles that elapsed
+ *
+ * @return number of 60 Hz ticks that elapsed
+ */
+int timer_advance(c8_t* c8, int cycles) {
+    int ticks;
+
+    if (c8->cs <= 0 || cycles <= 0) {
+        return 0;
+    }
+
+    c8->timerCycles += (int64_t)cycles * C8_FRAME_RATE;
+    ticks = c8->timerCycles / c8->cs;
+    c8->timerCycles %= c8->cs;
+
+    c8->dt = c8->dt > ticks ? c8->dt - ticks : 0;
+    c8->st = c8->st > ticks ? c8->st - ticks : 0; // TODO sound
+
+    return ticks;
+}
+
+/**
+ * @brief Get the number of cycles until the timers next tick
+ *
+ * @param c8 the `c8_t` to check
+ *
+ * @return number of cycles `timer_advance` must be given for the next tick
+ */
+int timer_cycles_left(const c8_t* c8) {
+    if (c8->cs <= 0) {
+        return 0;
+    }
+
+    return (c8->cs - c8->timerCycles + C8_FRAME_RATE - 1) / C8_FRAME_RATE;
+}
@@ -0,0 +1,16 @@
+/**
+ * @file c8/private/timer.h
+ * @note NOT EXPORTED
+ *
+ * Delay and sound timers.
+ */
+
+#ifndef C8_TIMER_H
+#define C8_TIMER_H
+
+#include "../chip8.h"
+
+int timer_advance(c8_t*, int);
+int timer_cycles_left(const c8_t*);
+
+#endif
@@ -0,0 +1,148 @@
+/**
+ * @file c8/private/trace.c
+ * @note NOT EXPORTED
+ *
+ * Buffered writer for binary execution traces (see trace.h for the format).
+ *
+ * Records are collected in a large buffer and written to the file whenever it
+ * fills up, so tracing costs a few stores per instruction instead of a
+ * formatted write. They are also written when an instruction raises an
+ * exception, so a trace ends with the instruction that failed even if the
+ * process exits.
+ */
+
+#include "trace.h"
+
+#include "../trace.h"
+#include "exception.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TRACE_BUFFER_RECORDS 8192
+
+/**
+ * @struct c8_trace
+ * @brief Open trace of a `c8_t`
+ *
+ * @param f trace file
+ * @param n bytes of records in `buf`
+ * @param buf records not yet written to `f`
+ */
+struct c8_trace {
+    FILE* f;
+    size_t n;
+    uint8_t buf[TRACE_BUFFER_RECORDS * C8_TRACE_RECORD_SIZE];
+};
+
+static void flush(struct c8_trace*);
+
+/**
+ * @brief Write out buffered records and close the trace of `c8`
+ *
+ * @param c8 the `c8_t` to stop tracing
+ */
+void trace_close(c8_t* c8) {
+    struct c8_trace* t = c8->cold->trace;
+
+    c8->flags &= ~C8_FLAG_TRACE;
+    if (!t) {
+        return;
+    }
+
+    flush(t);
+    fclose(t->f);
+    free(t);
+    c8->cold->trace = NULL;
+}
+
+/**
+ * @brief Write buffered records of the trace of `c8` to the file
+ *
+ * @param c8 the `c8_t` being traced
+ */
+void trace_flush(c8_t* c8) {
+    struct c8_trace* t = c8->cold->trace;
+
+    if (t) {
+        flush(t);
+        fflush(t->f);
+    }
+}
+
+/**
+ * @brief Start tracing `c8` to the file at `path`
+ *
+ * An open trace is closed first.
+ *
+ * @param c8 the `c8_t` to trace
+ * @param path path of the trace file (truncated if it exists)
+ *
+ * @return 1 if successful, 0 otherwise
+ */
+int trace_open(c8_t* c8, const char* path) {
+    struct c8_trace* t;
+    uint8_t header[C8_TRACE_HEADER_SIZE] = {
+        'C', '8', 'T', 'R', C8_TRACE_VERSION, 0, C8_TRACE_RECORD_SIZE, 0,
+    };
+
+    trace_close(c8);
+
+    t = calloc(1, sizeof(struct c8_trace));
+    if (!t) {
+        C8_EXCEPTION(MEMORY_ALLOCATION_EXCEPTION, "At %s", __func__);
+        return 0;
+    }
+
+    t->f = fopen(path, "wb");
+    if (!t->f) {
+        C8_EXCEPTION(LOAD_FILE_FAILURE_EXCEPTION, "Could not open trace: %s", path);
+        free(t);
+        return 0;
+    }
+
+    memcpy(t->buf, header, sizeof(header));
+    t->n = sizeof(header);
+    c8->cold->trace = t;
+    c8->flags |= C8_FLAG_TRACE;
+    return 1;
+}
+
+/**
+ * @brief Append a record for an instruction that was just executed
+ *
+ * @param c8 the `c8_t` that executed the instruction
+ * @param pc address of the instruction
+ * @param opcode the instruction
+ */
+void trace_write(c8_t* c8, uint16_t pc, uint16_t opcode) {
+    struct c8_trace* t = c8->cold->trace;
+
+    if (t->n + C8_TRACE_RECORD_SIZE > sizeof(t->buf)) {
+        flush(t);
+    }
+
+    uint8_t* p = t->buf + t->n;
+    p[0] = pc & 0xFF;
+    p[1] = pc >> 8;
+    p[2] = opcode & 0xFF;
+    p[3] = opcode >> 8;
+    p[4] = c8->I & 0xFF;
+    p[5] = c8->I >> 8;
+    p[6] = c8->V[(opcode >> 8) & 0xF];
+    p[7] = c8->V[0xF];
+    t->n += C8_TRACE_RECORD_SIZE;
+}
+
+/**
+ * @brief Write buffered records to the trace file
+ *
+ * @param t trace to flush
+ */
+static void flush(struct c8_trace* t) {
+    if (t->n && fwrite(t->buf, 1, t->n, t->f) != t->n) {
+        C8_EXCEPTION(LOAD_FILE_FAILURE_EXCEPTION, "Could not write trace");
+    }
+    t->n = 0;
+}
@@ -0,0 +1,20 @@
+/**
+ * @file c8/private/trace.h
+ * @note NOT EXPORTED
+ *
+ * Buffered writer for binary execution traces.
+ */
+
+#ifndef C8_TRACE_H
+#define C8_TRACE_H
+
+#include "../chip8.h"
+
+#include <stdint.h>
+
+void trace_close(c8_t*);
+void trace_flush(c8_t*);
+int trace_open(c8_t*, const char*);
+void trace_write(c8_t*, uint16_t, uint16_t);
+
+#endif
@@ -0,0 +1,342 @@
+/**
+ * @file c8/private/undo.c
+ * @note NOT EXPORTED
+ *
+ * Per-instruction undo log used to step backwards in debug mode.
+ *
+ * Before each instruction is executed, the state it can change is appended to
+ * a byte ring as a record:
+ *
+ *     entry_t entry;                 // registers, timers, stack slot, etc.
+ *     uint8_t mem[entry.memSize];    // memory at entry.memAddr
+ *     uint64_t rows[entry.rows][];   // display rows from entry.firstRow
+ *     uint16_t size;                 // size of the whole record
+ *
+ * The memory and display rows are found by looking at the instruction, so most
+ * records are just an `entry_t`. The trailing size lets the ring be walked
+ * backwards from the newest record. When the ring is full, the oldest records
+ * are dropped.
+ */
+
+#include "undo.h"
+
+#include "exception.h"
+#include "instruction.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define UNDO_LOG_SIZE (512 * 1024)
+#define ROW_SIZE sizeof(((c8_display_t*)0)->p[0])
+
+/**
+ * @struct entry_t
+ * @brief Fixed part of an undo record
+ *
+ * @param V V registers
+ * @param R flag registers
+ * @param pc program counter
+ * @param I I register
+ * @param stack value of `stack[sp]` (the slot `CALL` writes)
+ * @param memAddr address of the saved memory
+ * @param sp stack pointer
+ * @param dt delay timer
+ * @param st sound timer
+ * @param VK V to store next keypress in
+ * @param waitingForKey 1 or 0
+ * @param running 1 or 0
+ * @param displayMode display mode
+ * @param displayX display x offset
+ * @param displayY display y offset
+ * @param memSize bytes of saved memory
+ * @param firstRow first saved display row
+ * @param rows number of saved display rows
+ * @param rng state of the `RND` generator
+ */
+typedef struct {
+    uint8_t V[16];
+    uint8_t R[8];
+    uint16_t pc;
+    uint16_t I;
+    uint16_t stack;
+    uint16_t memAddr;
+    uint8_t sp;
+    uint8_t dt;
+    uint8_t st;
+    uint8_t VK;
+    uint8_t waitingForKey;
+    uint8_t running;
+    uint8_t displayMode;
+    uint8_t displayX;
+    uint8_t displayY;
+    uint8_t memSize;
+    uint8_t firstRow;
+    uint8_t rows;
+    uint64_t rng;
+} entry_t;
+
+/**
+ * @struct c8_undo
+ * @brief Undo log of a `c8_t`
+ *
+ * @param head ring offset of the oldest record
+ * @param tail ring offset just past the newest record
+ * @param used bytes of records in the ring
+ * @param count number of records
+ * @param ring records
+ */
+struct c8_undo {
+    size_t head;
+    size_t tail;
+    size_t used;
+    int count;
+    uint8_t ring[UNDO_LOG_SIZE];
+};
+
+static void drop_oldest(struct c8_undo*);
+static size_t record_size(const entry_t*);
+static void ring_read(const struct c8_undo*, size_t, void*, size_t);
+static void ring_write(struct c8_undo*, const void*, size_t);
+static void writes(c8_t*, entry_t*);
+
+/**
+ * @brief Remove all records from the undo log of `c8`
+ *
+ * This must be called when the state of `c8` is replaced (e.g. by loading a
+ * savestate), since the records no longer lead back to it.
+ *
+ * @param c8 the `c8_t` to clear the undo log of
+ */
+void undo_clear(c8_t* c8) {
+    struct c8_undo* u = c8->cold->undo;
+
+    if (u) {
+        u->head = u->tail = u->used = 0;
+        u->count = 0;
+    }
+}
+
+/**
+ * @brief Free the undo log of `c8`
+ *
+ * @param c8 the `c8_t` to free the undo log of
+ */
+void undo_free(c8_t* c8) {
+    free(c8->cold->undo);
+    c8->cold->undo = NULL;
+}
+
+/**
+ * @brief Record the state the instruction at `c8->pc` can change
+ *
+ * The undo log is allocated on first use.
+ *
+ * @param c8 the `c8_t` about to execute an instruction
+ *
+ * @return 1 if successful, 0 otherwise
+ */
+int undo_record(c8_t* c8) {
+    struct c8_undo* u = c8->cold->undo;
+    entry_t e;
+
+    if (!u) {
+        u = calloc(1, sizeof(struct c8_undo));
+        if (!u) {
+            C8_EXCEPTION(MEMORY_ALLOCATION_EXCEPTION, "At %s", __func__);
+            return 0;
+        }
+        c8->cold->undo = u;
+    }
+
+    memset(&e, 0, sizeof(e));
+    memcpy(e.V, c8->V, sizeof(e.V));
+    memcpy(e.R, c8->R, sizeof(e.R));
+    e.pc = c8->pc;
+    e.I = c8->I;
+    e.stack = c8->sp < C8_STACK_SIZE ? c8->stack[c8->sp] : 0;
+    e.sp = c8->sp;
+    e.dt = c8->dt;
+    e.st = c8->st;
+    e.VK = c8->VK;
+    e.waitingForKey = c8->waitingForKey != 0;
+    e.running = c8->running != 0;
+    e.displayMode = c8->display.mode;
+    e.displayX = c8->display.x;
+    e.displayY = c8->display.y;
+    e.rng = c8->rng;
+    writes(c8, &e);
+
+    size_t size = record_size(&e);
+    while (u->used + size > UNDO_LOG_SIZE) {
+        drop_oldest(u);
+    }
+
+    uint16_t trailer = (uint16_t)size;
+    ring_write(u, &e, sizeof(e));
+    ring_write(u, c8->mem + e.memAddr, e.memSize);
+    ring_write(u, c8->display.p[e.firstRow], e.rows * ROW_SIZE);
+    ring_write(u, &trailer, sizeof(trailer));
+    u->used += size;
+    u->count++;
+    return 1;
+}
+
+/**
+ * @brief Undo the newest recorded instruction
+ *
+ * The record is removed, so calling this repeatedly goes further back.
+ *
+ * @param c8 the `c8_t` to step back
+ *
+ * @return 1 if an instruction was undone, 0 if the log is empty
+ */
+int undo_step(c8_t* c8) {
+    struct c8_undo* u = c8->cold->undo;
+    uint16_t size;
+    entry_t e;
+
+    if (!u || !u->count) {
+        return 0;
+    }
+
+    ring_read(u, (u->tail + UNDO_LOG_SIZE - sizeof(size)) % UNDO_LOG_SIZE, &size, sizeof(size));
+    size_t start = (u->tail + UNDO_LOG_SIZE - size) % UNDO_LOG_SIZE;
+    ring_read(u, start, &e, sizeof(e));
+
+    memcpy(c8->V, e.V, sizeof(e.V));
+    memcpy(c8->R, e.R, sizeof(e.R));
+    c8->pc = e.pc;
+    c8->I = e.I;
+    c8->sp = e.sp;
+    if (e.sp < C8_STACK_SIZE) {
+        c8->stack[e.sp] = e.stack;
+    }
+    c8->dt = e.dt;
+    c8->st = e.st;
+    c8->VK = e.VK;
+    c8->waitingForKey = e.waitingForKey;
+    c8->running = e.running;
+    c8->display.mode = e.displayMode;
+    c8->display.x = e.displayX;
+    c8->display.y = e.displayY;
+    c8->rng = e.rng;
+
+    size_t pos = (start + sizeof(e)) % UNDO_LOG_SIZE;
+    if (e.memSize) {
+        ring_read(u, pos, c8->mem + e.memAddr, e.memSize);
+        invalidate_code(c8, e.memAddr, e.memSize);
+        pos = (pos + e.memSize) % UNDO_LOG_SIZE;
+    }
+    ring_read(u, pos, c8->display.p[e.firstRow], e.rows * ROW_SIZE);
+
+    c8->draw = 1;
+    u->tail = start;
+    u->used -= size;
+    u->count--;
+    return 1;
+}
+
+/**
+ * @brief Drop the oldest record
+ *
+ * @param u undo log
+ */
+static void drop_oldest(struct c8_undo* u) {
+    entry_t e;
+
+    ring_read(u, u->head, &e, sizeof(e));
+    size_t size = record_size(&e);
+    u->head = (u->head + size) % UNDO_LOG_SIZE;
+    u->used -= size;
+    u->count--;
+}
+
+/**
+ * @brief Get the size of the record starting with `e`
+ *
+ * @param e fixed part of the record
+ *
+ * @return size in bytes
+ */
+static size_t record_size(const entry_t* e) {
+    return sizeof(*e) + e->memSize + e->rows * ROW_SIZE + sizeof(uint16_t);
+}
+
+/**
+ * @brief Copy `n` bytes at ring offset `pos` to `dst`
+ *
+ * @param u undo log
+ * @param pos ring offset
+ * @param dst where to copy to
+ * @param n number of bytes
+ */
+static void ring_read(const struct c8_undo* u, size_t pos, void* dst, size_t n) {
+    size_t first = UNDO_LOG_SIZE - pos < n ? UNDO_LOG_SIZE - pos : n;
+
+    memcpy(dst, u->ring + pos, first);
+    memcpy((uint8_t*)dst + first, u->ring, n - first);
+}
+
+/**
+ * @brief Append `n` bytes from `src` to the ring
+ *
+ * @param u undo log
+ * @param src bytes to append
+ * @param n number of bytes
+ */
+static void ring_write(struct c8_undo* u, const void* src, size_t n) {
+    size_t first = UNDO_LOG_SIZE - u->tail < n ? UNDO_LOG_SIZE - u->tail : n;
+
+    memcpy(u->ring + u->tail, src, first);
+    memcpy(u->ring, (const uint8_t*)src + first, n - first);
+    u->tail = (u->tail + n) % UNDO_LOG_SIZE;
+}
+
+/**
+ * @brief Find the memory and display rows the instruction at `c8->pc` writes
+ *
+ * Only `LD B, Vx` and `LD [I], Vx` write memory. `DRW` writes the rows the
+ * sprite covers (all rows if it wraps around the bottom), and `CLS` writes
+ * every row. Everything else an instruction can change is in `entry_t`.
+ * The instruction is predecoded if it has not been yet.
+ *
+ * @param c8 the `c8_t` about to execute an instruction
+ * @param e entry to set `memAddr`, `memSize`, `firstRow`, and `rows` of
+ */
+static void writes(c8_t* c8, entry_t* e) {
+    const c8_predecoded_t* p = &c8->predecoded[c8->pc & (C8_MEMSIZE - 1)];
+    int size = 0;
+
+    if (p->op == OP_NONE) {
+        p = predecode(c8, c8->pc);
+    }
+
+    switch (p->op) {
+    case OP_LD_B_VX: size = 3; break;
+    case OP_LD_IP_VX: size = p->x + 1; break;
+    case OP_CLS:
+        e->rows = C8_HIGH_DISPLAY_HEIGHT;
+        break;
+    case OP_DRW_VX_VY_B: {
+        int high = c8->display.mode == C8_DISPLAYMODE_HIGH;
+        int dh = high ? C8_HIGH_DISPLAY_HEIGHT : C8_LOW_DISPLAY_HEIGHT;
+        int rows = high && p->b == 0 ? 16 : p->b;
+        int py = (c8->V[p->y] + (high ? c8->display.y : 0)) % dh;
+
+        if (py + rows > dh) {
+            rows = dh;
+            py = 0;
+        }
+        e->firstRow = py;
+        e->rows = rows;
+        break;
+    }
+    default: break;
+    }
+
+    if (size && c8->I < C8_MEMSIZE) {
+        e->memAddr = c8->I;
+        e->memSize = size < C8_MEMSIZE - c8->I ? size : C8_MEMSIZE - c8->I;
+    }
+}
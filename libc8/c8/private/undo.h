@@ -0,0 +1,18 @@
+/**
+ * @file c8/private/undo.h
+ * @note NOT EXPORTED
+ *
+ * Per-instruction undo log used to step backwards in debug mode.
+ */
+
+#ifndef C8_UNDO_H
+#define C8_UNDO_H
+
+#include "../chip8.h"
+
+void undo_clear(c8_t*);
+void undo_free(c8_t*);
+int undo_record(c8_t*);
+int undo_step(c8_t*);
+
+#endif
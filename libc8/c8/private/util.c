@@ -12,6 +12,7 @@
 
 #include <ctype.h>
 #include <errno.h>
+#include <limits.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -74,6 +75,49 @@ int parse_int(const char* s) {
     return result;
 }
 
+/**
+ * @brief Parse decimal, hexadecimal or binary integer from `len` chars of `s`
+ *
+ * Like `parse_int()`, but `s` need not be null-terminated, prefixes are
+ * case-insensitive and every character has to be part of the integer.
+ *
+ * @param s string to convert
+ * @param len length of `s`
+ *
+ * @return -1 if failed, otherwise whatever the value is
+ */
+int parse_int_n(const char* s, size_t len) {
+    int base = 10;
+    size_t i = 0;
+
+    if (len && (s[0] == '$' || s[0] == 'x' || s[0] == 'X' || s[0] == 'v' || s[0] == 'V')) {
+        base = 16;
+        i = 1;
+    }
+    else if (len > 2 && s[0] == '0' && (s[1] == 'x' || s[1] == 'X')) {
+        base = 16;
+        i = 2;
+    }
+    else if (len > 2 && s[0] == '0' && (s[1] == 'b' || s[1] == 'B')) {
+        base = 2;
+        i = 2;
+    }
+    if (i >= len) {
+        return -1;
+    }
+
+    int result = 0;
+    for (; i < len; i++) {
+        int digit = hex_to_int(s[i]);
+        if (digit < 0 || digit >= base || result > (INT_MAX - digit) / base) {
+            return -1;
+        }
+        result = result * base + digit;
+    }
+
+    return result;
+}
+
 /**
  * @brief Trim leading and trailing whitespace from `s`
  *
@@ -8,10 +8,13 @@
 #ifndef C8_UTIL_H
 #define C8_UTIL_H
 
+#include <stddef.h>
+
 #define VERBOSE_PRINT(a, ...) if (a & ARG_VERBOSE) { printf(__VA_ARGS__); }
 
 int hex_to_int(char);
 int parse_int(const char*);
+int parse_int_n(const char*, size_t);
 char* trim(char*);
 
 #endif
@@ -0,0 +1,93 @@
+/**
+ * @file c8/recompile.c
+ *
+ * Runtime for ROMs statically recompiled to C by `chip8rc`.
+ *
+ * A recompiled ROM provides a dispatcher, stored in `c8->recompiled`, which
+ * runs the basic block starting at `c8->pc` and returns the number of
+ * instructions it executed. It returns 0 if there is no block at `c8->pc` or
+ * the block's code has been modified since the ROM was loaded, in which case
+ * the interpreter executes the next instruction instead.
+ */
+
+#include "recompile.h"
+
+#include "defs.h"
+
+#include "private/instruction.h"
+
+#include <string.h>
+
+/**
+ * @brief Execute the instruction at `addr` with the interpreter
+ *
+ * This sets `c8->pc` to `addr`, executes the instruction, and advances the
+ * program counter like `c8_simulate` does. Recompiled code uses this for
+ * instructions that are not translated to C (`DRW`, key input, etc.).
+ *
+ * @param c8 the `c8_t` to execute the instruction from
+ * @param addr address of the instruction
+ *
+ * @return amount the program counter was increased by, or an exception code
+ * if an error occurs.
+ */
+int c8_rc_exec(c8_t* c8, uint16_t addr) {
+    c8->pc = addr;
+
+    int ret = parse_instruction(c8);
+    if (ret >= 0) {
+        c8->pc += ret;
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Execute at least `budget` instructions using recompiled code
+ *
+ * Whole blocks are executed at a time, so the budget may be exceeded by up to
+ * one block. Execution stops early if `c8->running` is cleared or the program
+ * starts waiting for a key press.
+ *
+ * @param c8 the `c8_t` to execute
+ * @param budget number of instructions to execute
+ *
+ * @return number of instructions executed, or an exception code if an error
+ * occurs.
+ */
+int c8_rc_execute(c8_t* c8, int budget) {
+    int count = 0;
+
+    while (count < budget && c8->running && !c8->waitingForKey) {
+        int ret = c8->recompiled ? c8->recompiled(c8) : 0;
+
+        if (ret == 0) {
+            /* No valid recompiled block, interpret one instruction */
+            ret = c8_rc_exec(c8, c8->pc);
+            if (ret >= 0) {
+                ret = 1;
+            }
+        }
+
+        if (ret < 0) {
+            return ret;
+        }
+        count += ret;
+    }
+
+    return count;
+}
+
+/**
+ * @brief Check that recompiled code still matches memory
+ *
+ * @param c8 the `c8_t` to check
+ * @param rom ROM the code was recompiled from, loaded at `C8_PROG_START`
+ * @param start first address of the block
+ * @param end address after the last byte of the block
+ *
+ * @return 1 if `c8->mem` between `start` and `end` matches `rom`, 0 otherwise
+ */
+int c8_rc_valid(const c8_t* c8, const uint8_t* rom, uint16_t start, uint16_t end) {
+    return !memcmp(c8->mem + start, rom + (start - C8_PROG_START), end - start);
+}
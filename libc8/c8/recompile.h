@@ -0,0 +1,18 @@
+/**
+ * @file c8/recompile.h
+ *
+ * Runtime for ROMs statically recompiled to C by `chip8rc`.
+ */
+
+#ifndef LIBC8_RECOMPILE_H
+#define LIBC8_RECOMPILE_H
+
+#include "chip8.h"
+
+#include <stdint.h>
+
+int c8_rc_exec(c8_t*, uint16_t);
+int c8_rc_execute(c8_t*, int);
+int c8_rc_valid(const c8_t*, const uint8_t*, uint16_t, uint16_t);
+
+#endif
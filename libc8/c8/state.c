@@ -0,0 +1,588 @@
+/**
+ * @file c8/state.c
+ *
+ * Versioned binary savestates.
+ *
+ * A savestate is a header followed by chunks. All integers are little endian.
+ *
+ *     header: "C8ST", uint16_t version, uint16_t reserved
+ *     chunk:  char id[4], uint32_t size, uint32_t rawSize, uint8_t data[size]
+ *
+ * A chunk is run-length encoded (PackBits) if `size` is less than `rawSize`.
+ * Unknown chunks are skipped, and the last chunk is `END `. Version 1 has
+ * these chunks:
+ *
+ * * `CPU `: registers, stack, timers, quirks, and counters (see `put_cpu`)
+ * * `MEM `: memory
+ * * `DISP`: display mode, scroll offset, and the packed display rows
+ *
+ * Only the emulated machine is saved. Breakpoints, colors, fonts, and
+ * non-quirk flags belong to the host and are left alone when loading.
+ */
+
+#include "state.h"
+
+#include "private/exception.h"
+#include "private/instruction.h"
+#include "private/undo.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define MAGIC "C8ST"
+#define ID_CPU "CPU "
+#define ID_MEM "MEM "
+#define ID_DISPLAY "DISP"
+#define ID_END "END "
+
+#define QUIRKS (C8_FLAG_QUIRK_BITWISE | C8_FLAG_QUIRK_DRAW | \
+    C8_FLAG_QUIRK_LOADSTORE | C8_FLAG_QUIRK_SHIFT | C8_FLAG_QUIRK_JUMP)
+
+#define RLE_RUN_MIN 3
+#define RLE_RUN_MAX 128
+
+static void get_cpu(c8_t*, const uint8_t*);
+static void get_display(c8_display_t*, const uint8_t*);
+static uint16_t get16(const uint8_t*);
+static uint32_t get32(const uint8_t*);
+static uint64_t get64(const uint8_t*);
+static void put_cpu(const c8_t*, uint8_t*);
+static void put_display(const c8_display_t*, uint8_t*);
+static void put16(uint8_t*, uint16_t);
+static void put32(uint8_t*, uint32_t);
+static void put64(uint8_t*, uint64_t);
+static size_t put_chunk(uint8_t*, const char*, const uint8_t*, size_t, int);
+static int rle_decode(const uint8_t*, size_t, uint8_t*, size_t);
+static size_t rle_encode(const uint8_t*, size_t, uint8_t*, size_t);
+static int valid_cpu(const uint8_t*);
+static int valid_display(const uint8_t*);
+
+/**
+ * @brief Load a savestate file into `c8`
+ *
+ * The file is mapped into memory and parsed in place (see
+ * `c8_load_state_mem`).
+ *
+ * @param c8 the `c8_t` to load into
+ * @param path savestate path
+ *
+ * @return 1 if success, 0 otherwise (`c8` is unchanged)
+ */
+int c8_load_state(c8_t* c8, const char* path) {
+    struct stat st;
+    int ret = 0;
+    int fd = open(path, O_RDONLY);
+
+    if (fd < 0) {
+        C8_EXCEPTION(LOAD_FILE_FAILURE_EXCEPTION, "Could not open savestate: %s", path);
+        return 0;
+    }
+
+    if (fstat(fd, &st) || st.st_size <= 0) {
+        C8_EXCEPTION(INVALID_STATE_EXCEPTION, "Invalid savestate: %s", path);
+        close(fd);
+        return 0;
+    }
+
+    void* data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        C8_EXCEPTION(LOAD_FILE_FAILURE_EXCEPTION, "Could not map savestate: %s", path);
+        return 0;
+    }
+
+    ret = c8_load_state_mem(c8, data, st.st_size);
+    munmap(data, st.st_size);
+    return ret;
+}
+
+/**
+ * @brief Load a savestate from memory into `c8`
+ *
+ * The whole savestate is validated before `c8` is modified. Uncompressed
+ * chunks are copied straight from `data` into `c8`.
+ *
+ * @param c8 the `c8_t` to load into
+ * @param data savestate
+ * @param size size of `data` in bytes
+ *
+ * @return 1 if success, 0 otherwise (`c8` is unchanged)
+ */
+int c8_load_state_mem(c8_t* c8, const uint8_t* data, size_t size) {
+    uint8_t cpuBuf[C8_STATE_CPU_SIZE];
+    uint8_t memBuf[C8_STATE_MEM_SIZE];
+    uint8_t displayBuf[C8_STATE_DISPLAY_SIZE];
+    const uint8_t* cpu = NULL;
+    const uint8_t* mem = NULL;
+    const uint8_t* display = NULL;
+    const uint8_t* end = data + size;
+    int ended = 0;
+
+    if (size < C8_STATE_HEADER_SIZE || memcmp(data, MAGIC, 4)) {
+        C8_EXCEPTION(INVALID_STATE_EXCEPTION, "Not a savestate");
+        return 0;
+    }
+
+    if (get16(data + 4) != C8_STATE_VERSION) {
+        C8_EXCEPTION(INVALID_STATE_EXCEPTION, "Unsupported savestate version: %d",
+            get16(data + 4));
+        return 0;
+    }
+
+    data += C8_STATE_HEADER_SIZE;
+    while (!ended) {
+        if ((size_t)(end - data) < C8_STATE_CHUNK_HEADER_SIZE) {
+            C8_EXCEPTION(INVALID_STATE_EXCEPTION, "Savestate is truncated");
+            return 0;
+        }
+
+        const uint8_t* id = data;
+        uint32_t chunkSize = get32(data + 4);
+        uint32_t rawSize = get32(data + 8);
+        const uint8_t* chunk = data + C8_STATE_CHUNK_HEADER_SIZE;
+        const uint8_t** dest = NULL;
+        uint8_t* buf = NULL;
+        size_t expected = 0;
+
+        if (chunkSize > (size_t)(end - chunk) || chunkSize > rawSize) {
+            C8_EXCEPTION(INVALID_STATE_EXCEPTION, "Savestate chunk %.4s is truncated", id);
+            return 0;
+        }
+        data = chunk + chunkSize;
+
+        if (!memcmp(id, ID_CPU, 4)) {
+            dest = &cpu;
+            buf = cpuBuf;
+            expected = C8_STATE_CPU_SIZE;
+        }
+        else if (!memcmp(id, ID_MEM, 4)) {
+            dest = &mem;
+            buf = memBuf;
+            expected = C8_STATE_MEM_SIZE;
+        }
+        else if (!memcmp(id, ID_DISPLAY, 4)) {
+            dest = &display;
+            buf = displayBuf;
+            expected = C8_STATE_DISPLAY_SIZE;
+        }
+        else if (!memcmp(id, ID_END, 4)) {
+            ended = 1;
+            continue;
+        }
+        else {
+            /* Unknown chunk */
+            continue;
+        }
+
+        if (rawSize != expected) {
+            C8_EXCEPTION(INVALID_STATE_EXCEPTION, "Savestate chunk %.4s has the wrong size", id);
+            return 0;
+        }
+
+        if (chunkSize == rawSize) {
+            *dest = chunk;
+        }
+        else if (rle_decode(chunk, chunkSize, buf, rawSize)) {
+            *dest = buf;
+        }
+        else {
+            C8_EXCEPTION(INVALID_STATE_EXCEPTION, "Savestate chunk %.4s is corrupt", id);
+            return 0;
+        }
+    }
+
+    if (!cpu || !mem || !display) {
+        C8_EXCEPTION(INVALID_STATE_EXCEPTION, "Savestate is missing a chunk");
+        return 0;
+    }
+
+    if (!valid_cpu(cpu) || !valid_display(display)) {
+        C8_EXCEPTION(INVALID_STATE_EXCEPTION, "Savestate has invalid values");
+        return 0;
+    }
+
+    get_cpu(c8, cpu);
+    memcpy(c8->mem, mem, C8_MEMSIZE);
+    get_display(&c8->display, display);
+    invalidate_code(c8, 0, C8_MEMSIZE);
+    undo_clear(c8);
+    c8->draw = 1;
+    return 1;
+}
+
+/**
+ * @brief Save `c8` to a savestate file
+ *
+ * @param c8 the `c8_t` to save
+ * @param path savestate path
+ * @param flags `C8_STATE_COMPRESS` to compress chunks, or 0
+ *
+ * @return 1 if success, 0 otherwise
+ */
+int c8_save_state(const c8_t* c8, const char* path, int flags) {
+    uint8_t buf[C8_STATE_MAX_SIZE];
+    size_t size = c8_save_state_mem(c8, buf, sizeof(buf), flags);
+    FILE* f = fopen(path, "wb");
+
+    if (!f) {
+        C8_EXCEPTION(LOAD_FILE_FAILURE_EXCEPTION, "Could not open savestate: %s", path);
+        return 0;
+    }
+
+    if (fwrite(buf, 1, size, f) != size) {
+        C8_EXCEPTION(LOAD_FILE_FAILURE_EXCEPTION, "Could not write savestate: %s", path);
+        fclose(f);
+        return 0;
+    }
+
+    fclose(f);
+    return 1;
+}
+
+/**
+ * @brief Save `c8` to a savestate in memory
+ *
+ * @param c8 the `c8_t` to save
+ * @param buf where to store the savestate
+ * @param size size of `buf` (`C8_STATE_MAX_SIZE` is always enough)
+ * @param flags `C8_STATE_COMPRESS` to compress chunks, or 0
+ *
+ * @return size of the savestate, or 0 if `buf` is too small
+ */
+size_t c8_save_state_mem(const c8_t* c8, uint8_t* buf, size_t size, int flags) {
+    uint8_t cpu[C8_STATE_CPU_SIZE];
+    uint8_t display[C8_STATE_DISPLAY_SIZE];
+    uint8_t tmp[C8_STATE_MAX_SIZE];
+    uint8_t* p = size >= C8_STATE_MAX_SIZE ? buf : tmp;
+    size_t n = C8_STATE_HEADER_SIZE;
+    int compress = flags & C8_STATE_COMPRESS;
+
+    memcpy(p, MAGIC, 4);
+    put16(p + 4, C8_STATE_VERSION);
+    put16(p + 6, 0);
+
+    put_cpu(c8, cpu);
+    put_display(&c8->display, display);
+    n += put_chunk(p + n, ID_CPU, cpu, sizeof(cpu), 0);
+    n += put_chunk(p + n, ID_MEM, c8->mem, C8_MEMSIZE, compress);
+    n += put_chunk(p + n, ID_DISPLAY, display, sizeof(display), compress);
+    n += put_chunk(p + n, ID_END, NULL, 0, 0);
+
+    if (p == tmp) {
+        if (n > size) {
+            return 0;
+        }
+        memcpy(buf, tmp, n);
+    }
+    return n;
+}
+
+/**
+ * @brief Set the registers, stack, timers, quirks, and counters of `c8` from
+ * a `CPU ` chunk
+ *
+ * @param c8 the `c8_t` to set
+ * @param p `CPU ` chunk (see `put_cpu`)
+ */
+static void get_cpu(c8_t* c8, const uint8_t* p) {
+    memcpy(c8->V, p, 16);
+    memcpy(c8->R, p + 16, 8);
+    for (int i = 0; i < C8_STACK_SIZE; i++) {
+        c8->stack[i] = get16(p + 24 + i * 2);
+    }
+    c8->pc = get16(p + 56);
+    c8->I = get16(p + 58);
+    c8->sp = p[60];
+    c8->dt = p[61];
+    c8->st = p[62];
+    c8->mode = p[63];
+    c8->VK = p[64];
+    c8->waitingForKey = p[65];
+    c8->running = p[66];
+    c8->flags = (c8->flags & ~QUIRKS) | (get16(p + 68) & QUIRKS);
+    c8->cs = get32(p + 72);
+    c8->timerCycles = (int64_t)get64(p + 76);
+    c8->cycles = get64(p + 84);
+    c8->rng = get64(p + 92);
+}
+
+/**
+ * @brief Set a display from a `DISP` chunk
+ *
+ * @param display the display to set
+ * @param p `DISP` chunk (see `put_display`)
+ */
+static void get_display(c8_display_t* display, const uint8_t* p) {
+    display->mode = p[0];
+    display->x = p[1];
+    display->y = p[2];
+    p += 4;
+    for (int y = 0; y < C8_HIGH_DISPLAY_HEIGHT; y++) {
+        for (int w = 0; w < C8_DISPLAY_WORDS; w++) {
+            display->p[y][w] = get64(p);
+            p += 8;
+        }
+    }
+}
+
+static uint16_t get16(const uint8_t* p) {
+    return p[0] | (p[1] << 8);
+}
+
+static uint32_t get32(const uint8_t* p) {
+    return get16(p) | ((uint32_t)get16(p + 2) << 16);
+}
+
+static uint64_t get64(const uint8_t* p) {
+    return get32(p) | ((uint64_t)get32(p + 4) << 32);
+}
+
+/**
+ * @brief Write the `CPU ` chunk of `c8`
+ *
+ * | Offset | Size | Field |
+ * |--------|------|-------|
+ * | 0      | 16   | V registers |
+ * | 16     | 8    | R (flag) registers |
+ * | 24     | 32   | stack (16 x uint16_t) |
+ * | 56     | 2    | pc |
+ * | 58     | 2    | I |
+ * | 60     | 1    | sp |
+ * | 61     | 1    | dt |
+ * | 62     | 1    | st |
+ * | 63     | 1    | mode |
+ * | 64     | 1    | VK |
+ * | 65     | 1    | waitingForKey |
+ * | 66     | 1    | running |
+ * | 67     | 1    | reserved |
+ * | 68     | 2    | quirk flags |
+ * | 70     | 2    | reserved |
+ * | 72     | 4    | cs |
+ * | 76     | 8    | timerCycles |
+ * | 84     | 8    | cycles |
+ * | 92     | 8    | rng |
+ *
+ * @param c8 the `c8_t` to save
+ * @param p where to write the chunk (`C8_STATE_CPU_SIZE` bytes)
+ */
+static void put_cpu(const c8_t* c8, uint8_t* p) {
+    memset(p, 0, C8_STATE_CPU_SIZE);
+    memcpy(p, c8->V, 16);
+    memcpy(p + 16, c8->R, 8);
+    for (int i = 0; i < C8_STACK_SIZE; i++) {
+        put16(p + 24 + i * 2, c8->stack[i]);
+    }
+    put16(p + 56, c8->pc);
+    put16(p + 58, c8->I);
+    p[60] = c8->sp;
+    p[61] = c8->dt;
+    p[62] = c8->st;
+    p[63] = c8->mode;
+    p[64] = c8->VK;
+    p[65] = c8->waitingForKey != 0;
+    p[66] = c8->running != 0;
+    put16(p + 68, c8->flags & QUIRKS);
+    put32(p + 72, c8->cs);
+    put64(p + 76, (uint64_t)c8->timerCycles);
+    put64(p + 84, c8->cycles);
+    put64(p + 92, c8->rng);
+}
+
+/**
+ * @brief Write a `DISP` chunk
+ *
+ * The chunk is the display mode, x and y scroll offsets, a reserved byte, and
+ * the `C8_HIGH_DISPLAY_HEIGHT` rows of `C8_DISPLAY_WORDS` 64-bit words each.
+ *
+ * @param display display to save
+ * @param p where to write the chunk (`C8_STATE_DISPLAY_SIZE` bytes)
+ */
+static void put_display(const c8_display_t* display, uint8_t* p) {
+    p[0] = display->mode;
+    p[1] = display->x;
+    p[2] = display->y;
+    p[3] = 0;
+    p += 4;
+    for (int y = 0; y < C8_HIGH_DISPLAY_HEIGHT; y++) {
+        for (int w = 0; w < C8_DISPLAY_WORDS; w++) {
+            put64(p, display->p[y][w]);
+            p += 8;
+        }
+    }
+}
+
+static void put16(uint8_t* p, uint16_t v) {
+    p[0] = v & 0xFF;
+    p[1] = v >> 8;
+}
+
+static void put32(uint8_t* p, uint32_t v) {
+    put16(p, v & 0xFFFF);
+    put16(p + 2, v >> 16);
+}
+
+static void put64(uint8_t* p, uint64_t v) {
+    put32(p, v & 0xFFFFFFFF);
+    put32(p + 4, v >> 32);
+}
+
+/**
+ * @brief Write a chunk
+ *
+ * @param p where to write the chunk
+ * @param id chunk ID (4 characters)
+ * @param data chunk data
+ * @param size size of `data`
+ * @param compress 1 to run-length encode `data` if that makes it smaller
+ *
+ * @return number of bytes written
+ */
+static size_t put_chunk(uint8_t* p, const char* id, const uint8_t* data, size_t size, int compress) {
+    size_t n = 0;
+
+    if (compress) {
+        n = rle_encode(data, size, p + C8_STATE_CHUNK_HEADER_SIZE, size);
+    }
+    if (!n && size) {
+        memcpy(p + C8_STATE_CHUNK_HEADER_SIZE, data, size);
+        n = size;
+    }
+
+    memcpy(p, id, 4);
+    put32(p + 4, n);
+    put32(p + 8, size);
+    return C8_STATE_CHUNK_HEADER_SIZE + n;
+}
+
+/**
+ * @brief Decode PackBits data
+ *
+ * @param in encoded data
+ * @param size size of `in`
+ * @param out where to store the decoded data
+ * @param n size of `out`
+ *
+ * @return 1 if `in` decodes to exactly `n` bytes, 0 otherwise
+ */
+static int rle_decode(const uint8_t* in, size_t size, uint8_t* out, size_t n) {
+    size_t i = 0;
+    size_t o = 0;
+
+    while (i < size) {
+        uint8_t c = in[i++];
+        size_t len;
+
+        if (c < 128) {
+            len = c + 1;
+            if (len > size - i || len > n - o) {
+                return 0;
+            }
+            memcpy(out + o, in + i, len);
+            i += len;
+        }
+        else if (c > 128) {
+            len = 257 - c;
+            if (i == size || len > n - o) {
+                return 0;
+            }
+            memset(out + o, in[i++], len);
+        }
+        else {
+            return 0;
+        }
+        o += len;
+    }
+
+    return o == n;
+}
+
+/**
+ * @brief Encode data with PackBits
+ *
+ * A control byte of 0-127 is followed by that many plus one literal bytes,
+ * and a control byte of 129-255 by one byte repeated 257 minus that many
+ * times.
+ *
+ * @param in data to encode
+ * @param n size of `in`
+ * @param out where to store the encoded data
+ * @param limit size of `out`
+ *
+ * @return size of the encoded data, or 0 if it would not be smaller than
+ * `limit`
+ */
+static size_t rle_encode(const uint8_t* in, size_t n, uint8_t* out, size_t limit) {
+    size_t i = 0;
+    size_t o = 0;
+
+    while (i < n) {
+        size_t run = 1;
+        while (i + run < n && run < RLE_RUN_MAX && in[i + run] == in[i]) {
+            run++;
+        }
+
+        if (run >= RLE_RUN_MIN) {
+            if (o + 2 >= limit) {
+                return 0;
+            }
+            out[o++] = (uint8_t)(257 - run);
+            out[o++] = in[i];
+            i += run;
+            continue;
+        }
+
+        size_t start = i;
+        while (i < n && i - start < RLE_RUN_MAX &&
+            !(i + 2 < n && in[i] == in[i + 1] && in[i] == in[i + 2])) {
+            i++;
+        }
+
+        if (o + 1 + (i - start) >= limit) {
+            return 0;
+        }
+        out[o++] = (uint8_t)(i - start - 1);
+        memcpy(out + o, in + start, i - start);
+        o += i - start;
+    }
+
+    return o;
+}
+
+/**
+ * @brief Check that a `CPU ` chunk holds a state `c8_run` can continue from
+ *
+ * @param p `CPU ` chunk
+ *
+ * @return 1 if valid, 0 otherwise
+ */
+static int valid_cpu(const uint8_t* p) {
+    uint32_t cs = get32(p + 72);
+    int64_t timerCycles = (int64_t)get64(p + 76);
+
+    return get16(p + 56) < C8_MEMSIZE &&
+        p[60] <= C8_STACK_SIZE &&
+        p[63] <= C8_MODE_XOCHIP &&
+        p[64] < 16 &&
+        p[65] <= 1 &&
+        p[66] <= 1 &&
+        cs > 0 && cs <= INT32_MAX &&
+        timerCycles >= 0 && timerCycles < (int64_t)cs;
+}
+
+/**
+ * @brief Check that a `DISP` chunk is valid
+ *
+ * @param p `DISP` chunk
+ *
+ * @return 1 if valid, 0 otherwise
+ */
+static int valid_display(const uint8_t* p) {
+    /* Scrolling only wraps the offsets once they pass the display size */
+    return p[0] <= C8_DISPLAYMODE_HIGH &&
+        p[1] <= C8_HIGH_DISPLAY_WIDTH &&
+        p[2] <= C8_HIGH_DISPLAY_HEIGHT;
+}
@@ -0,0 +1,35 @@
+/**
+ * @file c8/state.h
+ *
+ * Versioned binary savestates.
+ */
+
+#ifndef LIBC8_STATE_H
+#define LIBC8_STATE_H
+
+#include "chip8.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define C8_STATE_VERSION 1
+
+#define C8_STATE_COMPRESS 0x1
+
+/* Chunk sizes of the current version, before compression */
+#define C8_STATE_HEADER_SIZE 8
+#define C8_STATE_CHUNK_HEADER_SIZE 12
+#define C8_STATE_CPU_SIZE 100
+#define C8_STATE_MEM_SIZE C8_MEMSIZE
+#define C8_STATE_DISPLAY_SIZE (4 + C8_HIGH_DISPLAY_HEIGHT * C8_DISPLAY_WORDS * 8)
+
+/* Largest possible savestate (compressed chunks are never larger) */
+#define C8_STATE_MAX_SIZE (C8_STATE_HEADER_SIZE + 4 * C8_STATE_CHUNK_HEADER_SIZE + \
+    C8_STATE_CPU_SIZE + C8_STATE_MEM_SIZE + C8_STATE_DISPLAY_SIZE)
+
+int c8_load_state(c8_t*, const char*);
+int c8_load_state_mem(c8_t*, const uint8_t*, size_t);
+int c8_save_state(const c8_t*, const char*, int);
+size_t c8_save_state_mem(const c8_t*, uint8_t*, size_t, int);
+
+#endif
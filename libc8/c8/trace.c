@@ -0,0 +1,86 @@
+/**
+ * @file c8/trace.c
+ *
+ * Binary execution traces.
+ *
+ * While a trace is open, a record is appended for every instruction the
+ * interpreter executes. A trace file is a header followed by records. All
+ * integers are little endian.
+ *
+ *     header: "C8TR", uint16_t version, uint16_t record size
+ *     record: uint16_t pc, uint16_t opcode, uint16_t I, uint8_t Vx, uint8_t VF
+ *
+ * Traced programs always run in the interpreter, since the JIT and recompiled
+ * code do not execute one instruction at a time.
+ */
+
+#include "trace.h"
+
+#include "private/trace.h"
+
+#include <string.h>
+
+/**
+ * @brief Stop tracing `c8`
+ *
+ * Buffered records are written to the trace file before it is closed. This is
+ * also done by `c8_deinit`.
+ *
+ * @param c8 the `c8_t` to stop tracing
+ */
+void c8_trace_close(c8_t* c8) {
+    trace_close(c8);
+}
+
+/**
+ * @brief Start tracing the instructions `c8` executes to a file
+ *
+ * @param c8 the `c8_t` to trace
+ * @param path path of the trace file (truncated if it exists)
+ *
+ * @return 1 if successful, 0 otherwise
+ */
+int c8_trace_open(c8_t* c8, const char* path) {
+    return trace_open(c8, path);
+}
+
+/**
+ * @brief Find the records of a trace
+ *
+ * A partial record at the end (e.g. of a trace that is still being written)
+ * is ignored.
+ *
+ * @param data trace file contents
+ * @param size size of `data` in bytes
+ * @param count where to store the number of records
+ *
+ * @return the first record, or NULL if `data` is not a trace of a supported
+ * version
+ */
+const uint8_t* c8_trace_records(const uint8_t* data, size_t size, size_t* count) {
+    if (size < C8_TRACE_HEADER_SIZE || memcmp(data, "C8TR", 4) ||
+        (data[4] | (data[5] << 8)) != C8_TRACE_VERSION ||
+        (data[6] | (data[7] << 8)) != C8_TRACE_RECORD_SIZE) {
+        return NULL;
+    }
+
+    *count = (size - C8_TRACE_HEADER_SIZE) / C8_TRACE_RECORD_SIZE;
+    return data + C8_TRACE_HEADER_SIZE;
+}
+
+/**
+ * @brief Decode record `i` of a trace
+ *
+ * @param records records returned by `c8_trace_records`
+ * @param i record index, less than the record count
+ * @param record where to store the record
+ */
+void c8_trace_read(const uint8_t* records, size_t i, c8_trace_record_t* record) {
+    const uint8_t* p = records + i * C8_TRACE_RECORD_SIZE;
+
+    record->pc = p[0] | (p[1] << 8);
+    record->opcode = p[2] | (p[3] << 8);
+    record->I = p[4] | (p[5] << 8);
+    record->vx = p[6];
+    record->vf = p[7];
+}
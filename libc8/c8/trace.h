@@ -0,0 +1,44 @@
+/**
+ * @file c8/trace.h
+ *
+ * Binary execution traces.
+ */
+
+#ifndef LIBC8_TRACE_H
+#define LIBC8_TRACE_H
+
+#include "chip8.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define C8_TRACE_VERSION 1
+#define C8_TRACE_HEADER_SIZE 8
+#define C8_TRACE_RECORD_SIZE 8
+
+/**
+ * @struct c8_trace_record_t
+ * @brief One executed instruction in a trace
+ *
+ * Register values are taken after the instruction is executed.
+ *
+ * @param pc address of the instruction
+ * @param opcode the instruction
+ * @param I I register
+ * @param vx V register `x` of the instruction (bits 8-11 of `opcode`)
+ * @param vf VF register
+ */
+typedef struct {
+    uint16_t pc;
+    uint16_t opcode;
+    uint16_t I;
+    uint8_t vx;
+    uint8_t vf;
+} c8_trace_record_t;
+
+void c8_trace_close(c8_t*);
+int c8_trace_open(c8_t*, const char*);
+const uint8_t* c8_trace_records(const uint8_t*, size_t, size_t*);
+void c8_trace_read(const uint8_t*, size_t, c8_trace_record_t*);
+
+#endif
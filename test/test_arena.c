@@ -0,0 +1,93 @@
+#include "unity.h"
+
+#include "c8/private/arena.c"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+arena_t arena;
+
+void setUp(void) {
+    arena.head = NULL;
+}
+
+void tearDown(void) {
+    arena_free(&arena);
+}
+
+void test_arena_alloc_WhereArenaIsEmpty(void) {
+    void* p = arena_alloc(&arena, 10);
+
+    TEST_ASSERT_NOT_NULL(p);
+    TEST_ASSERT_NOT_NULL(arena.head);
+    TEST_ASSERT_EQUAL_PTR(arena.head->data, p);
+    TEST_ASSERT_EQUAL_INT(0, (uintptr_t)p % sizeof(max_align_t));
+}
+
+void test_arena_alloc_WhereAllocationsAreAligned(void) {
+    uint8_t* a = arena_alloc(&arena, 1);
+    uint8_t* b = arena_alloc(&arena, 3);
+
+    TEST_ASSERT_EQUAL_INT(sizeof(max_align_t), b - a);
+    TEST_ASSERT_EQUAL_INT(0, (uintptr_t)b % sizeof(max_align_t));
+}
+
+void test_arena_alloc_WhereChunkIsFull(void) {
+    arena_alloc(&arena, ARENA_CHUNK_SIZE / 4);
+    arena_chunk_t* first = arena.head;
+    for (int i = 0; i < 4; i++) {
+        arena_alloc(&arena, ARENA_CHUNK_SIZE / 4);
+    }
+
+    TEST_ASSERT_NOT_EQUAL(first, arena.head);
+    TEST_ASSERT_EQUAL_PTR(first, arena.head->next);
+}
+
+void test_arena_alloc_WhereAllocationIsLarge(void) {
+    arena_alloc(&arena, 16);
+    arena_chunk_t* head = arena.head;
+    uint8_t* p = arena_alloc(&arena, ARENA_CHUNK_SIZE * 2);
+
+    memset(p, 0xFF, ARENA_CHUNK_SIZE * 2);
+    TEST_ASSERT_EQUAL_PTR(head, arena.head);
+    TEST_ASSERT_EQUAL_PTR(p, arena.head->next->data);
+    TEST_ASSERT_EQUAL_PTR((uint8_t*)head->data + sizeof(max_align_t), arena_alloc(&arena, 16));
+}
+
+void test_arena_calloc_WhereMemoryIsZeroed(void) {
+    uint8_t* p = arena_alloc(&arena, 64);
+    memset(p, 0xFF, 64);
+    arena_free(&arena);
+
+    int* z = arena_calloc(&arena, 16, sizeof(int));
+    for (int i = 0; i < 16; i++) {
+        TEST_ASSERT_EQUAL_INT(0, z[i]);
+    }
+}
+
+void test_arena_strndup_WhereStringIsNotTerminated(void) {
+    const char* s = "LABEL: CLS";
+
+    TEST_ASSERT_EQUAL_STRING("LABEL", arena_strndup(&arena, s, 5));
+}
+
+void test_arena_free_WhereArenaIsEmpty(void) {
+    arena_free(&arena);
+
+    TEST_ASSERT_NULL(arena.head);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_arena_alloc_WhereArenaIsEmpty);
+    RUN_TEST(test_arena_alloc_WhereAllocationsAreAligned);
+    RUN_TEST(test_arena_alloc_WhereChunkIsFull);
+    RUN_TEST(test_arena_alloc_WhereAllocationIsLarge);
+    RUN_TEST(test_arena_calloc_WhereMemoryIsZeroed);
+    RUN_TEST(test_arena_strndup_WhereStringIsNotTerminated);
+    RUN_TEST(test_arena_free_WhereArenaIsEmpty);
+
+    return UNITY_END();
+}
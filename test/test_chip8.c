@@ -0,0 +1,140 @@
+#include "unity.h"
+#include "c8/chip8.h"
+#include "c8/defs.h"
+#include "test_rom.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Busy-waits for the delay timer, then exits */
+static const uint16_t rom[] = {
+    0x603C, /* 200: LD V0, 60 */
+    0xF015, /* 202: LD DT, V0 */
+    0xF107, /* 204: LD V1, DT */
+    0x3100, /* 206: SE V1, 0 */
+    0x1204, /* 208: JP 0x204 */
+    0x00FD, /* 20A: EXIT */
+};
+
+c8_t* c8;
+
+void setUp(void) {
+    c8 = ROM_INIT(rom, C8_MODE_SCHIP, 0);
+}
+
+void tearDown(void) {
+    c8_deinit(c8);
+}
+
+void test_c8_run_WhereBudgetIsExhausted(void) {
+    TEST_ASSERT_EQUAL_INT(C8_STOP_BUDGET, c8_run(c8, 5));
+    TEST_ASSERT_EQUAL_UINT64(5, c8->cycles);
+    TEST_ASSERT_EQUAL_UINT16(0x204, c8->pc);
+    TEST_ASSERT_EQUAL_INT(C8_STOP_BUDGET, c8_run(c8, 0));
+    TEST_ASSERT_EQUAL_UINT64(5, c8->cycles);
+}
+
+void test_c8_run_WhereProgramExits(void) {
+    TEST_ASSERT_EQUAL_INT(C8_STOP_EXIT, c8_run(c8, UINT64_MAX));
+    TEST_ASSERT_EQUAL_INT(0, c8->running);
+    TEST_ASSERT_EQUAL_UINT8(0, c8->dt);
+    TEST_ASSERT_EQUAL_INT(C8_STOP_EXIT, c8_run(c8, 1));
+}
+
+void test_c8_run_WhereWaitingForKey(void) {
+    c8->mem[0x20A] = 0xF2;
+    c8->mem[0x20B] = 0x0A; // LD V2, K
+
+    TEST_ASSERT_EQUAL_INT(C8_STOP_KEY, c8_run(c8, UINT64_MAX));
+    TEST_ASSERT_EQUAL_INT(2, c8->VK);
+
+    c8->keys = 1 << 5;
+    c8->waitingForKey = 0;
+    c8->mem[0x20C] = 0x00;
+    c8->mem[0x20D] = 0xFD; // EXIT
+    TEST_ASSERT_EQUAL_INT(C8_STOP_EXIT, c8_run(c8, UINT64_MAX));
+    TEST_ASSERT_EQUAL_UINT8(5, c8->V[2]);
+}
+
+void test_c8_run_WhereExecutionIsSplit(void) {
+    c8_t* ref = ROM_INIT(rom, C8_MODE_SCHIP, 0);
+    c8->cs = ref->cs = 100 + (rand() % 10000);
+
+    while (c8_run(c8, 1 + (rand() % 50)) == C8_STOP_BUDGET);
+    TEST_ASSERT_EQUAL_INT(C8_STOP_EXIT, c8_run(ref, UINT64_MAX));
+
+    TEST_ASSERT_EQUAL_UINT64(ref->cycles, c8->cycles);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(ref->V, c8->V, 16);
+    c8_deinit(ref);
+}
+
+void test_c8_run_frames_WhereTimerIsPolled(void) {
+    TEST_ASSERT_EQUAL_INT(C8_STOP_BUDGET, c8_run_frames(c8, 1));
+    TEST_ASSERT_EQUAL_UINT8(59, c8->dt);
+    TEST_ASSERT_EQUAL_INT(C8_STOP_BUDGET, c8_run_frames(c8, 58));
+    TEST_ASSERT_EQUAL_UINT8(1, c8->dt);
+    TEST_ASSERT_EQUAL_INT(C8_STOP_EXIT, c8_run_frames(c8, 2));
+}
+
+void test_c8_run_WhereInstructionIsInvalid(void) {
+    c8->mem[0x200] = 0x00;
+    c8->mem[0x201] = 0x00;
+
+    TEST_ASSERT_EQUAL_INT(C8_STOP_ERROR, c8_run(c8, UINT64_MAX));
+}
+
+void test_c8_init_WhereROMIsTooBig(void) {
+    const char* path = "test_chip8_big.ch8";
+    FILE* f = fopen(path, "wb");
+    for (int i = 0; i < C8_MEMSIZE; i++) {
+        fputc(0xAA, f);
+    }
+    fclose(f);
+
+    TEST_ASSERT_NULL(c8_init(path, 0));
+    remove(path);
+}
+
+void test_c8_seed_WhereSeedsMatch(void) {
+    uint16_t rndRom[17];
+    c8_t* a;
+    c8_t* b;
+
+    /* RND Vx, 0xFF for every register, then EXIT */
+    for (int i = 0; i < 16; i++) {
+        rndRom[i] = 0xC0FF | (i << 8);
+    }
+    rndRom[16] = 0x00FD;
+
+    a = ROM_INIT(rndRom, C8_MODE_SCHIP, 0);
+    b = ROM_INIT(rndRom, C8_MODE_SCHIP, C8_FLAG_JIT);
+    c8_seed(a, 1234);
+    c8_seed(b, 1234);
+    TEST_ASSERT_EQUAL_INT(C8_STOP_EXIT, c8_run(a, UINT64_MAX));
+    TEST_ASSERT_EQUAL_INT(C8_STOP_EXIT, c8_run(b, UINT64_MAX));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(a->V, b->V, 16);
+
+    c8_deinit(b);
+    b = ROM_INIT(rndRom, C8_MODE_SCHIP, 0);
+    c8_seed(b, 1235);
+    TEST_ASSERT_EQUAL_INT(C8_STOP_EXIT, c8_run(b, UINT64_MAX));
+    TEST_ASSERT_TRUE(memcmp(a->V, b->V, 16) != 0);
+
+    c8_deinit(a);
+    c8_deinit(b);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_c8_run_WhereBudgetIsExhausted);
+    RUN_TEST(test_c8_run_WhereProgramExits);
+    RUN_TEST(test_c8_run_WhereWaitingForKey);
+    RUN_TEST(test_c8_run_WhereExecutionIsSplit);
+    RUN_TEST(test_c8_run_frames_WhereTimerIsPolled);
+    RUN_TEST(test_c8_run_WhereInstructionIsInvalid);
+    RUN_TEST(test_c8_init_WhereROMIsTooBig);
+    RUN_TEST(test_c8_seed_WhereSeedsMatch);
+    return UNITY_END();
+}
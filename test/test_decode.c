@@ -365,6 +365,15 @@ void test_decode_instruction_WhereInstructionIsLDXR(void) {
     test_decode_instruction_should_parse(buf, ins);
 }
 
+void test_decode_instruction_r_WhereBufferIsGiven(void) {
+    char out[C8_DECODE_MAX_LENGTH];
+    uint16_t ins = BUILD_INSTRUCTION_AXKK(0xF, x, 0x65);
+
+    sprintf(buf, "LD V%01X, [I]", x);
+    TEST_ASSERT_EQUAL_PTR(out, c8_decode_instruction_r(ins, label_map, out, sizeof(out)));
+    TEST_ASSERT_EQUAL_STRING(buf, out);
+}
+
 int main(void) {
     srand(time(NULL));
 
@@ -416,5 +425,6 @@ int main(void) {
     RUN_TEST(test_decode_instruction_WhereInstructionIsLDXIP);
     RUN_TEST(test_decode_instruction_WhereInstructionIsLDRX);
     RUN_TEST(test_decode_instruction_WhereInstructionIsLDXR);
+    RUN_TEST(test_decode_instruction_r_WhereBufferIsGiven);
     return UNITY_END();
 }
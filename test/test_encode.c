@@ -11,138 +11,259 @@
 #include <time.h>
 
 #define BYTECODE_SIZE (C8_MEMSIZE - C8_PROG_START)
-#define BUF_SIZE (BYTECODE_SIZE * C8_ENCODE_MAX_LINE_LENGTH)
+/* Room for a 100 character source line per byte of bytecode */
+#define BUF_SIZE (BYTECODE_SIZE * 100)
 
 char buf[BUF_SIZE];
 uint8_t* bytecode;
 int fmtCount;
 int insCount;
 
-symbol_list_t symbols;
+symbol_t sym;
 label_list_t labels;
+arena_t arena;
 
 void setUp(void) {
     memset(bytecode, 0, BYTECODE_SIZE);
     memset(buf, 0, BUF_SIZE);
+    memset(&sym, 0, sizeof(symbol_t));
 
     memset(labels.l, 0, LABEL_CEILING * sizeof(label_t));
     labels.len = 0;
     labels.ceil = LABEL_CEILING;
-
-    memset(symbols.s, 0, SYMBOL_CEILING * sizeof(symbol_t)); \
-        symbols.len = 0; \
-        symbols.ceil = SYMBOL_CEILING;
+    labels.table = NULL;
+    labels.tableSize = 0;
 }
 
 void tearDown(void) {
 }
 
-void test_remove_comment_WhereStringHasNoComment(void) {
-    const char* s = "String without a comment";
-    sprintf(buf, "%s", s);
-    TEST_ASSERT_EQUAL_STRING(s, remove_comment(buf));
+void test_c8_encode_WhereStringIsOnlyComment(void) {
+    char* s = "; A comment";
+    sprintf(buf, "%s\n", s);
+    int r = c8_encode(buf, bytecode, 0);
+    TEST_ASSERT_EQUAL_INT(0, r);
+    TEST_ASSERT_EQUAL_INT(0, bytecode[0]);
 }
 
-void test_remove_comment_WhereStringHasCommentAtEnd(void) {
-    const char* s = "String with a comment";
-    sprintf(buf, "%s ; comment", s);
-    TEST_ASSERT_EQUAL_STRING(s, remove_comment(buf));
+void test_c8_encode_WhereLabelIsPrefixOfOtherLabel(void) {
+    sprintf(buf, "LOOP1:\nJP LOOP10\nLOOP10:\nJP LOOP1\n");
+    int r = c8_encode(buf, bytecode, 0);
+    TEST_ASSERT_EQUAL_INT(4, r);
+    TEST_ASSERT_EQUAL_HEX8(0x12, bytecode[0]);
+    TEST_ASSERT_EQUAL_HEX8(0x02, bytecode[1]);
+    TEST_ASSERT_EQUAL_HEX8(0x12, bytecode[2]);
+    TEST_ASSERT_EQUAL_HEX8(0x00, bytecode[3]);
 }
 
-void test_remove_comment_WhereStringIsOnlyComment(void) {
-    const char* s = "; A comment";
-    sprintf(buf, "%s", s);
-    TEST_ASSERT_EQUAL_INT(0, strlen(remove_comment(buf)));
+void test_c8_encode_WhereLabelIsForwardReference(void) {
+    sprintf(buf, "JP END\nCLS\nEND:\nRET\n");
+    int r = c8_encode(buf, bytecode, 0);
+    TEST_ASSERT_EQUAL_INT(6, r);
+    TEST_ASSERT_EQUAL_HEX8(0x12, bytecode[0]);
+    TEST_ASSERT_EQUAL_HEX8(0x04, bytecode[1]);
+    TEST_ASSERT_EQUAL_HEX8(0x00, bytecode[2]);
+    TEST_ASSERT_EQUAL_HEX8(0xE0, bytecode[3]);
 }
 
-void test_c8_encode_WhereStringIsOnlyComment(void) {
-    char* s = "; A comment";
-    sprintf(buf, "%s\n", s);
+void test_c8_encode_WhereLabelIsForwardReferenceInLD(void) {
+    sprintf(buf, "LD I, SPRITE\nRET\nSPRITE:\n.DB $FF\n");
     int r = c8_encode(buf, bytecode, 0);
-    TEST_ASSERT_EQUAL_INT(0, r);
-    TEST_ASSERT_EQUAL_INT(0, bytecode[0]);
+    TEST_ASSERT_EQUAL_INT(5, r);
+    TEST_ASSERT_EQUAL_HEX8(0xA2, bytecode[0]);
+    TEST_ASSERT_EQUAL_HEX8(0x04, bytecode[1]);
+    TEST_ASSERT_EQUAL_HEX8(0xFF, bytecode[4]);
+}
+
+void test_c8_encode_WhereLabelIsForwardReferenceInJPV0(void) {
+    sprintf(buf, "JP V0, TABLE\nCLS\nTABLE:\nRET\n");
+    int r = c8_encode(buf, bytecode, 0);
+    TEST_ASSERT_EQUAL_INT(6, r);
+    TEST_ASSERT_EQUAL_HEX8(0xB2, bytecode[0]);
+    TEST_ASSERT_EQUAL_HEX8(0x04, bytecode[1]);
+}
+
+void test_c8_encode_WhereJPRegisterIsNotV0(void) {
+    sprintf(buf, "JP V3, $200\n");
+    TEST_ASSERT_EQUAL_INT(INVALID_INSTRUCTION_EXCEPTION, c8_encode(buf, bytecode, 0));
+}
+
+void test_c8_encode_WhereLabelIsForwardReferencedTwice(void) {
+    sprintf(buf, "CALL DRAW\nJP DRAW\nLD I, DRAW\nDRAW:\nRET\n");
+    int r = c8_encode(buf, bytecode, 0);
+    TEST_ASSERT_EQUAL_INT(8, r);
+    TEST_ASSERT_EQUAL_HEX8(0x22, bytecode[0]);
+    TEST_ASSERT_EQUAL_HEX8(0x06, bytecode[1]);
+    TEST_ASSERT_EQUAL_HEX8(0x12, bytecode[2]);
+    TEST_ASSERT_EQUAL_HEX8(0x06, bytecode[3]);
+    TEST_ASSERT_EQUAL_HEX8(0xA2, bytecode[4]);
+    TEST_ASSERT_EQUAL_HEX8(0x06, bytecode[5]);
+}
+
+void test_c8_encode_WhereProgramIsTooBig(void) {
+    for (int i = 0; i <= BYTECODE_SIZE / 2; i++) {
+        strcat(buf, "CLS\n");
+    }
+    TEST_ASSERT_EQUAL_INT(FILE_TOO_BIG_EXCEPTION, c8_encode(buf, bytecode, 0));
+}
+
+void test_c8_encode_WhereLabelIsPastEndOfMemory(void) {
+    strcat(buf, "JP END\n");
+    for (int i = 1; i < BYTECODE_SIZE / 2; i++) {
+        strcat(buf, "CLS\n");
+    }
+    strcat(buf, "END:\n");
+    TEST_ASSERT_EQUAL_INT(FILE_TOO_BIG_EXCEPTION, c8_encode(buf, bytecode, 0));
+
+    memset(buf, 0, BUF_SIZE);
+    for (int i = 0; i < BYTECODE_SIZE / 2; i++) {
+        strcat(buf, "CLS\n");
+    }
+    strcat(buf, "END:\nJP END\n");
+    TEST_ASSERT_EQUAL_INT(FILE_TOO_BIG_EXCEPTION, c8_encode(buf, bytecode, 0));
+}
+
+void test_c8_encode_WhereLabelIsLowercase(void) {
+    sprintf(buf, "loop:\nCALL draw\nJP loop\ndraw:\nRET\n");
+    int r = c8_encode(buf, bytecode, 0);
+    TEST_ASSERT_EQUAL_INT(6, r);
+    TEST_ASSERT_EQUAL_HEX8(0x22, bytecode[0]);
+    TEST_ASSERT_EQUAL_HEX8(0x04, bytecode[1]);
+    TEST_ASSERT_EQUAL_HEX8(0x12, bytecode[2]);
+    TEST_ASSERT_EQUAL_HEX8(0x00, bytecode[3]);
+}
+
+void test_c8_encode_WhereLabelIsUndefined(void) {
+    sprintf(buf, "JP NOWHERE\n");
+    TEST_ASSERT_EQUAL_INT(INVALID_SYMBOL_EXCEPTION, c8_encode(buf, bytecode, 0));
+}
+
+void test_c8_encode_WhereDataIsDefined(void) {
+    sprintf(buf, ".db 100\n.DW $1234 ; word\n");
+    int r = c8_encode(buf, bytecode, 0);
+    TEST_ASSERT_EQUAL_INT(3, r);
+    TEST_ASSERT_EQUAL_HEX8(100, bytecode[0]);
+    TEST_ASSERT_EQUAL_HEX8(0x12, bytecode[1]);
+    TEST_ASSERT_EQUAL_HEX8(0x34, bytecode[2]);
+}
+
+void test_c8_encode_WhereDataIsMissing(void) {
+    sprintf(buf, ".DB\nCLS\n");
+    TEST_ASSERT_EQUAL_INT(INVALID_ARGUMENT_EXCEPTION, c8_encode(buf, bytecode, 0));
+}
+
+void test_c8_encode_WhereSourceIsLowercase(void) {
+    sprintf(buf, "\tld v1, 0x2A\r\n\tdrw v1,v2,$5 ; draw\n");
+    int r = c8_encode(buf, bytecode, 0);
+    TEST_ASSERT_EQUAL_INT(4, r);
+    TEST_ASSERT_EQUAL_HEX8(0x61, bytecode[0]);
+    TEST_ASSERT_EQUAL_HEX8(0x2A, bytecode[1]);
+    TEST_ASSERT_EQUAL_HEX8(0xD1, bytecode[2]);
+    TEST_ASSERT_EQUAL_HEX8(0x25, bytecode[3]);
+}
+
+void test_c8_encode_mem_WhereSourceIsNotNullTerminated(void) {
+    const char* s = "CLS\nRET\nJP $234";
+    int r = c8_encode_mem(s, 7, bytecode, 0);
+    TEST_ASSERT_EQUAL_INT(4, r);
+    TEST_ASSERT_EQUAL_HEX8(0xE0, bytecode[1]);
+    TEST_ASSERT_EQUAL_HEX8(0xEE, bytecode[3]);
+    TEST_ASSERT_EQUAL_HEX8(0x00, bytecode[4]);
 }
 
-void test_line_count_WhereStringHasOneLine(void) {
-    const char* s = "ABCD";
-    TEST_ASSERT_EQUAL_INT(2, line_count(s));
+void test_c8_encode_file_WhereFileExists(void) {
+    const char* path = "test_encode.c8s";
+    FILE* f = fopen(path, "w");
+    TEST_ASSERT_NOT_NULL(f);
+    fputs("START:\nCALL DRAW\nJP START\nDRAW:\nRET", f);
+    fclose(f);
+
+    int r = c8_encode_file(path, bytecode, 0);
+    remove(path);
+    TEST_ASSERT_EQUAL_INT(6, r);
+    TEST_ASSERT_EQUAL_HEX8(0x22, bytecode[0]);
+    TEST_ASSERT_EQUAL_HEX8(0x04, bytecode[1]);
+    TEST_ASSERT_EQUAL_HEX8(0xEE, bytecode[5]);
 }
 
-void test_line_count_WhereStringHasMultipleLines(void) {
-    const char* s = "ABCD\nEFGH\nIJKL\n";
-    TEST_ASSERT_EQUAL_INT(4, line_count(s));
+void test_c8_encode_file_WhereFileDoesNotExist(void) {
+    TEST_ASSERT_EQUAL_INT(LOAD_FILE_FAILURE_EXCEPTION, c8_encode_file("does/not/exist.c8s", bytecode, 0));
 }
 
-void test_parse_word_WhereWordIsLabelDefinition(void) {
-    const char* s = "ldef";
+void test_c8_encode_WhereLabelIsDuplicate(void) {
+    sprintf(buf, "LOOP:\nCLS\nLOOP:\nJP LOOP\n");
+    TEST_ASSERT_EQUAL_INT(DUPLICATE_LABEL_EXCEPTION, c8_encode(buf, bytecode, 0));
+}
+
+void test_parse_word_WhereWordIsLowercase(void) {
+    sprintf(buf, "%s", "sknp");
+    int r = parse_word(buf, strlen(buf), 1, &sym, &labels);
+
+    TEST_ASSERT_EQUAL_INT(0, r);
+    TEST_ASSERT_EQUAL_INT(SYM_INSTRUCTION, sym.type);
+    TEST_ASSERT_EQUAL_INT(I_SKNP, sym.value);
+}
 
-    sprintf(buf, "%s:", s);
-    labels.len = 1;
-    sprintf(labels.l[0].identifier, "%s", s);
-    int r = parse_word(buf, NULL, 1, &symbols.s[0], &labels);
+void test_parse_word_WhereWordIsNotNullTerminated(void) {
+    sprintf(buf, "%s", "V3,V4");
+    int r = parse_word(buf, 2, 1, &sym, &labels);
 
     TEST_ASSERT_EQUAL_INT(0, r);
-    TEST_ASSERT_EQUAL_INT(SYM_LABEL_DEFINITION, symbols.s[0].type);
-    TEST_ASSERT_EQUAL_INT(0, symbols.s[0].value);
+    TEST_ASSERT_EQUAL_INT(SYM_V, sym.type);
+    TEST_ASSERT_EQUAL_INT(3, sym.value);
 }
 
 void test_parse_word_WhereWordIsInstruction(void) {
     int ins = rand() % insCount;
 
     sprintf(buf, "%s", c8_instructionStrings[ins]);
-    int r = parse_word(buf, NULL, 1, &symbols.s[0], &labels);
+    int r = parse_word(buf, strlen(buf), 1, &sym, &labels);
 
     TEST_ASSERT_EQUAL_INT(0, r);
-    TEST_ASSERT_EQUAL_INT(SYM_INSTRUCTION, symbols.s[0].type);
-    TEST_ASSERT_EQUAL_INT(ins, symbols.s[0].value);
+    TEST_ASSERT_EQUAL_INT(SYM_INSTRUCTION, sym.type);
+    TEST_ASSERT_EQUAL_INT(ins, sym.value);
 }
 
 void test_parse_word_WhereWordIsDB(void) {
-    int v = 100;
     sprintf(buf, "%s", S_DB);
-    sprintf(buf + 10, "%d", v);
-    int r = parse_word(buf, buf + 10, 1, &symbols.s[0], &labels);
+    int r = parse_word(buf, strlen(buf), 1, &sym, &labels);
 
-    TEST_ASSERT_EQUAL_INT(1, r);
-    TEST_ASSERT_EQUAL_INT(SYM_DB, symbols.s[0].type);
-    TEST_ASSERT_EQUAL_INT(v, symbols.s[0].value);
+    TEST_ASSERT_EQUAL_INT(0, r);
+    TEST_ASSERT_EQUAL_INT(SYM_DB, sym.type);
 }
 
 void test_parse_word_WhereWordIsDW(void) {
-    int v = 500;
     sprintf(buf, "%s", S_DW);
-    sprintf(buf + 10, "%d", v);
-    int r = parse_word(buf, buf + 10, 1, &symbols.s[0], &labels);
+    int r = parse_word(buf, strlen(buf), 1, &sym, &labels);
 
-    TEST_ASSERT_EQUAL_INT(1, r);
-    TEST_ASSERT_EQUAL_INT(SYM_DW, symbols.s[0].type);
-    TEST_ASSERT_EQUAL_INT(v, symbols.s[0].value);
+    TEST_ASSERT_EQUAL_INT(0, r);
+    TEST_ASSERT_EQUAL_INT(SYM_DW, sym.type);
 }
 
 void test_parse_word_WhereWordIsRegister(void) {
     int v = 12;
     sprintf(buf, "V%01x", v);
-    int r = parse_word(buf, NULL, 1, &symbols.s[0], &labels);
+    int r = parse_word(buf, strlen(buf), 1, &sym, &labels);
 
     TEST_ASSERT_EQUAL_INT(0, r);
-    TEST_ASSERT_EQUAL_INT(SYM_V, symbols.s[0].type);
-    TEST_ASSERT_EQUAL_INT(v, symbols.s[0].value);
+    TEST_ASSERT_EQUAL_INT(SYM_V, sym.type);
+    TEST_ASSERT_EQUAL_INT(v, sym.value);
 }
 
 void test_parse_word_WhereWordIsReservedIdentifier(void) {
     sprintf(buf, "%s", S_HF);
-    int r = parse_word(buf, NULL, 1, &symbols.s[0], &labels);
+    int r = parse_word(buf, strlen(buf), 1, &sym, &labels);
 
     TEST_ASSERT_EQUAL_INT(0, r);
-    TEST_ASSERT_EQUAL_INT(SYM_HF, symbols.s[0].type);
-    TEST_ASSERT_EQUAL_INT(0, symbols.s[0].value);
+    TEST_ASSERT_EQUAL_INT(SYM_HF, sym.type);
+    TEST_ASSERT_EQUAL_INT(0, sym.value);
 
     sprintf(buf, "%s", S_IP);
-    r = parse_word(buf, NULL, 1, &symbols.s[0], &labels);
+    r = parse_word(buf, strlen(buf), 1, &sym, &labels);
 
     TEST_ASSERT_EQUAL_INT(0, r);
-    TEST_ASSERT_EQUAL_INT(SYM_IP, symbols.s[0].type);
-    TEST_ASSERT_EQUAL_INT(0, symbols.s[0].value);
+    TEST_ASSERT_EQUAL_INT(SYM_IP, sym.type);
+    TEST_ASSERT_EQUAL_INT(0, sym.value);
 }
 
 void test_parse_word_WhereWordIsInt(void) {
@@ -151,67 +272,91 @@ void test_parse_word_WhereWordIsInt(void) {
     int v12 = 512;
 
     sprintf(buf, "$%x", v4);
-    int r = parse_word(buf, NULL, 1, &symbols.s[0], &labels);
+    int r = parse_word(buf, strlen(buf), 1, &sym, &labels);
     TEST_ASSERT_EQUAL_INT(0, r);
-    TEST_ASSERT_EQUAL_INT(SYM_INT4, symbols.s[0].type);
-    TEST_ASSERT_EQUAL_INT(v4, symbols.s[0].value);
+    TEST_ASSERT_EQUAL_INT(SYM_INT4, sym.type);
+    TEST_ASSERT_EQUAL_INT(v4, sym.value);
 
     memset(buf, 0, BUF_SIZE);
 
     sprintf(buf, "$%x", v8);
-    r = parse_word(buf, NULL, 1, &symbols.s[0], &labels);
+    r = parse_word(buf, strlen(buf), 1, &sym, &labels);
     TEST_ASSERT_EQUAL_INT(0, r);
-    TEST_ASSERT_EQUAL_INT(SYM_INT8, symbols.s[0].type);
-    TEST_ASSERT_EQUAL_INT(v8, symbols.s[0].value);
+    TEST_ASSERT_EQUAL_INT(SYM_INT8, sym.type);
+    TEST_ASSERT_EQUAL_INT(v8, sym.value);
 
     memset(buf, 0, BUF_SIZE);
 
     sprintf(buf, "$%x", v12);
-    r = parse_word(buf, NULL, 1, &symbols.s[0], &labels);
+    r = parse_word(buf, strlen(buf), 1, &sym, &labels);
     TEST_ASSERT_EQUAL_INT(0, r);
-    TEST_ASSERT_EQUAL_INT(SYM_INT12, symbols.s[0].type);
-    TEST_ASSERT_EQUAL_INT(v12, symbols.s[0].value);
+    TEST_ASSERT_EQUAL_INT(SYM_INT12, sym.type);
+    TEST_ASSERT_EQUAL_INT(v12, sym.value);
 }
 
 void test_parse_word_WhereWordIsLabel(void) {
     const char* l = "LABEL";
-    labels.len = 2;
-    sprintf(labels.l[0].identifier, "otherlabel");
-    sprintf(labels.l[1].identifier, "%s", l);
+    add_label(&labels, "otherlabel", 10);
+    add_label(&labels, l, strlen(l));
     sprintf(buf, "%s", l);
 
-    int r = parse_word(buf, NULL, 1, &symbols.s[0], &labels);
+    int r = parse_word(buf, strlen(buf), 1, &sym, &labels);
+    TEST_ASSERT_EQUAL_INT(0, r);
+    TEST_ASSERT_EQUAL_INT(SYM_LABEL, sym.type);
+    TEST_ASSERT_EQUAL_INT(1, sym.value);
+}
+
+void test_parse_word_WhereWordIsForwardLabel(void) {
+    sprintf(buf, "%s", "later");
+
+    int r = parse_word(buf, strlen(buf), 1, &sym, &labels);
     TEST_ASSERT_EQUAL_INT(0, r);
-    TEST_ASSERT_EQUAL_INT(SYM_LABEL, symbols.s[0].type);
-    TEST_ASSERT_EQUAL_INT(1, symbols.s[0].value);
+    TEST_ASSERT_EQUAL_INT(SYM_LABEL, sym.type);
+    TEST_ASSERT_EQUAL_INT(0, sym.value);
+    TEST_ASSERT_EQUAL_INT(-1, labels.l[0].byte);
 }
 
 void test_parse_word_WhereWordIsInvalid(void) {
-    const char* s = "Invalid";
+    const char* s = "@Invalid";
     sprintf(buf, "%s", s);
 
-    int r = parse_word(buf, NULL, 1, &symbols.s[0], &labels);
+    int r = parse_word(buf, strlen(buf), 1, &sym, &labels);
     TEST_ASSERT_EQUAL_INT(INVALID_SYMBOL_EXCEPTION, r);
-    TEST_ASSERT_EQUAL_INT(0, symbols.len);
+    TEST_ASSERT_EQUAL_INT(0, labels.len);
 }
 
 int main(void) {
     srand(time(NULL));
 
     bytecode = calloc(BYTECODE_SIZE, 1);
-    symbols.s = calloc(SYMBOL_CEILING, sizeof(symbol_t));
-    symbols.ceil = SYMBOL_CEILING;
-    labels.l = calloc(LABEL_CEILING, sizeof(label_t));
+    labels.l = arena_calloc(&arena, LABEL_CEILING, sizeof(label_t));
     labels.ceil = LABEL_CEILING;
+    labels.arena = &arena;
 
     for (fmtCount = 0; formats[fmtCount].cmd != I_NULL; fmtCount++);
     for (insCount = 0; c8_instructionStrings[insCount] != NULL; insCount++);
 
     UNITY_BEGIN();
-    RUN_TEST(test_remove_comment_WhereStringHasNoComment);
-    RUN_TEST(test_remove_comment_WhereStringHasCommentAtEnd);
-    RUN_TEST(test_remove_comment_WhereStringIsOnlyComment);
     RUN_TEST(test_c8_encode_WhereStringIsOnlyComment);
+    RUN_TEST(test_c8_encode_WhereLabelIsPrefixOfOtherLabel);
+    RUN_TEST(test_c8_encode_WhereLabelIsForwardReference);
+    RUN_TEST(test_c8_encode_WhereLabelIsForwardReferenceInLD);
+    RUN_TEST(test_c8_encode_WhereLabelIsForwardReferenceInJPV0);
+    RUN_TEST(test_c8_encode_WhereJPRegisterIsNotV0);
+    RUN_TEST(test_c8_encode_WhereLabelIsForwardReferencedTwice);
+    RUN_TEST(test_c8_encode_WhereProgramIsTooBig);
+    RUN_TEST(test_c8_encode_WhereLabelIsPastEndOfMemory);
+    RUN_TEST(test_c8_encode_WhereLabelIsLowercase);
+    RUN_TEST(test_c8_encode_WhereLabelIsUndefined);
+    RUN_TEST(test_c8_encode_WhereLabelIsDuplicate);
+    RUN_TEST(test_c8_encode_WhereDataIsDefined);
+    RUN_TEST(test_c8_encode_WhereDataIsMissing);
+    RUN_TEST(test_c8_encode_WhereSourceIsLowercase);
+    RUN_TEST(test_c8_encode_mem_WhereSourceIsNotNullTerminated);
+    RUN_TEST(test_c8_encode_file_WhereFileExists);
+    RUN_TEST(test_c8_encode_file_WhereFileDoesNotExist);
+    RUN_TEST(test_parse_word_WhereWordIsLowercase);
+    RUN_TEST(test_parse_word_WhereWordIsNotNullTerminated);
     RUN_TEST(test_parse_word_WhereWordIsDB);
     RUN_TEST(test_parse_word_WhereWordIsDW);
     RUN_TEST(test_parse_word_WhereWordIsInstruction);
@@ -219,11 +364,11 @@ int main(void) {
     RUN_TEST(test_parse_word_WhereWordIsReservedIdentifier);
     RUN_TEST(test_parse_word_WhereWordIsInt);
     RUN_TEST(test_parse_word_WhereWordIsLabel);
+    RUN_TEST(test_parse_word_WhereWordIsForwardLabel);
     RUN_TEST(test_parse_word_WhereWordIsInvalid);
 
     free(bytecode);
-    free(symbols.s);
-    free(labels.l);
+    arena_free(&arena);
     return UNITY_END();
 
 }
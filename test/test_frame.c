@@ -0,0 +1,76 @@
+#include "unity.h"
+#include "c8/private/frame.c"
+
+#include <pthread.h>
+#include <stdint.h>
+#include <string.h>
+
+#define FRAME_COUNT 100000
+
+frame_exchange_t fx;
+
+void setUp(void) {
+    frame_init(&fx);
+}
+
+void tearDown(void) {
+}
+
+static void* produce(void* arg) {
+    for (int i = 1; i <= FRAME_COUNT; i++) {
+        frame_t* f = frame_back(&fx);
+        for (int j = 0; j < C8_HIGH_DISPLAY_HEIGHT; j++) {
+            f->display.p[j][0] = i;
+            f->display.p[j][1] = i;
+        }
+        f->colors[0] = i;
+        frame_publish(&fx);
+    }
+    return NULL;
+}
+
+void test_frame_latest_WhereNothingIsPublished(void) {
+    TEST_ASSERT_NULL(frame_latest(&fx));
+}
+
+void test_frame_latest_WhereFramesAreDropped(void) {
+    for (int i = 1; i <= 3; i++) {
+        frame_back(&fx)->colors[0] = i;
+        frame_publish(&fx);
+    }
+
+    frame_t* f = frame_latest(&fx);
+    TEST_ASSERT_NOT_NULL(f);
+    TEST_ASSERT_EQUAL_INT(3, f->colors[0]);
+    TEST_ASSERT_NULL(frame_latest(&fx));
+}
+
+void test_frame_latest_WhereProducerIsConcurrent(void) {
+    pthread_t thread;
+    int last = 0;
+
+    TEST_ASSERT_EQUAL_INT(0, pthread_create(&thread, NULL, produce, NULL));
+    while (last < FRAME_COUNT) {
+        frame_t* f = frame_latest(&fx);
+        if (!f) {
+            continue;
+        }
+
+        /* Frames arrive in order and are never torn */
+        TEST_ASSERT_GREATER_THAN(last, f->colors[0]);
+        last = f->colors[0];
+        for (int j = 0; j < C8_HIGH_DISPLAY_HEIGHT; j++) {
+            TEST_ASSERT_EQUAL_INT(last, f->display.p[j][0]);
+            TEST_ASSERT_EQUAL_INT(last, f->display.p[j][1]);
+        }
+    }
+    pthread_join(thread, NULL);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_frame_latest_WhereNothingIsPublished);
+    RUN_TEST(test_frame_latest_WhereFramesAreDropped);
+    RUN_TEST(test_frame_latest_WhereProducerIsConcurrent);
+    return UNITY_END();
+}
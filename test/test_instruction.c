@@ -73,15 +73,16 @@ void tearDown(void) { }
 void test_parse_instruction_WhereInstructionIsCLS(void) {
     INSERT_INSTRUCTION(pc, 0x00E0);
 
-    x %= C8_HIGH_DISPLAY_WIDTH * C8_HIGH_DISPLAY_HEIGHT;
-    y %= C8_HIGH_DISPLAY_WIDTH * C8_HIGH_DISPLAY_HEIGHT;
-    c8.display.p[x] = 1;
-    c8.display.p[y] = 1;
+    c8.display.p[vy % C8_HIGH_DISPLAY_HEIGHT][0] |= C8_PIXEL_MASK(vx);
+    c8.display.p[vx % C8_HIGH_DISPLAY_HEIGHT][1] |= C8_PIXEL_MASK(vy);
 
     int ret = parse_instruction(&c8);
     TEST_ASSERT_EQUAL_INT(2, ret);
-    TEST_ASSERT_EQUAL_UINT8(0, c8.display.p[x]);
-    TEST_ASSERT_EQUAL_UINT8(0, c8.display.p[y]);
+    for (int i = 0; i < C8_HIGH_DISPLAY_WIDTH; i++) {
+        for (int j = 0; j < C8_HIGH_DISPLAY_HEIGHT; j++) {
+            TEST_ASSERT_EQUAL_INT(0, c8_get_pixel(&c8.display, i, j));
+        }
+    }
 }
 
 void test_parse_instruction_WhereInstructionIsRET(void) {
@@ -566,11 +567,113 @@ void test_parse_instruction_WhereInstructionIsRNDXKK(void) {
     TEST_ASSERT_LESS_OR_EQUAL_UINT8(kk, c8.V[x]);
 }
 
+void test_parse_instruction_WhereInstructionIsDRW(void) {
+    if (b == 0) {
+        b++;
+    }
+    AXYB(0xD, x, y, b);
+    c8.display.mode = C8_DISPLAYMODE_LOW;
+    c8.V[x] = vx;
+    c8.V[y] = vy;
+
+    int ret = parse_instruction(&c8);
+    TEST_ASSERT_EQUAL_INT(2, ret);
+    TEST_ASSERT_EQUAL_UINT8(0, c8.V[0xF]);
+    TEST_ASSERT_EQUAL_INT(1, c8.draw);
+    for (int i = 0; i < b; i++) {
+        for (int j = 0; j < 8; j++) {
+            int px = (c8.V[x] + j) % C8_LOW_DISPLAY_WIDTH;
+            int py = (c8.V[y] + i) % C8_LOW_DISPLAY_HEIGHT;
+            int on = (c8.mem[c8.I + i] >> (7 - j)) & 1;
+            TEST_ASSERT_EQUAL_INT(on, c8_get_pixel(&c8.display, px, py));
+        }
+    }
+}
+
+void test_parse_instruction_WhereInstructionIsDRW_WherePixelsCollide(void) {
+    AXYB(0xD, x, y, 1);
+    c8.display.mode = C8_DISPLAYMODE_LOW;
+    c8.V[x] = vx;
+    c8.V[y] = vy;
+    c8.mem[c8.I] = 0x81;
+
+    TEST_ASSERT_EQUAL_INT(2, parse_instruction(&c8));
+    TEST_ASSERT_EQUAL_UINT8(0, c8.V[0xF]);
+    TEST_ASSERT_EQUAL_INT(1, c8_get_pixel(&c8.display, c8.V[x] % 64, c8.V[y] % 32));
+
+    TEST_ASSERT_EQUAL_INT(2, parse_instruction(&c8));
+    TEST_ASSERT_EQUAL_UINT8(1, c8.V[0xF]);
+    TEST_ASSERT_EQUAL_INT(0, c8_get_pixel(&c8.display, c8.V[x] % 64, c8.V[y] % 32));
+}
+
+void test_parse_instruction_WhereInstructionIsDRW_WhereSpriteWraps(void) {
+    AXYB(0xD, x, y, 2);
+    c8.display.mode = C8_DISPLAYMODE_LOW;
+    c8.V[x] = 60;
+    c8.V[y] = 31;
+    c8.mem[c8.I] = 0xFF;
+    c8.mem[c8.I + 1] = 0x81;
+
+    TEST_ASSERT_EQUAL_INT(2, parse_instruction(&c8));
+    TEST_ASSERT_EQUAL_HEX64(0xF00000000000000F, c8.display.p[31][0]);
+    TEST_ASSERT_EQUAL_HEX64(0x1000000000000008, c8.display.p[0][0]);
+    TEST_ASSERT_EQUAL_HEX64(0, c8.display.p[0][1]);
+
+    /* Reads wrap at the low resolution edges too */
+    TEST_ASSERT_EQUAL_INT(1, c8_get_pixel(&c8.display, 67, 32));
+    TEST_ASSERT_EQUAL_INT(1, c8_get_pixel(&c8.display, -4, -1));
+    TEST_ASSERT_EQUAL_INT(0, c8_get_pixel(&c8.display, 68, 32));
+}
+
+void test_parse_instruction_WhereInstructionIsDRW_WhereDrawQuirkClips(void) {
+    AXYB(0xD, x, y, 2);
+    c8.display.mode = C8_DISPLAYMODE_LOW;
+    c8.flags |= C8_FLAG_QUIRK_DRAW;
+    c8.V[x] = 60;
+    c8.V[y] = 31;
+    c8.mem[c8.I] = 0xFF;
+    c8.mem[c8.I + 1] = 0x81;
+
+    TEST_ASSERT_EQUAL_INT(2, parse_instruction(&c8));
+    TEST_ASSERT_EQUAL_HEX64(0x000000000000000F, c8.display.p[31][0]);
+    TEST_ASSERT_EQUAL_HEX64(0, c8.display.p[0][0]);
+}
+
+void test_parse_instruction_WhereInstructionIsDRW_WhereSpriteCrossesWords(void) {
+    AXYB(0xD, x, y, 1);
+    c8.display.mode = C8_DISPLAYMODE_HIGH;
+    c8.V[x] = 60;
+    c8.V[y] = 5;
+    c8.mem[c8.I] = 0xFF;
+    c8.display.p[5][1] = 0x2000000000000000;
+
+    TEST_ASSERT_EQUAL_INT(2, parse_instruction(&c8));
+    TEST_ASSERT_EQUAL_UINT8(1, c8.V[0xF]);
+    TEST_ASSERT_EQUAL_HEX64(0x000000000000000F, c8.display.p[5][0]);
+    TEST_ASSERT_EQUAL_HEX64(0xD000000000000000, c8.display.p[5][1]);
+}
+
+void test_parse_instruction_WhereInstructionIsDRW_WhereSpriteIs16x16(void) {
+    AXYB(0xD, x, y, 0);
+    c8.display.mode = C8_DISPLAYMODE_HIGH;
+    c8.V[x] = 120;
+    c8.V[y] = 0;
+
+    TEST_ASSERT_EQUAL_INT(2, parse_instruction(&c8));
+    TEST_ASSERT_EQUAL_UINT8(0, c8.V[0xF]);
+    for (int i = 0; i < 16; i++) {
+        for (int j = 0; j < 16; j++) {
+            int on = (c8.mem[c8.I + (i * 2) + (j / 8)] >> (7 - (j % 8))) & 1;
+            TEST_ASSERT_EQUAL_INT(on, c8_get_pixel(&c8.display, (120 + j) % 128, i));
+        }
+    }
+}
+
 void test_parse_instruction_WhereInstructionIsSKPV_WhereKeyIsPressed(void) {
     AXKK(0xE, x, 0x9E);
 
     c8.V[x] = y;
-    c8.key[y] = 1;
+    c8.keys = 1 << y;
 
     int ret = parse_instruction(&c8);
     TEST_ASSERT_EQUAL_INT(2, ret);
@@ -580,7 +683,7 @@ void test_parse_instruction_WhereInstructionIsSKPV_WhereKeyIsNotPressed(void) {
     AXKK(0xE, x, 0x9E);
 
     c8.V[x] = y;
-    c8.key[y] = 0;
+    c8.keys = 0;
 
     int ret = parse_instruction(&c8);
     TEST_ASSERT_EQUAL_INT(2, ret);
@@ -590,7 +693,7 @@ void test_parse_instruction_WhereInstructionIsSKNPV_WhereKeyIsPressed(void) {
     AXKK(0xE, x, 0xA1);
 
     c8.V[x] = y;
-    c8.key[y] = 1;
+    c8.keys = 1 << y;
 
     int ret = parse_instruction(&c8);
     TEST_ASSERT_EQUAL_INT(2, ret);
@@ -600,7 +703,7 @@ void test_parse_instruction_WhereInstructionIsSKNPV_WhereKeyIsNotPressed(void) {
     AXKK(0xE, x, 0xA1);
 
     c8.V[x] = y;
-    c8.key[y] = 0;
+    c8.keys = 0;
 
     int ret = parse_instruction(&c8);
     TEST_ASSERT_EQUAL_INT(2, ret);
@@ -619,7 +722,7 @@ void test_parse_instruction_WhereInstructionIsLDXDT(void) {
 void test_parse_instruction_WhereInstructionIsLDXK_WhereKeyIsPressed(void) {
     AXKK(0xF, x, 0x0A);
 
-    c8.key[y] = 1;
+    c8.keys = 1 << y;
 
     int ret = parse_instruction(&c8);
     TEST_ASSERT_EQUAL_INT(2, ret);
@@ -791,6 +894,25 @@ void test_parse_instruction_WhereInstructionIsLDXR_InSCHIPMode(void) {
     }
 }
 
+void test_parse_instruction_WhereInstructionIsOverwrittenByLDIPX(void) {
+    AXKK(0x6, x, kk);
+    parse_instruction(&c8);
+    TEST_ASSERT_EQUAL_UINT8(kk, c8.V[x]);
+
+    /* Overwrite LD Vx, kk with LD Vx, kk + 1 */
+    INSERT_INSTRUCTION(pc + 2, BUILD_INSTRUCTION_AXKK(0xF, 2, 0x55));
+    c8.I = pc;
+    c8.V[0] = 0x60 | x;
+    c8.V[1] = kk + 1;
+    c8.pc = pc + 2;
+    parse_instruction(&c8);
+
+    c8.pc = pc;
+    int ret = parse_instruction(&c8);
+    TEST_ASSERT_EQUAL_INT(2, ret);
+    TEST_ASSERT_EQUAL_UINT8((uint8_t)(kk + 1), c8.V[x]);
+}
+
 int main(void) {
     srand(time(NULL));
     UNITY_BEGIN();
@@ -838,6 +960,12 @@ int main(void) {
     RUN_TEST(test_parse_instruction_WhereInstructionIsLDINNN);
     RUN_TEST(test_parse_instruction_WhereInstructionIsJPV0NNN);
     RUN_TEST(test_parse_instruction_WhereInstructionIsRNDXKK);
+    RUN_TEST(test_parse_instruction_WhereInstructionIsDRW);
+    RUN_TEST(test_parse_instruction_WhereInstructionIsDRW_WherePixelsCollide);
+    RUN_TEST(test_parse_instruction_WhereInstructionIsDRW_WhereSpriteWraps);
+    RUN_TEST(test_parse_instruction_WhereInstructionIsDRW_WhereDrawQuirkClips);
+    RUN_TEST(test_parse_instruction_WhereInstructionIsDRW_WhereSpriteCrossesWords);
+    RUN_TEST(test_parse_instruction_WhereInstructionIsDRW_WhereSpriteIs16x16);
     RUN_TEST(test_parse_instruction_WhereInstructionIsSKPV_WhereKeyIsPressed);
     RUN_TEST(test_parse_instruction_WhereInstructionIsSKPV_WhereKeyIsNotPressed);
     RUN_TEST(test_parse_instruction_WhereInstructionIsSKNPV_WhereKeyIsPressed);
@@ -856,5 +984,6 @@ int main(void) {
     RUN_TEST(test_parse_instruction_WhereInstructionIsLDXIP);
     RUN_TEST(test_parse_instruction_WhereInstructionIsLDRX_InCHIP8Mode);
     RUN_TEST(test_parse_instruction_WhereInstructionIsLDXR_InSCHIPMode);
+    RUN_TEST(test_parse_instruction_WhereInstructionIsOverwrittenByLDIPX);
     return UNITY_END();
 }
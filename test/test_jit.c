@@ -0,0 +1,193 @@
+#include "unity.h"
+#include "c8/private/jit.c"
+#include "c8/private/exception.h"
+#include "c8/chip8.h"
+#include "c8/defs.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define INSERT_INSTRUCTION(c, addr, in) \
+    (c).mem[addr] = (((in) >> 8) & 0xFF); \
+    (c).mem[(addr)+1] = ((in) & 0xFF);
+
+c8_t c8;
+c8_t ref;
+
+/* instructions translated to native code, by opcode template */
+const uint16_t native[] = {
+    0x6000, 0x7000, 0x8000, 0x8001, 0x8002, 0x8003, 0x8004, 0x8005,
+    0x8006, 0x8007, 0x800E, 0xA000, 0xF01E, 0xF007, 0xF015, 0xF018,
+    0xF029, 0x3000, 0x4000, 0x5000, 0x9000,
+};
+
+void setUp(void) {
+    memset(&c8, 0, sizeof(c8_t));
+    c8.pc = 0x200;
+    c8.running = 1;
+}
+
+void tearDown(void) {
+    jit_free(&c8);
+}
+
+static uint16_t random_native_instruction(void) {
+    uint16_t in = native[rand() % (sizeof(native) / sizeof(native[0]))];
+    uint16_t x = (rand() & 0xF) << 8;
+
+    switch (in & 0xF000) {
+    case 0x6000: case 0x7000: case 0x3000: case 0x4000:
+        return in | x | (rand() & 0xFF);
+    case 0xA000:
+        return in | (rand() & 0xFFF);
+    case 0xF000:
+        return in | x;
+    default:
+        return in | x | ((rand() & 0xF) << 4);
+    }
+}
+
+void test_jit_execute_WhereNativeInstructionsMatchInterpreter(void) {
+    for (int run = 0; run < 500; run++) {
+        setUp();
+        c8.flags = (rand() & 1 ? C8_FLAG_QUIRK_BITWISE : 0) |
+            (rand() & 1 ? C8_FLAG_QUIRK_SHIFT : 0);
+        for (int i = 0; i < 16; i++) {
+            c8.V[i] = rand() & 0xFF;
+        }
+        c8.I = rand() & 0xFFF;
+        c8.dt = rand() & 0xFF;
+        c8.st = rand() & 0xFF;
+
+        for (int i = 0; i < 32; i++) {
+            uint16_t in = random_native_instruction();
+            INSERT_INSTRUCTION(c8, 0x200 + (i * 2), in);
+        }
+        for (int i = 0x240; i < 0x280; i += 2) {
+            INSERT_INSTRUCTION(c8, i, 0x1000 | i);
+        }
+
+        memcpy(&ref, &c8, sizeof(c8_t));
+        TEST_ASSERT_EQUAL_INT(40, interpret(&ref, 40));
+        TEST_ASSERT_EQUAL_INT(40, jit_execute(&c8, 40));
+
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(ref.V, c8.V, 16);
+        TEST_ASSERT_EQUAL_UINT16(ref.I, c8.I);
+        TEST_ASSERT_EQUAL_UINT16(ref.pc, c8.pc);
+        TEST_ASSERT_EQUAL_UINT8(ref.dt, c8.dt);
+        TEST_ASSERT_EQUAL_UINT8(ref.st, c8.st);
+        tearDown();
+    }
+}
+
+void test_jit_execute_WhereBlocksAreChained(void) {
+    c8.mode = C8_MODE_SCHIP;
+    INSERT_INSTRUCTION(c8, 0x200, 0x6000); // LD V0, 0
+    INSERT_INSTRUCTION(c8, 0x202, 0x7001); // ADD V0, 1
+    INSERT_INSTRUCTION(c8, 0x204, 0x3005); // SE V0, 5
+    INSERT_INSTRUCTION(c8, 0x206, 0x1202); // JP 0x202
+    INSERT_INSTRUCTION(c8, 0x208, 0x00FD); // EXIT
+
+    TEST_ASSERT_EQUAL_INT(16, jit_execute(&c8, 1000));
+    TEST_ASSERT_EQUAL_UINT8(5, c8.V[0]);
+    TEST_ASSERT_EQUAL_UINT16(0x208, c8.pc);
+    TEST_ASSERT_EQUAL_INT(0, c8.running);
+}
+
+void test_jit_execute_WhereBudgetEndsInsideBlock(void) {
+    for (int i = 0; i < 10; i++) {
+        INSERT_INSTRUCTION(c8, 0x200 + (i * 2), 0x6000 | (i << 8) | i);
+    }
+    INSERT_INSTRUCTION(c8, 0x214, 0x1200); // JP 0x200
+
+    TEST_ASSERT_EQUAL_INT(11, jit_execute(&c8, 11));
+    TEST_ASSERT_EQUAL_UINT16(0x200, c8.pc);
+
+    memset(c8.V, 0, sizeof(c8.V));
+    TEST_ASSERT_EQUAL_INT(3, jit_execute(&c8, 3));
+    TEST_ASSERT_EQUAL_UINT16(0x206, c8.pc);
+    TEST_ASSERT_EQUAL_UINT8(2, c8.V[2]);
+    TEST_ASSERT_EQUAL_UINT8(0, c8.V[3]);
+}
+
+void test_jit_execute_WhereCodeIsOverwritten(void) {
+    c8.mode = C8_MODE_SCHIP;
+    INSERT_INSTRUCTION(c8, 0x200, 0x6305); // LD V3, 5 (rewritten to LD V3, 7)
+    INSERT_INSTRUCTION(c8, 0x202, 0x3E01); // SE VE, 1
+    INSERT_INSTRUCTION(c8, 0x204, 0x120A); // JP 0x20A
+    INSERT_INSTRUCTION(c8, 0x206, 0x00FD); // EXIT
+    INSERT_INSTRUCTION(c8, 0x20A, 0xA200); // LD I, 0x200
+    INSERT_INSTRUCTION(c8, 0x20C, 0x6063); // LD V0, 0x63
+    INSERT_INSTRUCTION(c8, 0x20E, 0x6107); // LD V1, 0x07
+    INSERT_INSTRUCTION(c8, 0x210, 0x623E); // LD V2, 0x3E
+    INSERT_INSTRUCTION(c8, 0x212, 0x6E01); // LD VE, 1
+    INSERT_INSTRUCTION(c8, 0x214, 0xF255); // LD [I], V2
+    INSERT_INSTRUCTION(c8, 0x216, 0x1200); // JP 0x200
+
+    TEST_ASSERT_GREATER_THAN(0, jit_execute(&c8, 1000));
+    TEST_ASSERT_EQUAL_UINT8(7, c8.V[3]);
+    TEST_ASSERT_EQUAL_UINT16(0x206, c8.pc);
+    TEST_ASSERT_EQUAL_INT(0, c8.running);
+}
+
+void test_jit_execute_WhereSubroutineIsCalled(void) {
+    c8.mode = C8_MODE_SCHIP;
+    INSERT_INSTRUCTION(c8, 0x200, 0x2206); // CALL 0x206
+    INSERT_INSTRUCTION(c8, 0x202, 0x6107); // LD V1, 7
+    INSERT_INSTRUCTION(c8, 0x204, 0x00FD); // EXIT
+    INSERT_INSTRUCTION(c8, 0x206, 0x6005); // LD V0, 5
+    INSERT_INSTRUCTION(c8, 0x208, 0x00EE); // RET
+
+    TEST_ASSERT_EQUAL_INT(5, jit_execute(&c8, 1000));
+    TEST_ASSERT_EQUAL_UINT8(5, c8.V[0]);
+    TEST_ASSERT_EQUAL_UINT8(7, c8.V[1]);
+    TEST_ASSERT_EQUAL_UINT8(0, c8.sp);
+    TEST_ASSERT_EQUAL_UINT16(0x204, c8.pc);
+}
+
+void test_jit_execute_WhereInstructionIsInvalid(void) {
+    INSERT_INSTRUCTION(c8, 0x200, 0x6005); // LD V0, 5
+    INSERT_INSTRUCTION(c8, 0x202, 0x0000); // invalid
+
+    TEST_ASSERT_EQUAL_INT(INVALID_INSTRUCTION_EXCEPTION, jit_execute(&c8, 1000));
+    TEST_ASSERT_EQUAL_UINT8(5, c8.V[0]);
+    TEST_ASSERT_EQUAL_UINT16(0x202, c8.pc);
+}
+
+void test_jit_execute_WhereWaitingForKey(void) {
+    INSERT_INSTRUCTION(c8, 0x200, 0x6005); // LD V0, 5
+    INSERT_INSTRUCTION(c8, 0x202, 0xF30A); // LD V3, K
+
+    TEST_ASSERT_EQUAL_INT(2, jit_execute(&c8, 1000));
+    TEST_ASSERT_EQUAL_INT(1, c8.waitingForKey);
+    TEST_ASSERT_EQUAL_INT(3, c8.VK);
+    TEST_ASSERT_EQUAL_UINT16(0x202, c8.pc);
+}
+
+void test_jit_execute_WhereQuirksChange(void) {
+    INSERT_INSTRUCTION(c8, 0x200, 0x8016); // SHR V0, V1
+    c8.V[0] = 0x10;
+    c8.V[1] = 0x40;
+
+    TEST_ASSERT_EQUAL_INT(1, jit_execute(&c8, 1));
+    TEST_ASSERT_EQUAL_UINT8(0x20, c8.V[0]);
+
+    c8.pc = 0x200;
+    c8.flags |= C8_FLAG_QUIRK_SHIFT;
+    TEST_ASSERT_EQUAL_INT(1, jit_execute(&c8, 1));
+    TEST_ASSERT_EQUAL_UINT8(0x10, c8.V[0]);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_jit_execute_WhereNativeInstructionsMatchInterpreter);
+    RUN_TEST(test_jit_execute_WhereBlocksAreChained);
+    RUN_TEST(test_jit_execute_WhereBudgetEndsInsideBlock);
+    RUN_TEST(test_jit_execute_WhereCodeIsOverwritten);
+    RUN_TEST(test_jit_execute_WhereSubroutineIsCalled);
+    RUN_TEST(test_jit_execute_WhereInstructionIsInvalid);
+    RUN_TEST(test_jit_execute_WhereWaitingForKey);
+    RUN_TEST(test_jit_execute_WhereQuirksChange);
+    return UNITY_END();
+}
@@ -0,0 +1,106 @@
+#include "unity.h"
+
+#include "c8/private/lexer.c"
+
+#include <string.h>
+
+lexer_t lexer;
+token_t token;
+
+void setUp(void) {
+    memset(&lexer, 0, sizeof(lexer));
+    memset(&token, 0, sizeof(token));
+}
+
+void tearDown(void) {
+}
+
+static void assert_token(Token kind, const char* s, const char* expected) {
+    TEST_ASSERT_EQUAL_INT(kind, next_token(&lexer, &token));
+    TEST_ASSERT_EQUAL_INT(strlen(expected), token.len);
+    TEST_ASSERT_EQUAL_MEMORY(expected, s + token.offset, token.len);
+}
+
+void test_next_token_WhereSourceIsEmpty(void) {
+    lexer_init(&lexer, "", 0);
+
+    TEST_ASSERT_EQUAL_INT(TOKEN_END, next_token(&lexer, &token));
+    TEST_ASSERT_EQUAL_INT(TOKEN_END, next_token(&lexer, &token));
+}
+
+void test_next_token_WhereWordsAreSeparatedByBlanksAndCommas(void) {
+    const char* s = "\tld v1,v2 ,  $3";
+    lexer_init(&lexer, s, strlen(s));
+
+    assert_token(TOKEN_WORD, s, "ld");
+    assert_token(TOKEN_WORD, s, "v1");
+    assert_token(TOKEN_WORD, s, "v2");
+    assert_token(TOKEN_WORD, s, "$3");
+    TEST_ASSERT_EQUAL_INT(TOKEN_END, next_token(&lexer, &token));
+}
+
+void test_next_token_WhereWordIsLabelDefinition(void) {
+    const char* s = "loop: JP loop";
+    lexer_init(&lexer, s, strlen(s));
+
+    assert_token(TOKEN_LABEL_DEFINITION, s, "loop");
+    assert_token(TOKEN_WORD, s, "JP");
+    assert_token(TOKEN_WORD, s, "loop");
+}
+
+void test_next_token_WhereLineHasComment(void) {
+    const char* s = "CLS ; clear;screen\n; only a comment\nRET;not a comment";
+    lexer_init(&lexer, s, strlen(s));
+
+    assert_token(TOKEN_WORD, s, "CLS");
+    TEST_ASSERT_EQUAL_INT(TOKEN_NEWLINE, next_token(&lexer, &token));
+    TEST_ASSERT_EQUAL_INT(TOKEN_NEWLINE, next_token(&lexer, &token));
+    assert_token(TOKEN_WORD, s, "RET;not");
+    assert_token(TOKEN_WORD, s, "a");
+}
+
+void test_next_token_WhereSourceHasMultipleLines(void) {
+    const char* s = "CLS\r\n\nRET";
+    lexer_init(&lexer, s, strlen(s));
+
+    assert_token(TOKEN_WORD, s, "CLS");
+    TEST_ASSERT_EQUAL_INT(1, lexer.ln);
+    TEST_ASSERT_EQUAL_INT(TOKEN_NEWLINE, next_token(&lexer, &token));
+    TEST_ASSERT_EQUAL_INT(1, lexer.ln);
+    TEST_ASSERT_EQUAL_INT(TOKEN_NEWLINE, next_token(&lexer, &token));
+    TEST_ASSERT_EQUAL_INT(2, lexer.ln);
+    assert_token(TOKEN_WORD, s, "RET");
+    TEST_ASSERT_EQUAL_INT(3, lexer.ln);
+    TEST_ASSERT_EQUAL_INT(6, lexer.line);
+}
+
+void test_next_token_WhereSourceIsNotNullTerminated(void) {
+    const char* s = "JP START";
+    lexer_init(&lexer, s, 5);
+
+    assert_token(TOKEN_WORD, s, "JP");
+    assert_token(TOKEN_WORD, s, "ST");
+    TEST_ASSERT_EQUAL_INT(TOKEN_END, next_token(&lexer, &token));
+}
+
+void test_line_length_WhereLineHasLineEnding(void) {
+    const char* s = "LD V1, 2\r\nCLS";
+
+    TEST_ASSERT_EQUAL_INT(8, line_length(s, s + strlen(s)));
+    TEST_ASSERT_EQUAL_INT(3, line_length(s + 10, s + strlen(s)));
+    TEST_ASSERT_EQUAL_INT(0, line_length(NULL, s));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_next_token_WhereSourceIsEmpty);
+    RUN_TEST(test_next_token_WhereWordsAreSeparatedByBlanksAndCommas);
+    RUN_TEST(test_next_token_WhereWordIsLabelDefinition);
+    RUN_TEST(test_next_token_WhereLineHasComment);
+    RUN_TEST(test_next_token_WhereSourceHasMultipleLines);
+    RUN_TEST(test_next_token_WhereSourceIsNotNullTerminated);
+    RUN_TEST(test_line_length_WhereLineHasLineEnding);
+
+    return UNITY_END();
+}
@@ -0,0 +1,133 @@
+#include "unity.h"
+#include "c8/private/profile.c"
+#include "c8/chip8.h"
+#include "test_rom.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PROFILE_PATH "test_profile.out"
+
+/* Calls a subroutine that calls another, so calls are nested */
+static const uint16_t rom[] = {
+    0x2208, /* 200: CALL 0x208 */
+    0x7001, /* 202: ADD V0, 1 */
+    0x1200, /* 204: JP 0x200 */
+    0x0000,
+    0x220E, /* 208: CALL 0x20E */
+    0x7101, /* 20A: ADD V1, 1 */
+    0x00EE, /* 20C: RET */
+    0x7201, /* 20E: ADD V2, 1 */
+    0x00EE, /* 210: RET */
+};
+
+c8_t* c8;
+
+void setUp(void) {
+    c8 = ROM_INIT(rom, C8_MODE_CHIP8, 0);
+}
+
+void tearDown(void) {
+    c8_deinit(c8);
+    remove(PROFILE_PATH);
+}
+
+void test_profile_instruction_WhereSubroutinesAreCalled(void) {
+    struct c8_profile* p;
+
+    TEST_ASSERT_EQUAL_INT(1, c8_set_profile(c8, PROFILE_PATH));
+    p = c8->cold->profile;
+
+    /* Each iteration of the main loop is 8 instructions */
+    c8_run(c8, 80);
+
+    TEST_ASSERT_EQUAL_UINT64(80, p->total);
+    TEST_ASSERT_EQUAL_UINT64(20, p->ops[OP_CALL_NNN]);
+    TEST_ASSERT_EQUAL_UINT64(20, p->ops[OP_RET]);
+    TEST_ASSERT_EQUAL_UINT64(30, p->ops[OP_ADD_VX_KK]);
+    TEST_ASSERT_EQUAL_UINT64(10, p->pcs[0x20E]);
+    TEST_ASSERT_EQUAL_UINT64(10, p->calls[0x208]);
+    TEST_ASSERT_EQUAL_UINT64(10, p->calls[0x20E]);
+    TEST_ASSERT_EQUAL_INT(0, p->depth);
+
+    /* CALL, ADD, RET in 0x208 plus ADD, RET in 0x20E */
+    TEST_ASSERT_EQUAL_UINT64(50, p->inclusive[0x208]);
+    TEST_ASSERT_EQUAL_UINT64(20, p->inclusive[0x20E]);
+    TEST_ASSERT_EQUAL_UINT16(0x208, p->fn[0x20A]);
+    TEST_ASSERT_EQUAL_UINT16(0x200, p->fn[0x202]);
+}
+
+void test_profile_close_WhereCallgrindIsWritten(void) {
+    char buf[4096];
+    FILE* f;
+    size_t n;
+
+    c8_set_profile(c8, PROFILE_PATH);
+    c8_run(c8, 12);
+    TEST_ASSERT_EQUAL_INT(1, c8_set_profile(c8, NULL));
+    TEST_ASSERT_NULL(c8->cold->profile);
+    TEST_ASSERT_EQUAL_INT(0, c8->flags & C8_FLAG_PROFILE);
+
+    f = fopen(PROFILE_PATH, "r");
+    TEST_ASSERT_NOT_NULL(f);
+    n = fread(buf, 1, sizeof(buf) - 1, f);
+    buf[n] = '\0';
+    fclose(f);
+
+    TEST_ASSERT_NOT_NULL(strstr(buf, "events: Instructions\n"));
+    TEST_ASSERT_NOT_NULL(strstr(buf, "summary: 12\n"));
+    TEST_ASSERT_NOT_NULL(strstr(buf, "fn=sub_200\n0x200 2\n"));
+    /* The call in progress is not counted as a returned call */
+    TEST_ASSERT_NOT_NULL(strstr(buf, "cfn=sub_208\ncalls=1 0x208\n0x200 5\n"));
+
+    TEST_ASSERT_NOT_NULL(strstr(buf, "cfn=sub_20E\ncalls=2 0x20E\n0x208 4\n"));
+}
+
+void test_profile_close_WhereExceptionExits(void) {
+    /* CALL 0x204; JP 0x200; HIGH (invalid in CHIP-8 mode) */
+    const uint16_t badRom[] = { 0x2204, 0x1200, 0x00FF };
+    char buf[4096];
+    FILE* f;
+    size_t n;
+
+    c8_deinit(c8);
+    c8 = ROM_INIT(badRom, C8_MODE_CHIP8, 0);
+    c8_set_profile(c8, PROFILE_PATH);
+    c8_run(c8, 10);
+
+    /* TEST builds do not exit, but the profile is written as if they did */
+    TEST_ASSERT_NULL(c8->cold->profile);
+    TEST_ASSERT_EQUAL_INT(0, c8->flags & C8_FLAG_PROFILE);
+
+    f = fopen(PROFILE_PATH, "r");
+    TEST_ASSERT_NOT_NULL(f);
+    n = fread(buf, 1, sizeof(buf) - 1, f);
+    buf[n] = '\0';
+    fclose(f);
+
+    TEST_ASSERT_NOT_NULL(strstr(buf, "summary: 2\n"));
+    TEST_ASSERT_NOT_NULL(strstr(buf, "fn=sub_204\n0x204 1\n"));
+    TEST_ASSERT_NULL(strstr(buf, "cfn="));
+}
+
+void test_top_WhereCountsAreSorted(void) {
+    const uint64_t counts[] = { 0, 5, 1, 9, 5, 0, 7 };
+    int idx[3];
+
+    TEST_ASSERT_EQUAL_INT(3, top(counts, 7, idx, 3));
+    TEST_ASSERT_EQUAL_INT(3, idx[0]);
+    TEST_ASSERT_EQUAL_INT(6, idx[1]);
+    TEST_ASSERT_EQUAL_INT(1, idx[2]);
+    TEST_ASSERT_EQUAL_INT(2, top(counts, 3, idx, 3));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_profile_instruction_WhereSubroutinesAreCalled);
+    RUN_TEST(test_profile_close_WhereCallgrindIsWritten);
+    RUN_TEST(test_profile_close_WhereExceptionExits);
+    RUN_TEST(test_top_WhereCountsAreSorted);
+    return UNITY_END();
+}
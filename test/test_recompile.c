@@ -0,0 +1,94 @@
+#include "unity.h"
+#include "c8/recompile.c"
+#include "c8/private/exception.h"
+#include "c8/chip8.h"
+#include "c8/defs.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#define INSERT_INSTRUCTION(addr, in) \
+    c8.mem[addr] = (((in) >> 8) & 0xFF); \
+    c8.mem[(addr)+1] = ((in) & 0xFF);
+
+c8_t c8;
+
+/* LD V0, 5; JP 0x200 */
+const uint8_t rom[] = { 0x60, 0x05, 0x12, 0x00 };
+int blockRuns = 0;
+
+static int recompiled(c8_t* c) {
+    if (c->pc != 0x200 || !c8_rc_valid(c, rom, 0x200, 0x204)) {
+        return 0;
+    }
+    blockRuns++;
+    c->V[0x0] = 0x05;
+    c->pc = 0x200;
+    return 2;
+}
+
+void setUp(void) {
+    memset(&c8, 0, sizeof(c8_t));
+    memcpy(c8.mem + C8_PROG_START, rom, sizeof(rom));
+    c8.pc = 0x200;
+    c8.running = 1;
+    blockRuns = 0;
+}
+
+void tearDown(void) {}
+
+void test_c8_rc_exec_WhereInstructionIsValid(void) {
+    INSERT_INSTRUCTION(0x300, 0x6A42); // LD VA, 0x42
+
+    TEST_ASSERT_EQUAL_INT(2, c8_rc_exec(&c8, 0x300));
+    TEST_ASSERT_EQUAL_UINT8(0x42, c8.V[0xA]);
+    TEST_ASSERT_EQUAL_UINT16(0x302, c8.pc);
+}
+
+void test_c8_rc_exec_WhereInstructionIsInvalid(void) {
+    TEST_ASSERT_EQUAL_INT(INVALID_INSTRUCTION_EXCEPTION, c8_rc_exec(&c8, 0x300));
+    TEST_ASSERT_EQUAL_UINT16(0x300, c8.pc);
+}
+
+void test_c8_rc_valid_WhereCodeIsModified(void) {
+    TEST_ASSERT_TRUE(c8_rc_valid(&c8, rom, 0x200, 0x204));
+    c8.mem[0x203] = 0x02;
+    TEST_ASSERT_FALSE(c8_rc_valid(&c8, rom, 0x200, 0x204));
+    TEST_ASSERT_TRUE(c8_rc_valid(&c8, rom, 0x200, 0x202));
+}
+
+void test_c8_rc_execute_WhereBlockIsRecompiled(void) {
+    c8.recompiled = recompiled;
+
+    TEST_ASSERT_EQUAL_INT(10, c8_rc_execute(&c8, 10));
+    TEST_ASSERT_EQUAL_INT(5, blockRuns);
+    TEST_ASSERT_EQUAL_UINT8(0x05, c8.V[0x0]);
+}
+
+void test_c8_rc_execute_WhereCodeIsModified(void) {
+    c8.recompiled = recompiled;
+    INSERT_INSTRUCTION(0x200, 0x6007); // LD V0, 7
+
+    TEST_ASSERT_EQUAL_INT(10, c8_rc_execute(&c8, 10));
+    TEST_ASSERT_EQUAL_INT(0, blockRuns);
+    TEST_ASSERT_EQUAL_UINT8(0x07, c8.V[0x0]);
+}
+
+void test_c8_rc_execute_WhereWaitingForKey(void) {
+    INSERT_INSTRUCTION(0x200, 0xF30A); // LD V3, K
+
+    TEST_ASSERT_EQUAL_INT(1, c8_rc_execute(&c8, 10));
+    TEST_ASSERT_EQUAL_INT(1, c8.waitingForKey);
+    TEST_ASSERT_EQUAL_UINT16(0x200, c8.pc);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_c8_rc_exec_WhereInstructionIsValid);
+    RUN_TEST(test_c8_rc_exec_WhereInstructionIsInvalid);
+    RUN_TEST(test_c8_rc_valid_WhereCodeIsModified);
+    RUN_TEST(test_c8_rc_execute_WhereBlockIsRecompiled);
+    RUN_TEST(test_c8_rc_execute_WhereCodeIsModified);
+    RUN_TEST(test_c8_rc_execute_WhereWaitingForKey);
+    return UNITY_END();
+}
@@ -0,0 +1,152 @@
+#include "unity.h"
+#include "c8/private/rewind.c"
+#include "c8/chip8.h"
+#include "test_rom.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Counts frames in V0 and in memory, so each snapshot differs a little */
+static const uint16_t rom[] = {
+    0xA300, /* 200: LD I, 0x300 */
+    0x7001, /* 202: ADD V0, 1 */
+    0xF155, /* 204: LD [I], V1 */
+    0x1202, /* 206: JP 0x202 */
+};
+
+c8_t* c8;
+
+static c8_t* init(int flags) {
+    c8_t* c = ROM_INIT(rom, C8_MODE_CHIP8, flags);
+
+    /* One loop iteration, so one increment of V0, per frame */
+    c->cs = 3 * C8_FRAME_RATE;
+    return c;
+}
+
+void setUp(void) {
+    c8 = init(0);
+}
+
+void tearDown(void) {
+    c8_deinit(c8);
+}
+
+void test_c8_rewind_WhereRewindIsDisabled(void) {
+    TEST_ASSERT_EQUAL_INT(C8_STOP_BUDGET, c8_run_frames(c8, 10));
+    TEST_ASSERT_EQUAL_INT(0, c8_rewind(c8, 1));
+}
+
+void test_c8_rewind_WhereSnapshotsExist(void) {
+    TEST_ASSERT_EQUAL_INT(1, c8_set_rewind(c8, 1 << 20, 1));
+    TEST_ASSERT_EQUAL_INT(C8_STOP_BUDGET, c8_run_frames(c8, 10));
+    TEST_ASSERT_EQUAL_UINT8(10, c8->V[0]);
+
+    TEST_ASSERT_EQUAL_INT(3, c8_rewind(c8, 3));
+    TEST_ASSERT_EQUAL_UINT8(7, c8->V[0]);
+    TEST_ASSERT_EQUAL_UINT8(7, c8->mem[0x300]);
+
+    TEST_ASSERT_EQUAL_INT(1, c8_rewind(c8, 1));
+    TEST_ASSERT_EQUAL_UINT8(6, c8->V[0]);
+
+    TEST_ASSERT_EQUAL_INT(5, c8_rewind(c8, 100));
+    TEST_ASSERT_EQUAL_UINT8(1, c8->V[0]);
+    TEST_ASSERT_EQUAL_INT(0, c8_rewind(c8, 1));
+}
+
+void test_c8_rewind_WhereExecutionResumes(void) {
+    c8_t* ref = init(0);
+
+    TEST_ASSERT_EQUAL_INT(C8_STOP_BUDGET, c8_run_frames(ref, 100));
+
+    /* Snapshots cross several keyframes */
+    c8_set_rewind(c8, 1 << 20, 1);
+    TEST_ASSERT_EQUAL_INT(C8_STOP_BUDGET, c8_run_frames(c8, 90));
+    TEST_ASSERT_EQUAL_INT(40, c8_rewind(c8, 40));
+    TEST_ASSERT_EQUAL_INT(C8_STOP_BUDGET, c8_run_frames(c8, 50));
+
+    TEST_ASSERT_EQUAL_UINT64(ref->cycles, c8->cycles);
+    TEST_ASSERT_EQUAL_UINT16(ref->pc, c8->pc);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(ref->V, c8->V, 16);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(ref->mem, c8->mem, C8_MEMSIZE);
+    c8_deinit(ref);
+}
+
+void test_c8_rewind_WhereJITIsEnabled(void) {
+    c8_deinit(c8);
+    c8 = init(C8_FLAG_JIT);
+
+    c8_set_rewind(c8, 1 << 20, 1);
+    TEST_ASSERT_EQUAL_INT(C8_STOP_BUDGET, c8_run_frames(c8, 20));
+    TEST_ASSERT_EQUAL_INT(5, c8_rewind(c8, 5));
+    TEST_ASSERT_EQUAL_UINT8(15, c8->V[0]);
+    TEST_ASSERT_EQUAL_INT(C8_STOP_BUDGET, c8_run_frames(c8, 5));
+    TEST_ASSERT_EQUAL_UINT8(20, c8->V[0]);
+    TEST_ASSERT_EQUAL_UINT8(20, c8->mem[0x300]);
+}
+
+void test_c8_set_rewind_WhereKeyframesAreTaken(void) {
+    struct c8_rewind* rw;
+
+    c8_set_rewind(c8, 1 << 20, 1);
+    rw = c8->cold->rewind;
+    c8_run_frames(c8, 2 * REWIND_KEYFRAME_INTERVAL);
+
+    TEST_ASSERT_EQUAL_INT(2 * REWIND_KEYFRAME_INTERVAL, rw->count);
+    for (int i = 0; i < rw->count; i++) {
+        TEST_ASSERT_EQUAL_INT(i % REWIND_KEYFRAME_INTERVAL == 0, RING(rw, i).keyframe);
+    }
+}
+
+void test_c8_set_rewind_WhereBudgetIsSmall(void) {
+    size_t budget = 4 * SNAPSHOT_SIZE;
+
+    c8_set_rewind(c8, budget, 1);
+    TEST_ASSERT_EQUAL_INT(C8_STOP_BUDGET, c8_run_frames(c8, 1000));
+    TEST_ASSERT_LESS_OR_EQUAL_UINT64(budget, c8->cold->rewind->used);
+    TEST_ASSERT_TRUE(RING(c8->cold->rewind, 0).keyframe);
+
+    int n = c8_rewind(c8, 1000);
+    TEST_ASSERT_GREATER_THAN(REWIND_KEYFRAME_INTERVAL, n);
+    TEST_ASSERT_EQUAL_UINT8((1000 - n) & 0xFF, c8->V[0]);
+}
+
+void test_encode_WhereStateIsUnchanged(void) {
+    uint8_t* state = (uint8_t*)c8;
+    uint8_t out[DELTA_MAX];
+
+    TEST_ASSERT_EQUAL_size_t(0, encode(state, state, out));
+}
+
+void test_encode_WhereStateChanges(void) {
+    static uint8_t key[SNAPSHOT_SIZE];
+    static uint8_t cur[SNAPSHOT_SIZE];
+    uint8_t out[DELTA_MAX];
+    size_t size;
+
+    for (size_t i = 0; i < SNAPSHOT_SIZE; i++) {
+        key[i] = cur[i] = rand();
+    }
+    cur[0] ^= 0xFF;
+    cur[2] ^= 0x01;
+    cur[SNAPSHOT_SIZE - 1] ^= 0x80;
+
+    size = encode(key, cur, out);
+    TEST_ASSERT_EQUAL_size_t(4 + 3 + 4 + 1, size);
+    decode(out, size, key);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(cur, key, SNAPSHOT_SIZE);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_c8_rewind_WhereRewindIsDisabled);
+    RUN_TEST(test_c8_rewind_WhereSnapshotsExist);
+    RUN_TEST(test_c8_rewind_WhereExecutionResumes);
+    RUN_TEST(test_c8_rewind_WhereJITIsEnabled);
+    RUN_TEST(test_c8_set_rewind_WhereKeyframesAreTaken);
+    RUN_TEST(test_c8_set_rewind_WhereBudgetIsSmall);
+    RUN_TEST(test_encode_WhereStateIsUnchanged);
+    RUN_TEST(test_encode_WhereStateChanges);
+    return UNITY_END();
+}
@@ -0,0 +1,58 @@
+/**
+ * @file test/test_rom.h
+ *
+ * Fixture shared by the tests that run a small ROM on a `c8_t`.
+ *
+ * ROMs are written as arrays of instructions instead of bytes, so the
+ * listing can be read next to the addresses:
+ *
+ *     static const uint16_t rom[] = {
+ *         0x6005, // 200: LD V0, 5
+ *         0x1200, // 202: JP 0x200
+ *     };
+ *
+ *     c8 = ROM_INIT(rom, C8_MODE_CHIP8, 0);
+ */
+
+#ifndef TEST_ROM_H
+#define TEST_ROM_H
+
+#include "c8/chip8.h"
+#include "c8/defs.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Initialize a `c8_t` running the instruction array `rom` */
+#define ROM_INIT(rom, mode, flags) \
+    rom_init((rom), sizeof(rom) / sizeof((rom)[0]), (mode), (flags))
+
+/**
+ * @brief Initialize a `c8_t` running a ROM given as instructions
+ *
+ * @param rom instructions, loaded at `C8_PROG_START`
+ * @param count number of instructions
+ * @param mode interpreter mode (C8_MODE_CHIP8, C8_MODE_SCHIP, C8_MODE_XOCHIP)
+ * @param flags flags passed to `c8_init_mem`
+ *
+ * @return the `c8_t`, to be freed with `c8_deinit`
+ */
+static inline c8_t* rom_init(const uint16_t* rom, size_t count, int mode, int flags) {
+    uint8_t bytes[C8_MEMSIZE - C8_PROG_START];
+
+    if (count > sizeof(bytes) / 2) {
+        count = sizeof(bytes) / 2;
+    }
+    for (size_t i = 0; i < count; i++) {
+        bytes[i * 2] = rom[i] >> 8;
+        bytes[i * 2 + 1] = rom[i] & 0xFF;
+    }
+
+    c8_t* c8 = c8_init_mem(bytes, count * 2, flags);
+    if (c8) {
+        c8->mode = mode;
+    }
+    return c8;
+}
+
+#endif
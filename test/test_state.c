@@ -0,0 +1,172 @@
+#include "unity.h"
+#include "c8/state.c"
+#include "c8/chip8.h"
+#include "test_rom.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Leaves a hires display scrolled right and a call in progress */
+static const uint16_t rom[] = {
+    0x00FF, /* 200: HIGH */
+    0xA300, /* 202: LD I, 0x300 */
+    0x2208, /* 204: CALL 0x208 */
+    0x1206, /* 206: JP 0x206 */
+    0x00FB, /* 208: SCR */
+    0x7001, /* 20A: ADD V0, 1 */
+    0xF155, /* 20C: LD [I], V1 */
+    0x120A, /* 20E: JP 0x20A */
+};
+
+uint8_t buf[C8_STATE_MAX_SIZE];
+c8_t* c8;
+
+void setUp(void) {
+    c8 = ROM_INIT(rom, C8_MODE_SCHIP, 0);
+    c8->cs = 4 * C8_FRAME_RATE;
+    c8_run_frames(c8, 10);
+    c8->display.p[5][0] = 0xF0F0;
+}
+
+void tearDown(void) {
+    c8_deinit(c8);
+}
+
+static void assert_state_equal(c8_t* expected, c8_t* actual) {
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected->V, actual->V, 16);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected->R, actual->R, 8);
+    TEST_ASSERT_EQUAL_UINT16_ARRAY(expected->stack, actual->stack, C8_STACK_SIZE);
+    TEST_ASSERT_EQUAL_UINT16(expected->pc, actual->pc);
+    TEST_ASSERT_EQUAL_UINT16(expected->I, actual->I);
+    TEST_ASSERT_EQUAL_UINT8(expected->sp, actual->sp);
+    TEST_ASSERT_EQUAL_INT(expected->cs, actual->cs);
+    TEST_ASSERT_EQUAL_INT(expected->mode, actual->mode);
+    TEST_ASSERT_EQUAL_UINT64(expected->cycles, actual->cycles);
+    TEST_ASSERT_EQUAL_UINT64(expected->rng, actual->rng);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected->mem, actual->mem, C8_MEMSIZE);
+    TEST_ASSERT_EQUAL_UINT8(expected->display.mode, actual->display.mode);
+    TEST_ASSERT_EQUAL_UINT8(expected->display.x, actual->display.x);
+    TEST_ASSERT_EQUAL_UINT8(expected->display.y, actual->display.y);
+    TEST_ASSERT_EQUAL_MEMORY(expected->display.p, actual->display.p, sizeof(expected->display.p));
+}
+
+void test_c8_save_state_mem_WhereStateIsRestored(void) {
+    size_t size = c8_save_state_mem(c8, buf, sizeof(buf), 0);
+    c8_t* c = c8_init_mem(NULL, 0, 0);
+
+    TEST_ASSERT_EQUAL_UINT8(C8_DISPLAYMODE_HIGH, c8->display.mode);
+    TEST_ASSERT_EQUAL_UINT8(4, c8->display.x);
+    TEST_ASSERT_EQUAL_UINT8(1, c8->sp);
+
+    TEST_ASSERT_EQUAL_size_t(C8_STATE_MAX_SIZE, size);
+    TEST_ASSERT_EQUAL_INT(1, c8_load_state_mem(c, buf, size));
+    assert_state_equal(c8, c);
+
+    /* Both continue identically */
+    c8_run_frames(c8, 5);
+    c8_run_frames(c, 5);
+    assert_state_equal(c8, c);
+    c8_deinit(c);
+}
+
+void test_c8_save_state_mem_WhereStateIsCompressed(void) {
+    size_t size = c8_save_state_mem(c8, buf, sizeof(buf), C8_STATE_COMPRESS);
+    c8_t* c = c8_init_mem(NULL, 0, 0);
+
+    TEST_ASSERT_LESS_THAN(C8_STATE_MAX_SIZE / 4, size);
+    TEST_ASSERT_EQUAL_INT(1, c8_load_state_mem(c, buf, size));
+    assert_state_equal(c8, c);
+    c8_deinit(c);
+}
+
+void test_c8_save_state_mem_WhereDisplayIsScrolled(void) {
+    /* HIGH; SCR; JP 0x202 */
+    const uint16_t scroll[] = { 0x00FF, 0x00FB, 0x1202 };
+    c8_t* s = ROM_INIT(scroll, C8_MODE_SCHIP, 0);
+    c8_t* c = c8_init_mem(NULL, 0, 0);
+    size_t size;
+
+    c8_run(s, 1 + 2 * 32);
+    TEST_ASSERT_EQUAL_INT(C8_HIGH_DISPLAY_WIDTH, s->display.x);
+
+    size = c8_save_state_mem(s, buf, sizeof(buf), 0);
+    TEST_ASSERT_EQUAL_INT(1, c8_load_state_mem(c, buf, size));
+    TEST_ASSERT_EQUAL_INT(C8_HIGH_DISPLAY_WIDTH, c->display.x);
+    TEST_ASSERT_EQUAL_INT(C8_DISPLAYMODE_HIGH, c->display.mode);
+    c8_deinit(c);
+    c8_deinit(s);
+}
+
+void test_c8_save_state_mem_WhereBufferIsTooSmall(void) {
+    size_t size = c8_save_state_mem(c8, buf, sizeof(buf), C8_STATE_COMPRESS);
+
+    TEST_ASSERT_EQUAL_size_t(0, c8_save_state_mem(c8, buf, size - 1, C8_STATE_COMPRESS));
+}
+
+void test_c8_load_state_mem_WhereHeaderIsInvalid(void) {
+    size_t size = c8_save_state_mem(c8, buf, sizeof(buf), 0);
+    uint16_t pc = c8->pc;
+
+    buf[0] = 'X';
+    TEST_ASSERT_EQUAL_INT(0, c8_load_state_mem(c8, buf, size));
+    buf[0] = 'C';
+    buf[4] = C8_STATE_VERSION + 1;
+    TEST_ASSERT_EQUAL_INT(0, c8_load_state_mem(c8, buf, size));
+    TEST_ASSERT_EQUAL_UINT16(pc, c8->pc);
+}
+
+void test_c8_load_state_mem_WhereStateIsTruncated(void) {
+    size_t size = c8_save_state_mem(c8, buf, sizeof(buf), C8_STATE_COMPRESS);
+
+    for (size_t i = 0; i < size; i++) {
+        TEST_ASSERT_EQUAL_INT(0, c8_load_state_mem(c8, buf, i));
+    }
+    TEST_ASSERT_EQUAL_INT(1, c8_load_state_mem(c8, buf, size));
+}
+
+void test_c8_load_state_mem_WhereValuesAreInvalid(void) {
+    size_t size = c8_save_state_mem(c8, buf, sizeof(buf), 0);
+    uint8_t* cpu = buf + C8_STATE_HEADER_SIZE + C8_STATE_CHUNK_HEADER_SIZE;
+
+    cpu[60] = C8_STACK_SIZE + 1;
+    TEST_ASSERT_EQUAL_INT(0, c8_load_state_mem(c8, buf, size));
+    TEST_ASSERT_NOT_EQUAL(C8_STACK_SIZE + 1, c8->sp);
+}
+
+void test_c8_load_state_mem_WhereHostFlagsAreKept(void) {
+    c8_t* c = c8_init_mem(NULL, 0, C8_FLAG_DEBUG);
+    size_t size;
+
+    c8->flags |= C8_FLAG_QUIRK_SHIFT;
+    size = c8_save_state_mem(c8, buf, sizeof(buf), 0);
+    TEST_ASSERT_EQUAL_INT(1, c8_load_state_mem(c, buf, size));
+    TEST_ASSERT_EQUAL_INT(C8_FLAG_DEBUG | C8_FLAG_QUIRK_SHIFT, c->flags);
+    c8_deinit(c);
+}
+
+void test_c8_load_state_WhereFileIsMapped(void) {
+    const char* path = "test_state.c8s";
+    c8_t* c = c8_init_mem(NULL, 0, 0);
+
+    TEST_ASSERT_EQUAL_INT(1, c8_save_state(c8, path, C8_STATE_COMPRESS));
+    TEST_ASSERT_EQUAL_INT(1, c8_load_state(c, path));
+    assert_state_equal(c8, c);
+    TEST_ASSERT_EQUAL_INT(0, c8_load_state(c, "does/not/exist.c8s"));
+    remove(path);
+    c8_deinit(c);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_c8_save_state_mem_WhereStateIsRestored);
+    RUN_TEST(test_c8_save_state_mem_WhereStateIsCompressed);
+    RUN_TEST(test_c8_save_state_mem_WhereDisplayIsScrolled);
+    RUN_TEST(test_c8_save_state_mem_WhereBufferIsTooSmall);
+    RUN_TEST(test_c8_load_state_mem_WhereHeaderIsInvalid);
+    RUN_TEST(test_c8_load_state_mem_WhereStateIsTruncated);
+    RUN_TEST(test_c8_load_state_mem_WhereValuesAreInvalid);
+    RUN_TEST(test_c8_load_state_mem_WhereHostFlagsAreKept);
+    RUN_TEST(test_c8_load_state_WhereFileIsMapped);
+    return UNITY_END();
+}
@@ -11,235 +11,151 @@
 #include <string.h>
 #include <time.h>
 
-#define MAX_LINE_COUNT 10
-#define MAX_LINE_LEN 50
-
 instruction_t ins;
-symbol_list_t symbols;
 label_list_t labels;
+arena_t arena;
 const char* empty = "\0";
 int fc = 0;
-char* line0;
 
 void setUp(void) {
     memset(&ins, 0, sizeof(instruction_t));
-    memset(line0, 0, MAX_LINE_LEN * MAX_LINE_COUNT);
 
     memset(labels.l, 0, LABEL_CEILING * sizeof(label_t));
     labels.len = 0;
     labels.ceil = LABEL_CEILING;
+    labels.table = NULL;
+    labels.tableSize = 0;
 
-    memset(symbols.s, 0, SYMBOL_CEILING * sizeof(symbol_t));
-    symbols.len = 0;
-    symbols.ceil = SYMBOL_CEILING;
 }
 
 void tearDown(void) {
 }
 
-void generate_valid_instruction_symbols(int idx, int ln) {
-    instruction_format_t* fmt = &formats[rand() % fc];
-
-    symbols.s[idx].ln = ln;
-    symbols.s[idx].type = SYM_INSTRUCTION;
-    symbols.s[idx].value = fmt->cmd;
-
-    idx++;
-    symbols.len = idx + fmt->pcount;
-    for (int i = 0; i < fmt->pcount; i++) {
-        symbols.s[idx + i].ln = ln;
-        symbols.s[idx + i].type = fmt->ptype[i];
-        switch (fmt->ptype[i]) {
-        case SYM_R:
-        case SYM_V:
-        case SYM_INT:
-            symbols.s[idx + i].value = rand() % 16;
-            break;
-        default:
-            symbols.s[idx + i].value = 0;
-        }
-    }
-}
-
-void generate_invalid_instruction_symbols(int idx, int ln) {
-    instruction_format_t* fmt = &formats[rand() % fc];
-
-    while (fmt->pcount == 0) {
-        fmt = &formats[rand() % fc];
-    }
-
-    symbols.s[idx].ln = ln;
-    symbols.s[idx].type = SYM_INSTRUCTION;
-    symbols.s[idx].value = fmt->cmd;
-
-    int count = fmt->pcount == 0 ? 1 : 0;
-
-    idx++;
-    symbols.len = idx + fmt->pcount;
-    for (int i = 0; i < count; i++) {
-        symbols.s[idx + i].ln = ln;
-        switch (fmt->ptype[i]) {
-        case SYM_V:
-            symbols.s[idx + i].type = SYM_INT;
-            symbols.s[idx + i].value = rand() % 0x100;
-            break;
-        default:
-            symbols.s[idx + i].type = SYM_V;
-            symbols.s[idx + i].value = rand() % 0x10;
-        }
-    }
-}
-
-void test_is_comment_WhereCommentIsAtEndOfString(void) {
-    const char* s = "Hello ; This is a comment";
-    TEST_ASSERT_EQUAL_INT(0, is_comment(s));
-}
-
-void test_is_comment_WhereCommentIsEntireString(void) {
-    const char* s = "; This is a comment";
-    TEST_ASSERT_EQUAL_INT(1, is_comment(s));
-}
-
-void test_is_comment_WhereStringIsEmpty(void) {
-    TEST_ASSERT_EQUAL_INT(0, is_comment(empty));
-}
-
-void test_is_comment_WhereNoCommentIsInString(void) {
-    const char* s = "This is not a comment";
-    TEST_ASSERT_EQUAL_INT(0, is_comment(s));
-}
+void test_is_instruction_WhereStringIsInstruction(void) {
+    int ic = 0;
+    for (ic = 0; c8_instructionStrings[ic] != NULL; ic++);
 
-void test_is_db_WhereStringIsDB(void) {
-    TEST_ASSERT_EQUAL_INT(1, is_db(S_DB));
-}
+    int i = rand() % ic;
 
-void test_is_db_WhereStringIsNotDB(void) {
-    TEST_ASSERT_EQUAL_INT(0, is_db(S_DW));
-}
+    char s[16];
+    strcpy(s, c8_instructionStrings[i]);
 
-void test_is_db_WhereStringContainsDB(void) {
-    const char* s = "Foo .DB";
-    TEST_ASSERT_EQUAL_INT(0, is_db(s));
+    TEST_ASSERT_EQUAL_INT(i, is_instruction(s, strlen(s)));
 }
 
-void test_is_db_WithTrailingChars(void) {
-    const char* s = ".DB foo";
-    TEST_ASSERT_EQUAL_INT(0, is_db(s));
+void test_is_instruction_WhereStringIsAnyInstruction(void) {
+    for (int i = 0; c8_instructionStrings[i] != NULL; i++) {
+        TEST_ASSERT_EQUAL_INT(i, is_instruction(c8_instructionStrings[i], strlen(c8_instructionStrings[i])));
+        TEST_ASSERT_EQUAL_INT(-1, is_reserved_identifier(c8_instructionStrings[i], strlen(c8_instructionStrings[i])));
+    }
 }
 
-void test_is_db_WhereStringIsEmpty(void) {
-    TEST_ASSERT_EQUAL_INT(0, is_db(empty));
-}
+void test_is_instruction_WhereStringIsNotInstruction(void) {
+    const char* s = "Not an instruction";
 
-void test_is_dw_WhereStringIsDW(void) {
-    TEST_ASSERT_EQUAL_INT(1, is_dw(S_DW));
+    TEST_ASSERT_EQUAL_INT(-1, is_instruction(s, strlen(s)));
 }
 
-void test_is_dw_WhereStringIsNotDW(void) {
-    TEST_ASSERT_EQUAL_INT(0, is_dw(S_DB));
+void test_is_instruction_WhereStringIsEmpty(void) {
+    TEST_ASSERT_EQUAL_INT(-1, is_instruction(empty, strlen(empty)));
 }
 
-void test_is_dw_WhereStringContainsDW(void) {
-    const char* s = "Foo .DW";
-    TEST_ASSERT_EQUAL_INT(0, is_db(s));
+void test_is_instruction_WhereStringIsLowercase(void) {
+    TEST_ASSERT_EQUAL_INT(I_SKNP, is_instruction("sknp", 4));
+    TEST_ASSERT_EQUAL_INT(I_LD, is_instruction("Ld", 2));
 }
 
-void test_is_dw_WithTrailingChars(void) {
-    const char* s = ".DW foo";
-    TEST_ASSERT_EQUAL_INT(0, is_dw(s));
-}
+void test_is_instruction_WhereStringIsNotNullTerminated(void) {
+    const char* s = "CLS V1";
 
-void test_is_dw_WhereStringIsEmpty(void) {
-    TEST_ASSERT_EQUAL_INT(0, is_dw(empty));
+    TEST_ASSERT_EQUAL_INT(I_CLS, is_instruction(s, 3));
+    TEST_ASSERT_EQUAL_INT(-1, is_instruction(s, 4));
 }
 
-void test_is_instruction_WhereStringIsInstruction(void) {
-    int ic = 0;
-    for (ic = 0; c8_instructionStrings[ic] != NULL; ic++);
-
-    int i = rand() % ic;
-
-    char s[16];
-    strcpy(s, c8_instructionStrings[i]);
-
-    TEST_ASSERT_EQUAL_INT(i, is_instruction(s));
+void test_add_label_WhereLabelIsNew(void) {
+    TEST_ASSERT_EQUAL_INT(0, add_label(&labels, "LOOP1", 5));
+    TEST_ASSERT_EQUAL_INT(1, add_label(&labels, "LOOP10", 6));
+    TEST_ASSERT_EQUAL_INT(2, labels.len);
+    TEST_ASSERT_EQUAL_STRING("LOOP1", labels.l[0].identifier);
+    TEST_ASSERT_EQUAL_INT(0, find_label(&labels, "LOOP1", 5));
+    TEST_ASSERT_EQUAL_INT(1, find_label(&labels, "LOOP10", 6));
+    TEST_ASSERT_EQUAL_INT(-1, find_label(&labels, "LOOP", 4));
 }
 
-void test_is_instruction_WhereStringIsNotInstruction(void) {
-    const char* s = "Not an instruction";
+void test_add_label_WhereLabelIsDuplicate(void) {
+    add_label(&labels, "LOOP", 4);
 
-    TEST_ASSERT_EQUAL_INT(-1, is_instruction(s));
+    TEST_ASSERT_EQUAL_INT(DUPLICATE_LABEL_EXCEPTION, add_label(&labels, "LOOP:", 4));
+    TEST_ASSERT_EQUAL_INT(1, labels.len);
 }
 
-void test_is_instruction_WhereStringIsEmpty(void) {
-    TEST_ASSERT_EQUAL_INT(-1, is_instruction(empty));
-}
+void test_add_label_WhereLabelListIsFull(void) {
+    char s[32];
+    int count = LABEL_TABLE_SIZE * 2;
 
-void test_is_label_definition_WhereStringIsLabelDefinition(void) {
-    const char* s = "L:";
+    for (int i = 0; i < count; i++) {
+        sprintf(s, "LABEL%d", i);
+        TEST_ASSERT_EQUAL_INT(i, add_label(&labels, s, strlen(s)));
+    }
 
-    TEST_ASSERT_EQUAL_INT(1, is_label_definition(s));
+    TEST_ASSERT_EQUAL_INT(count, labels.len);
+    TEST_ASSERT_EQUAL_INT(count, labels.ceil);
+    TEST_ASSERT_EQUAL_INT(count * 2, labels.tableSize);
+    for (int i = 0; i < count; i++) {
+        sprintf(s, "LABEL%d", i);
+        TEST_ASSERT_EQUAL_INT(i, find_label(&labels, s, strlen(s)));
+    }
 }
 
-void test_is_label_definition_WhereStringIsNotLabelDefinition(void) {
-    const char* s = "L";
-
-    TEST_ASSERT_EQUAL_INT(0, is_label_definition(s));
-}
+void test_add_label_WhereIdentifierIsLong(void) {
+    const char* s = "A_VERY_LONG_LABEL_IDENTIFIER_FOR_A_TABLE";
 
-void test_is_label_definition_WhereStringIsEmpty(void) {
-    TEST_ASSERT_EQUAL_INT(0, is_label_definition(empty));
+    TEST_ASSERT_EQUAL_INT(0, add_label(&labels, s, strlen(s)));
+    TEST_ASSERT_EQUAL_STRING(s, labels.l[0].identifier);
+    TEST_ASSERT_EQUAL_INT(0, find_label(&labels, s, strlen(s)));
 }
 
-void test_is_label_WhereStringIsLabel(void) {
+void test_find_label_WhereStringIsLabel(void) {
     const char* s = "L";
 
-    labels.len = 3;
-    labels.l[0].byte = rand();
-    strcpy(labels.l[0].identifier, "LABEL");
-    labels.l[1].byte = rand();
-    strcpy(labels.l[1].identifier, "ANOTHERLABEL");
-    labels.l[2].byte = rand();
-    strcpy(labels.l[2].identifier, "L");
+    add_label(&labels, "LABEL", 5);
+    add_label(&labels, "ANOTHERLABEL", 12);
+    add_label(&labels, "L", 1);
 
-    TEST_ASSERT_EQUAL_INT(2, is_label(s, &labels));
+    TEST_ASSERT_EQUAL_INT(2, find_label(&labels, s, strlen(s)));
 }
 
-void test_is_label_WhereStringIsNotLabel(void) {
+void test_find_label_WhereStringIsNotLabel(void) {
     const char* s = "L";
 
-    labels.len = 3;
-    labels.l[0].byte = rand();
-    strcpy(labels.l[0].identifier, "LABEL");
-    labels.l[1].byte = rand();
-    strcpy(labels.l[1].identifier, "ANOTHERLABEL");
-    labels.l[2].byte = rand();
-    strcpy(labels.l[2].identifier, "L");
+    add_label(&labels, "LABEL", 5);
+    add_label(&labels, "ANOTHERLABEL", 12);
+    add_label(&labels, "L", 1);
 
-    TEST_ASSERT_EQUAL_INT(-1, is_label("LABEL3", &labels));
+    TEST_ASSERT_EQUAL_INT(-1, find_label(&labels, "LABEL3", strlen("LABEL3")));
 }
 
-void test_is_label_WhereStringIsEmpty(void) {
-    TEST_ASSERT_EQUAL_INT(-1, is_label(empty, &labels));
+void test_find_label_WhereStringIsEmpty(void) {
+    TEST_ASSERT_EQUAL_INT(-1, find_label(&labels, empty, strlen(empty)));
 }
 
 void test_is_register_WhereStringIsRegister_WhereRegisterIsUppercase(void) {
     const char* s = "V1";
-    TEST_ASSERT_EQUAL_INT(1, is_register(s));
+    TEST_ASSERT_EQUAL_INT(1, is_register(s, strlen(s)));
 }
 
 void test_is_register_WhereStringIsRegister_RegisterIsLowercase(void) {
     const char* s = "vf";
-    TEST_ASSERT_EQUAL_INT(0xF, is_register(s));
+    TEST_ASSERT_EQUAL_INT(0xF, is_register(s, strlen(s)));
 }
 
 void test_is_register_WhereStringIsNotRegister(void) {
     const char* s = "x4";
-    TEST_ASSERT_EQUAL_INT(-1, is_register(s));
+    TEST_ASSERT_EQUAL_INT(-1, is_register(s, strlen(s)));
 }
 
 void test_is_register_WhereStringIsEmpty(void) {
-    TEST_ASSERT_EQUAL_INT(-1, is_register(empty));
+    TEST_ASSERT_EQUAL_INT(-1, is_register(empty, strlen(empty)));
 }
 
 void test_is_reserved_identifier_WhereStringIsReservedIdentifier(void) {
@@ -251,293 +167,97 @@ void test_is_reserved_identifier_WhereStringIsReservedIdentifier(void) {
     char s[16];
     strcpy(s, c8_identifierStrings[ident]);
 
-    TEST_ASSERT_EQUAL_INT(ident, is_reserved_identifier(s));
+    TEST_ASSERT_EQUAL_INT(ident, is_reserved_identifier(s, strlen(s)));
+}
+
+void test_is_reserved_identifier_WhereStringIsAnyReservedIdentifier(void) {
+    for (int i = 0; c8_identifierStrings[i] != NULL; i++) {
+        TEST_ASSERT_EQUAL_INT(i, is_reserved_identifier(c8_identifierStrings[i], strlen(c8_identifierStrings[i])));
+        TEST_ASSERT_EQUAL_INT(-1, is_instruction(c8_identifierStrings[i], strlen(c8_identifierStrings[i])));
+    }
 }
 
 void test_is_reserved_identifier_WhereStringIsNotReservedIdentifier(void) {
     const char* s = "Not reserved";
 
-    TEST_ASSERT_EQUAL_INT(-1, is_reserved_identifier(s));
+    TEST_ASSERT_EQUAL_INT(-1, is_reserved_identifier(s, strlen(s)));
 }
 
 void test_is_reserved_identifier_WhereStringIsEmpty(void) {
-    TEST_ASSERT_EQUAL_INT(-1, is_reserved_identifier(empty));
+    TEST_ASSERT_EQUAL_INT(-1, is_reserved_identifier(empty, strlen(empty)));
 }
 
-void test_next_symbol_WhereSymbolListIsEmpty(void) {
-    memset(symbols.s, 0, SYMBOL_CEILING);
-    symbols.len = 0;
-    symbols.ceil = SYMBOL_CEILING;
+void test_find_label_WhereCaseDiffers(void) {
+    add_label(&labels, "Loop", 4);
 
-    TEST_ASSERT_EQUAL_PTR(&symbols.s[0], next_symbol(&symbols));
+    TEST_ASSERT_EQUAL_INT(0, find_label(&labels, "LOOP", 4));
+    TEST_ASSERT_EQUAL_INT(0, find_label(&labels, "loop:", 4));
+    TEST_ASSERT_EQUAL_INT(DUPLICATE_LABEL_EXCEPTION, add_label(&labels, "lOoP", 4));
 }
 
-void test_next_symbol_WhereSymbolListIsNotEmptyOrFull(void) {
-    memset(symbols.s, 0, SYMBOL_CEILING);
-
-    symbols.len = 2;
-    symbols.ceil = SYMBOL_CEILING;
-    symbols.s[0].type = SYM_INSTRUCTION;
-    symbols.s[1].type = SYM_IP;
-
-    TEST_ASSERT_EQUAL_PTR(&symbols.s[2], next_symbol(&symbols));
-}
-
-void test_next_symbol_WhereSymbolListIsFull(void) {
-    memset(symbols.s, SYM_INSTRUCTION, SYMBOL_CEILING);
-
-    symbols.len = SYMBOL_CEILING;
-    symbols.ceil = SYMBOL_CEILING;
-
-    symbol_t* symbol = next_symbol(&symbols);
-
-    TEST_ASSERT_EQUAL_INT(SYMBOL_CEILING + 1, symbols.len);
-    TEST_ASSERT_EQUAL_INT(SYMBOL_CEILING * 2, symbols.ceil);
-    TEST_ASSERT_EQUAL_PTR(&symbols.s[SYMBOL_CEILING], symbol);
-}
-
-void test_populate_labels_WhereLinesIsEmpty(void) {
-    int r = populate_labels(&labels);
-
-    TEST_ASSERT_EQUAL_INT(1, r);
-    TEST_ASSERT_EQUAL_INT(0, labels.len);
-    TEST_ASSERT_EQUAL_STRING("\0", labels.l[0].identifier);
-}
-
-void test_populate_labels_WhereLabelListIsEmpty(void) {
-    sprintf(c8_lines[0], "%s", "ADD V4, V5");
-    sprintf(c8_lines[1], "%s", "\0");
-    sprintf(c8_lines[2], "%s", "CLS");
-    sprintf(c8_lines[3], "%s", "RET");
-    sprintf(c8_lines[4], "%s", "SE V1, $55");
-
-    int r = populate_labels(&labels);
-    TEST_ASSERT_EQUAL_INT(1, r);
-    TEST_ASSERT_EQUAL_INT(0, labels.len);
-    TEST_ASSERT_EQUAL_STRING("\0", labels.l[0].identifier);
-}
-
-void test_populate_labels_WhereLinesHasMultipleLabelDefinitions(void) {
-    sprintf(c8_lines[0], "%s", "ADD V4, V5");
-    sprintf(c8_lines[1], "%s", "label:");
-    sprintf(c8_lines[2], "%s", "RET");
-    sprintf(c8_lines[3], "%s", "otherlabel:");
-    sprintf(c8_lines[4], "%s", "SE V1, $55");
-
-    int r = populate_labels(&labels);
-
-    TEST_ASSERT_EQUAL_INT(1, r);
-    TEST_ASSERT_EQUAL_INT(2, labels.len);
-    TEST_ASSERT_EQUAL_STRING("label", labels.l[0].identifier);
-    TEST_ASSERT_EQUAL_STRING("otherlabel", labels.l[1].identifier);
-}
-
-void test_populate_labels_WhereLinesHasDuplicateLabelDefinitions(void) {
-    sprintf(c8_lines[0], "%s", "ADD V4, V5");
-    sprintf(c8_lines[1], "%s", "label:");
-    sprintf(c8_lines[2], "%s", "RET");
-    sprintf(c8_lines[3], "%s", "label:");
-    sprintf(c8_lines[4], "%s", "SE V1, $55");
-    c8_line_count = 5;
-
-    int r = populate_labels(&labels);
-
-    TEST_ASSERT_EQUAL_INT(DUPLICATE_LABEL_EXCEPTION, r);
-}
-
-void test_resolve_labels_WhereLabelListHasOneLabel_WhereSymbolListHasLabelDefinition(void) {
-
-    symbols.len = 3;
-    symbols.s[0].type = SYM_INSTRUCTION;
-    symbols.s[1].type = SYM_LABEL;
-    symbols.s[1].value = 0;
-    symbols.s[2].type = SYM_LABEL_DEFINITION;
-    symbols.s[2].value = 0;
-    symbols.s[3].type = SYM_INSTRUCTION;
-
-    labels.len = 1;
-    sprintf(labels.l[0].identifier, "%s", "LABEL");
-
-    int r = resolve_labels(&symbols, &labels);
-    TEST_ASSERT_EQUAL_INT(1, r);
-    TEST_ASSERT_EQUAL_INT(0x202, labels.l[0].byte);
-}
-
-void test_resolve_labels_WhereLabelListHasOneLabel_WhereSymbolListDoesNotHaveLabelDefinition(void) {
-
-    symbols.len = 2;
-    symbols.s[0].type = SYM_INSTRUCTION;
-    symbols.s[1].type = SYM_LABEL;
-    symbols.s[1].value = 0;
-
-    labels.len = 1;
-    sprintf(labels.l[0].identifier, "%s", "LABEL");
-
-    int r = resolve_labels(&symbols, &labels);
-    TEST_ASSERT_EQUAL_INT(1, r);
-    TEST_ASSERT_EQUAL_INT(0, labels.l[0].byte);
-}
-
-void test_resolve_labels_WhereLabelListHasMultipleLabels_WhereSymbolListHasLabelDefinitions(void) {
-
-    symbols.len = 5;
-    symbols.s[0].type = SYM_INSTRUCTION;
-    symbols.s[1].type = SYM_LABEL_DEFINITION;
-    symbols.s[1].value = 0;
-    symbols.s[2].type = SYM_INSTRUCTION;
-    symbols.s[3].type = SYM_LABEL_DEFINITION;
-    symbols.s[3].value = 1;
-    symbols.s[4].type = SYM_INSTRUCTION;
-
-    labels.len = 2;
-    sprintf(labels.l[0].identifier, "%s", "LABEL");
-    sprintf(labels.l[1].identifier, "%s", "OTHERLABEL");
-
-    int r = resolve_labels(&symbols, &labels);
-    TEST_ASSERT_EQUAL_INT(1, r);
-    TEST_ASSERT_EQUAL_INT(0x202, labels.l[0].byte);
-    TEST_ASSERT_EQUAL_INT(0x204, labels.l[1].byte);
+void test_get_label_WhereLabelIsNew(void) {
+    TEST_ASSERT_EQUAL_INT(0, get_label(&labels, "LOOP", 4));
+    TEST_ASSERT_EQUAL_INT(1, labels.len);
+    TEST_ASSERT_EQUAL_INT(-1, labels.l[0].byte);
 }
 
-void test_resolve_labels_WhereSymbolListIsEmpty(void) {
-    labels.len = 1;
-    sprintf(labels.l[0].identifier, "%s", "LABEL");
+void test_get_label_WhereLabelExists(void) {
+    add_label(&labels, "LOOP", 4);
+    labels.l[0].byte = 0x204;
 
-    TEST_ASSERT_EQUAL_INT(0, resolve_labels(&symbols, &labels));
+    TEST_ASSERT_EQUAL_INT(0, get_label(&labels, "LOOP", 4));
+    TEST_ASSERT_EQUAL_INT(1, labels.len);
+    TEST_ASSERT_EQUAL_INT(0x204, labels.l[0].byte);
 }
 
-void test_resolve_labels_WhereLabelListIsEmpty(void) {
+void test_build_instruction_WhereInstructionIsValid(void) {
+    ins.cmd = I_LD;
+    ins.pcount = 2;
+    ins.ptype[0] = SYM_V;
+    ins.p[0] = 0x3;
+    ins.ptype[1] = SYM_INT;
+    ins.p[1] = 0x42;
 
-    symbols.len = 1;
-    symbols.s[0].type = SYM_DB;
-
-    TEST_ASSERT_EQUAL_INT(1, resolve_labels(&symbols, &labels));
-}
-
-void test_substitute_labels_WhereLabelListContainsAllLabels(void) {
-
-    symbols.len = 7;
-    symbols.s[0].type = SYM_INSTRUCTION;
-    symbols.s[1].type = SYM_LABEL;
-    symbols.s[1].value = 1;
-    symbols.s[2].type = SYM_LABEL_DEFINITION;
-    symbols.s[2].value = 0;
-    symbols.s[3].type = SYM_INSTRUCTION;
-    symbols.s[4].type = SYM_LABEL_DEFINITION;
-    symbols.s[4].value = 1;
-    symbols.s[5].type = SYM_INSTRUCTION;
-    symbols.s[6].type = SYM_LABEL;
-    symbols.s[6].value = 0;
-
-    labels.len = 2;
-    labels.l[0].byte = 0x202;
-    labels.l[1].byte = 0x204;
-
-    int r = substitute_labels(&symbols, &labels);
-
-    TEST_ASSERT_EQUAL_INT(1, r);
-    TEST_ASSERT_EQUAL_INT(SYM_INT12, symbols.s[1].type);
-    TEST_ASSERT_EQUAL_INT(0x204, symbols.s[1].value);
-    TEST_ASSERT_EQUAL_INT(SYM_INT12, symbols.s[6].type);
-    TEST_ASSERT_EQUAL_INT(0x202, symbols.s[6].value);
+    TEST_ASSERT_EQUAL_HEX16(0x6342, build_instruction(&ins));
+    TEST_ASSERT_NOT_NULL(ins.format);
 }
 
-void test_substitute_labels_WhereLabelListIsMissingLabels(void) {
-
-    symbols.len = 7;
-    symbols.s[0].type = SYM_INSTRUCTION;
-    symbols.s[1].type = SYM_LABEL;
-    symbols.s[1].value = 1;
-    symbols.s[2].type = SYM_LABEL_DEFINITION;
-    symbols.s[2].value = 0;
-    symbols.s[3].type = SYM_INSTRUCTION;
-    symbols.s[4].type = SYM_LABEL_DEFINITION;
-    symbols.s[4].value = 1;
-    symbols.s[5].type = SYM_INSTRUCTION;
-    symbols.s[6].type = SYM_LABEL;
-    symbols.s[6].value = 0;
+void test_build_instruction_WhereInstructionIsInvalid(void) {
+    c8_line = "CLS V1";
+    c8_source_end = c8_line + 6;
+    ins.cmd = I_CLS;
+    ins.pcount = 1;
+    ins.ptype[0] = SYM_V;
 
-    labels.len = 1;
-    labels.l[0].byte = 0x202;
-
-    int r = substitute_labels(&symbols, &labels);
-
-    TEST_ASSERT_EQUAL_INT(INVALID_SYMBOL_EXCEPTION, r);
-}
-
-void test_substitute_labels_WhereSymbolListIsEmpty(void) {
-    labels.len = 1;
-    labels.l[0].byte = 0x202;
-
-    int r = substitute_labels(&symbols, &labels);
-
-    TEST_ASSERT_EQUAL_INT(1, r);
-}
-
-void test_substitute_labels_WhereSymbolListContainsNoLabels_WhereLabelListIsEmpty(void) {
-
-    symbols.len = 4;
-    symbols.s[0].type = SYM_INSTRUCTION;
-    symbols.s[1].type = SYM_INSTRUCTION;
-    symbols.s[2].type = SYM_INSTRUCTION;
-    symbols.s[3].type = SYM_DB;
-
-    int r = substitute_labels(&symbols, &labels);
-
-    TEST_ASSERT_EQUAL_INT(1, r);
+    TEST_ASSERT_EQUAL_INT(INVALID_INSTRUCTION_EXCEPTION, build_instruction(&ins));
 }
 
 int main(void) {
     srand(time(NULL));
 
-    symbols.s = calloc(SYMBOL_CEILING, sizeof(symbol_t));
-    symbols.ceil = SYMBOL_CEILING;
-    labels.l = calloc(LABEL_CEILING, sizeof(label_t));
+    labels.l = arena_calloc(&arena, LABEL_CEILING, sizeof(label_t));
     labels.ceil = LABEL_CEILING;
+    labels.arena = &arena;
 
     for (fc = 0; formats[fc].cmd != I_NULL; fc++);
 
-    c8_lines = malloc(MAX_LINE_COUNT * sizeof(char*));
-    line0 = malloc(MAX_LINE_LEN * MAX_LINE_COUNT);
-    for (int i = 0; i < MAX_LINE_COUNT; i++) {
-        c8_lines[i] = line0 + (i * MAX_LINE_LEN);
-    }
-
-    c8_lines_unformatted = malloc(MAX_LINE_COUNT * sizeof(char*));
-    for (int i = 0; i < MAX_LINE_COUNT; i++) {
-        c8_lines_unformatted[i] = line0 + (i * MAX_LINE_LEN);
-    }
-
     UNITY_BEGIN();
 
-    RUN_TEST(test_is_comment_WhereCommentIsEntireString);
-    RUN_TEST(test_is_comment_WhereCommentIsAtEndOfString);
-    RUN_TEST(test_is_comment_WhereNoCommentIsInString);
-    RUN_TEST(test_is_comment_WhereStringIsEmpty);
-
-    RUN_TEST(test_is_db_WhereStringIsDB);
-    RUN_TEST(test_is_db_WhereStringIsNotDB);
-    RUN_TEST(test_is_db_WhereStringContainsDB);
-    RUN_TEST(test_is_db_WithTrailingChars);
-    RUN_TEST(test_is_db_WhereStringIsEmpty);
-
-    RUN_TEST(test_is_dw_WhereStringIsDW);
-    RUN_TEST(test_is_dw_WhereStringIsNotDW);
-    RUN_TEST(test_is_dw_WhereStringContainsDW);
-    RUN_TEST(test_is_dw_WithTrailingChars);
-    RUN_TEST(test_is_dw_WhereStringIsEmpty);
-
     RUN_TEST(test_is_instruction_WhereStringIsInstruction);
+    RUN_TEST(test_is_instruction_WhereStringIsAnyInstruction);
     RUN_TEST(test_is_instruction_WhereStringIsNotInstruction);
     RUN_TEST(test_is_instruction_WhereStringIsEmpty);
+    RUN_TEST(test_is_instruction_WhereStringIsLowercase);
+    RUN_TEST(test_is_instruction_WhereStringIsNotNullTerminated);
 
-    RUN_TEST(test_is_label_definition_WhereStringIsLabelDefinition);
-    RUN_TEST(test_is_label_definition_WhereStringIsNotLabelDefinition);
-    RUN_TEST(test_is_label_definition_WhereStringIsEmpty);
+    RUN_TEST(test_add_label_WhereLabelIsNew);
+    RUN_TEST(test_add_label_WhereLabelIsDuplicate);
+    RUN_TEST(test_add_label_WhereLabelListIsFull);
+    RUN_TEST(test_add_label_WhereIdentifierIsLong);
 
-    RUN_TEST(test_is_label_WhereStringIsLabel);
-    RUN_TEST(test_is_label_WhereStringIsNotLabel);
-    RUN_TEST(test_is_label_WhereStringIsEmpty);
+    RUN_TEST(test_find_label_WhereStringIsLabel);
+    RUN_TEST(test_find_label_WhereStringIsNotLabel);
+    RUN_TEST(test_find_label_WhereStringIsEmpty);
 
     RUN_TEST(test_is_register_WhereStringIsRegister_WhereRegisterIsUppercase);
     RUN_TEST(test_is_register_WhereStringIsRegister_RegisterIsLowercase);
@@ -545,32 +265,18 @@ int main(void) {
     RUN_TEST(test_is_register_WhereStringIsEmpty);
 
     RUN_TEST(test_is_reserved_identifier_WhereStringIsReservedIdentifier);
+    RUN_TEST(test_is_reserved_identifier_WhereStringIsAnyReservedIdentifier);
     RUN_TEST(test_is_reserved_identifier_WhereStringIsNotReservedIdentifier);
     RUN_TEST(test_is_register_WhereStringIsEmpty);
 
-    RUN_TEST(test_next_symbol_WhereSymbolListIsEmpty);
-    RUN_TEST(test_next_symbol_WhereSymbolListIsFull);
-    RUN_TEST(test_next_symbol_WhereSymbolListIsNotEmptyOrFull);
-
-    RUN_TEST(test_populate_labels_WhereLinesHasDuplicateLabelDefinitions);
-    RUN_TEST(test_populate_labels_WhereLinesIsEmpty);
-    RUN_TEST(test_populate_labels_WhereLinesHasMultipleLabelDefinitions);
-    RUN_TEST(test_populate_labels_WhereLabelListIsEmpty);
-
-    RUN_TEST(test_resolve_labels_WhereLabelListHasOneLabel_WhereSymbolListHasLabelDefinition);
-    RUN_TEST(test_resolve_labels_WhereLabelListHasMultipleLabels_WhereSymbolListHasLabelDefinitions);
-    RUN_TEST(test_resolve_labels_WhereSymbolListIsEmpty);
-    RUN_TEST(test_resolve_labels_WhereLabelListIsEmpty);
-
-    RUN_TEST(test_substitute_labels_WhereLabelListContainsAllLabels);
-    RUN_TEST(test_substitute_labels_WhereLabelListIsMissingLabels);
-    RUN_TEST(test_substitute_labels_WhereSymbolListIsEmpty);
-    RUN_TEST(test_substitute_labels_WhereSymbolListContainsNoLabels_WhereLabelListIsEmpty);
-
-    free(symbols.s);
-    free(labels.l);
-    free(line0);
-    free(c8_lines);
-    free(c8_lines_unformatted);
+    RUN_TEST(test_find_label_WhereCaseDiffers);
+
+    RUN_TEST(test_get_label_WhereLabelIsNew);
+    RUN_TEST(test_get_label_WhereLabelExists);
+
+    RUN_TEST(test_build_instruction_WhereInstructionIsValid);
+    RUN_TEST(test_build_instruction_WhereInstructionIsInvalid);
+
+    arena_free(&arena);
     return UNITY_END();
 }
@@ -0,0 +1,65 @@
+#include "unity.h"
+#include "c8/private/timer.c"
+#include "c8/chip8.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+c8_t c8;
+
+void setUp(void) {
+    memset(&c8, 0, sizeof(c8_t));
+    c8.cs = C8_CLOCK_SPEED;
+    c8.dt = 0xFF;
+    c8.st = 0xFF;
+}
+
+void tearDown(void) {
+}
+
+void test_timer_advance_WhereOneSecondElapses(void) {
+    TEST_ASSERT_EQUAL_INT(60, timer_advance(&c8, c8.cs));
+    TEST_ASSERT_EQUAL_UINT8(0xFF - 60, c8.dt);
+    TEST_ASSERT_EQUAL_UINT8(0xFF - 60, c8.st);
+}
+
+void test_timer_advance_WhereCyclesAreSplit(void) {
+    int ticks = 0;
+
+    c8.cs = 1000 + (rand() % 100000);
+    for (int i = 0; i < c8.cs; i++) {
+        ticks += timer_advance(&c8, 1);
+    }
+
+    TEST_ASSERT_EQUAL_INT(60, ticks);
+    TEST_ASSERT_EQUAL_UINT8(0xFF - 60, c8.dt);
+    TEST_ASSERT_EQUAL_INT(0, c8.timerCycles);
+}
+
+void test_timer_advance_WhereClockSpeedIsHigh(void) {
+    c8.cs = 1000000;
+
+    TEST_ASSERT_EQUAL_INT(0, timer_advance(&c8, (c8.cs + 59) / 60 - 1));
+    TEST_ASSERT_EQUAL_UINT8(0xFF, c8.dt);
+    TEST_ASSERT_EQUAL_INT(1, timer_advance(&c8, 1));
+    TEST_ASSERT_EQUAL_UINT8(0xFE, c8.dt);
+}
+
+void test_timer_advance_WhereTimersReachZero(void) {
+    c8.dt = 3;
+    c8.st = 0;
+
+    TEST_ASSERT_EQUAL_INT(60, timer_advance(&c8, c8.cs));
+    TEST_ASSERT_EQUAL_UINT8(0, c8.dt);
+    TEST_ASSERT_EQUAL_UINT8(0, c8.st);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_timer_advance_WhereOneSecondElapses);
+    RUN_TEST(test_timer_advance_WhereCyclesAreSplit);
+    RUN_TEST(test_timer_advance_WhereClockSpeedIsHigh);
+    RUN_TEST(test_timer_advance_WhereTimersReachZero);
+    return UNITY_END();
+}
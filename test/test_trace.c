@@ -0,0 +1,148 @@
+#include "unity.h"
+#include "c8/trace.c"
+#include "c8/chip8.h"
+#include "test_rom.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TRACE_PATH "test_trace.c8t"
+
+/* Changes I and Vx, which are recorded with each instruction */
+static const uint16_t rom[] = {
+    0x6005, /* 200: LD V0, 5 */
+    0xA300, /* 202: LD I, 0x300 */
+    0x70FF, /* 204: ADD V0, 0xFF */
+    0x1204, /* 206: JP 0x204 */
+};
+
+static const uint16_t badRom[] = {
+    0x6005, /* 200: LD V0, 5 */
+    0xA300, /* 202: LD I, 0x300 */
+    0x00FF, /* 204: HIGH (invalid in CHIP-8 mode) */
+};
+
+uint8_t buf[1 << 20];
+c8_t* c8;
+
+static size_t read_trace(void) {
+    FILE* f = fopen(TRACE_PATH, "rb");
+    size_t n = fread(buf, 1, sizeof(buf), f);
+
+    fclose(f);
+    return n;
+}
+
+void setUp(void) {
+    c8 = ROM_INIT(rom, C8_MODE_CHIP8, 0);
+}
+
+void tearDown(void) {
+    c8_set_exit_on_exception(1);
+    c8_deinit(c8);
+    remove(TRACE_PATH);
+}
+
+void test_c8_trace_open_WhereInstructionsAreRecorded(void) {
+    c8_trace_record_t r;
+    size_t count;
+
+    TEST_ASSERT_EQUAL_INT(1, c8_trace_open(c8, TRACE_PATH));
+    c8_run(c8, 4);
+    c8_trace_close(c8);
+
+    const uint8_t* records = c8_trace_records(buf, read_trace(), &count);
+    TEST_ASSERT_NOT_NULL(records);
+    TEST_ASSERT_EQUAL_size_t(4, count);
+
+    c8_trace_read(records, 0, &r);
+    TEST_ASSERT_EQUAL_UINT16(0x200, r.pc);
+    TEST_ASSERT_EQUAL_UINT16(0x6005, r.opcode);
+    TEST_ASSERT_EQUAL_UINT8(5, r.vx);
+
+    c8_trace_read(records, 1, &r);
+    TEST_ASSERT_EQUAL_UINT16(0x300, r.I);
+
+    c8_trace_read(records, 3, &r);
+    TEST_ASSERT_EQUAL_UINT16(0x206, r.pc);
+    TEST_ASSERT_EQUAL_UINT16(0x1204, r.opcode);
+    TEST_ASSERT_EQUAL_UINT8(4, c8->V[0]);
+}
+
+void test_c8_trace_open_WhereBufferIsFlushed(void) {
+    size_t count;
+
+    c8_trace_open(c8, TRACE_PATH);
+    c8_run(c8, 100000);
+    c8_trace_close(c8);
+
+    TEST_ASSERT_NOT_NULL(c8_trace_records(buf, read_trace(), &count));
+    TEST_ASSERT_EQUAL_size_t(100000, count);
+    TEST_ASSERT_EQUAL_INT(0, c8->flags & C8_FLAG_TRACE);
+}
+
+void test_c8_trace_records_WhereHeaderIsInvalid(void) {
+    size_t count;
+
+    c8_trace_open(c8, TRACE_PATH);
+    c8_trace_close(c8);
+
+    size_t size = read_trace();
+    TEST_ASSERT_NOT_NULL(c8_trace_records(buf, size, &count));
+    TEST_ASSERT_EQUAL_size_t(0, count);
+    TEST_ASSERT_NULL(c8_trace_records(buf, size - 1, &count));
+    buf[4]++;
+    TEST_ASSERT_NULL(c8_trace_records(buf, size, &count));
+}
+
+void test_c8_trace_open_WhereInstructionRaisesException(void) {
+    c8_trace_record_t r;
+    size_t count;
+
+    c8_deinit(c8);
+    c8 = ROM_INIT(badRom, C8_MODE_CHIP8, 0);
+    c8_set_exit_on_exception(0);
+    c8_trace_open(c8, TRACE_PATH);
+    c8_run(c8, 10);
+
+    /* The trace is still open, but the failed instruction is on disk */
+    TEST_ASSERT_TRUE(c8->flags & C8_FLAG_TRACE);
+    const uint8_t* records = c8_trace_records(buf, read_trace(), &count);
+    TEST_ASSERT_NOT_NULL(records);
+    TEST_ASSERT_EQUAL_size_t(3, count);
+    c8_trace_read(records, 2, &r);
+    TEST_ASSERT_EQUAL_UINT16(0x204, r.pc);
+    TEST_ASSERT_EQUAL_UINT16(0x00FF, r.opcode);
+}
+
+void test_c8_trace_open_WhereExceptionExits(void) {
+    c8_trace_record_t r;
+    size_t count;
+
+    c8_deinit(c8);
+    c8 = ROM_INIT(badRom, C8_MODE_CHIP8, 0);
+    c8_trace_open(c8, TRACE_PATH);
+    c8_run(c8, 10);
+
+    /* TEST builds do not exit, but the trace is closed as if they did */
+    TEST_ASSERT_EQUAL_INT(0, c8->flags & C8_FLAG_TRACE);
+    const uint8_t* records = c8_trace_records(buf, read_trace(), &count);
+    TEST_ASSERT_NOT_NULL(records);
+    TEST_ASSERT_EQUAL_size_t(3, count);
+    c8_trace_read(records, 2, &r);
+    TEST_ASSERT_EQUAL_UINT16(0x204, r.pc);
+    TEST_ASSERT_EQUAL_UINT16(0x00FF, r.opcode);
+    TEST_ASSERT_EQUAL_UINT16(0x300, r.I);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_c8_trace_open_WhereInstructionsAreRecorded);
+    RUN_TEST(test_c8_trace_open_WhereBufferIsFlushed);
+    RUN_TEST(test_c8_trace_records_WhereHeaderIsInvalid);
+    RUN_TEST(test_c8_trace_open_WhereInstructionRaisesException);
+    RUN_TEST(test_c8_trace_open_WhereExceptionExits);
+    return UNITY_END();
+}
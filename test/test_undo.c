@@ -0,0 +1,152 @@
+#include "unity.h"
+#include "c8/private/undo.c"
+#include "c8/chip8.h"
+#include "test_rom.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define STEPS 11
+
+/* Touches memory, the stack, the display and the RNG every iteration */
+static const uint16_t rom[] = {
+    0x6005, /* 200: LD V0, 5 */
+    0xA300, /* 202: LD I, 0x300 */
+    0xF033, /* 204: LD B, V0 */
+    0x2210, /* 206: CALL 0x210 */
+    0x00E0, /* 208: CLS */
+    0x1200, /* 20A: JP 0x200 */
+    0x0000,
+    0x0000,
+    0xA000, /* 210: LD I, 0 */
+    0xD015, /* 212: DRW V0, V1, 5 */
+    0xC0FF, /* 214: RND V0, 0xFF */
+    0x00EE, /* 216: RET */
+};
+
+c8_t* c8;
+
+static void step(c8_t* c) {
+    TEST_ASSERT_EQUAL_INT(1, undo_record(c));
+    c->pc += parse_instruction(c);
+}
+
+static void assert_machine_equal(const c8_t* expected, const c8_t* actual) {
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected->V, actual->V, 16);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected->R, actual->R, 8);
+    TEST_ASSERT_EQUAL_UINT16(expected->pc, actual->pc);
+    TEST_ASSERT_EQUAL_UINT16(expected->I, actual->I);
+    TEST_ASSERT_EQUAL_UINT8(expected->sp, actual->sp);
+    TEST_ASSERT_EQUAL_UINT16_ARRAY(expected->stack, actual->stack, C8_STACK_SIZE);
+    TEST_ASSERT_EQUAL_UINT64(expected->rng, actual->rng);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected->mem, actual->mem, C8_MEMSIZE);
+    TEST_ASSERT_EQUAL_MEMORY(expected->display.p, actual->display.p, sizeof(expected->display.p));
+}
+
+void setUp(void) {
+    c8 = ROM_INIT(rom, C8_MODE_CHIP8, 0);
+}
+
+void tearDown(void) {
+    c8_deinit(c8);
+}
+
+void test_undo_step_WhereLogIsEmpty(void) {
+    TEST_ASSERT_EQUAL_INT(0, undo_step(c8));
+    step(c8);
+    undo_clear(c8);
+    TEST_ASSERT_EQUAL_INT(0, undo_step(c8));
+}
+
+void test_undo_step_WhereEachStepIsUndone(void) {
+    c8_t* states = malloc(STEPS * sizeof(c8_t));
+
+    for (int i = 0; i < STEPS; i++) {
+        memcpy(&states[i], c8, sizeof(c8_t));
+        step(c8);
+    }
+
+    /* BCD, CALL, DRW, RND, and CLS have all been executed */
+    TEST_ASSERT_EQUAL_UINT16(0x202, c8->pc);
+    TEST_ASSERT_EQUAL_UINT8(5, c8->mem[0x302]);
+
+    for (int i = STEPS - 1; i >= 0; i--) {
+        TEST_ASSERT_EQUAL_INT(1, undo_step(c8));
+        assert_machine_equal(&states[i], c8);
+    }
+    TEST_ASSERT_EQUAL_INT(0, undo_step(c8));
+    free(states);
+}
+
+void test_undo_step_WhereExecutionResumes(void) {
+    c8_t* expected = malloc(sizeof(c8_t));
+
+    for (int i = 0; i < STEPS; i++) {
+        step(c8);
+    }
+    memcpy(expected, c8, sizeof(c8_t));
+
+    /* Replaying the undone instructions ends in the same state */
+    for (int i = 0; i < 6; i++) {
+        undo_step(c8);
+    }
+    for (int i = 0; i < 6; i++) {
+        step(c8);
+    }
+    assert_machine_equal(expected, c8);
+    free(expected);
+}
+
+void test_undo_step_WhereMemoryHeldCode(void) {
+    /* LD V0, 5; LD I, 0x207; LD [I], V1; LD V0, 1 (becomes LD V0, 5) */
+    const uint16_t code[] = { 0x6005, 0xA207, 0xF155, 0x6001 };
+    c8_t* c = ROM_INIT(code, C8_MODE_CHIP8, 0);
+
+    for (int i = 0; i < 4; i++) {
+        step(c);
+    }
+    TEST_ASSERT_EQUAL_UINT8(5, c->V[0]);
+
+    /* Undoing the store must drop the decoded LD V0, 5 */
+    undo_step(c);
+    undo_step(c);
+    TEST_ASSERT_EQUAL_UINT8(0x01, c->mem[0x207]);
+    c->pc = 0x206;
+    step(c);
+    TEST_ASSERT_EQUAL_UINT8(1, c->V[0]);
+    c8_deinit(c);
+}
+
+void test_undo_record_WhereLogIsFull(void) {
+    struct c8_undo* u;
+    int count;
+
+    for (int i = 0; i < 50000; i++) {
+        step(c8);
+    }
+
+    u = c8->cold->undo;
+    TEST_ASSERT_LESS_OR_EQUAL_UINT64(UNDO_LOG_SIZE, u->used);
+    TEST_ASSERT_GREATER_THAN(1000, u->count);
+    TEST_ASSERT_LESS_THAN(50000, u->count);
+
+    count = u->count;
+    for (int i = 0; i < count; i++) {
+        TEST_ASSERT_EQUAL_INT(1, undo_step(c8));
+        TEST_ASSERT_TRUE(c8->pc >= 0x200 && c8->pc <= 0x216);
+        TEST_ASSERT_LESS_OR_EQUAL_UINT8(1, c8->sp);
+    }
+    TEST_ASSERT_EQUAL_INT(0, undo_step(c8));
+    TEST_ASSERT_EQUAL_size_t(0, u->used);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_undo_step_WhereLogIsEmpty);
+    RUN_TEST(test_undo_step_WhereEachStepIsUndone);
+    RUN_TEST(test_undo_step_WhereExecutionResumes);
+    RUN_TEST(test_undo_step_WhereMemoryHeldCode);
+    RUN_TEST(test_undo_record_WhereLogIsFull);
+    return UNITY_END();
+}
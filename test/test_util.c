@@ -76,6 +76,27 @@ void test_parse_int_WhereStringDoesNotContainInt(void) {
     TEST_ASSERT_EQUAL_INT(-1, parse_int(buf));
 }
 
+void test_parse_int_n_WhereStringIsNotNullTerminated(void) {
+    sprintf(buf, "$1F, V2");
+    TEST_ASSERT_EQUAL_INT(0x1F, parse_int_n(buf, 3));
+    TEST_ASSERT_EQUAL_INT(-1, parse_int_n(buf, 4));
+}
+
+void test_parse_int_n_WherePrefixIsUppercase(void) {
+    sprintf(buf, "0XfF 0B101 X10");
+    TEST_ASSERT_EQUAL_INT(0xFF, parse_int_n(buf, 4));
+    TEST_ASSERT_EQUAL_INT(5, parse_int_n(buf + 5, 5));
+    TEST_ASSERT_EQUAL_INT(0x10, parse_int_n(buf + 11, 3));
+}
+
+void test_parse_int_n_WhereStringIsInvalid(void) {
+    TEST_ASSERT_EQUAL_INT(-1, parse_int_n("", 0));
+    TEST_ASSERT_EQUAL_INT(-1, parse_int_n("$", 1));
+    TEST_ASSERT_EQUAL_INT(-1, parse_int_n("12AB", 4));
+    TEST_ASSERT_EQUAL_INT(-1, parse_int_n("0b102", 5));
+    TEST_ASSERT_EQUAL_INT(-1, parse_int_n("99999999999", 11));
+}
+
 void test_trim_WhereStringHasLeadingWhitespace(void) {
     const char* content = "Hello there";
     sprintf(buf, "        \t\t  %s", content);
@@ -112,6 +133,9 @@ int main(void) {
     RUN_TEST(test_parse_int_WhereStringIsHexWithXPrefix);
     RUN_TEST(test_parse_int_WhereStringIsEmpty);
     RUN_TEST(test_parse_int_WhereStringDoesNotContainInt);
+    RUN_TEST(test_parse_int_n_WhereStringIsNotNullTerminated);
+    RUN_TEST(test_parse_int_n_WherePrefixIsUppercase);
+    RUN_TEST(test_parse_int_n_WhereStringIsInvalid);
     RUN_TEST(test_trim_WhereStringHasLeadingWhitespace);
     RUN_TEST(test_trim_WhereStringHasTrailingWhitespace);
     RUN_TEST(test_trim_leading_WhereStringHasLeadingAndTrailingWhitespace);
@@ -1,6 +1,8 @@
 #include "c8/chip8.h"
 #include "c8/font.h"
+#include "c8/trace.h"
 
+#include <inttypes.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -11,6 +13,7 @@
 #define VERSION "dev"
 #endif
 
+static void turbo(c8_t* c8, uint64_t max);
 static void usage(const char *argv0);
 
 int main(int argc, char* argv[]) {
@@ -26,17 +29,29 @@ int main(int argc, char* argv[]) {
 
     int opt;
     char* fontstr = NULL;
+    uint64_t max = 0;
+    uint64_t seed = time(NULL);
+    size_t rewind = 0;
+    char* trace = NULL;
+    char* profile = NULL;
 
     /* Parse args */
-    while ((opt = getopt(argc, argv, "c:df:p:P:q:vV")) != -1) {
+    while ((opt = getopt(argc, argv, "c:df:g:jo:p:P:q:r:s:tT:vV")) != -1) {
         switch (opt) {
         case 'c': c8->cs = atoi(optarg); break;
         case 'd': c8->flags |= C8_FLAG_DEBUG; break;
         case 'f': fontstr = optarg; break;
+        case 'g': profile = optarg; break;
+        case 'j': c8->flags |= C8_FLAG_JIT; break;
+        case 'o': trace = optarg; break;
         case 'p': c8_load_palette_f(c8, optarg); break;
         case 'P': c8_load_palette_s(c8, optarg); break;
         case 'v': c8->flags |= C8_FLAG_VERBOSE; break;
         case 'q': c8_load_quirks(c8, optarg); break;
+        case 'r': rewind = strtoull(optarg, NULL, 0) * 1024; break;
+        case 's': seed = strtoull(optarg, NULL, 0); break;
+        case 't': c8->flags |= C8_FLAG_THREADED; break;
+        case 'T': max = strtoull(optarg, NULL, 0); break;
         case 'V': printf("%s %s\n", argv[0], VERSION); return 0;
         default: usage(argv[0]);
         }
@@ -45,14 +60,47 @@ int main(int argc, char* argv[]) {
     if (fontstr) {
         c8_set_fonts_s(c8, fontstr);
     }
+    c8_seed(c8, seed);
+    if (rewind) {
+        c8_set_rewind(c8, rewind, C8_REWIND_INTERVAL);
+    }
+    if (trace && !c8_trace_open(c8, trace)) {
+        usage(argv[0]);
+    }
+    if (profile && !c8_set_profile(c8, profile)) {
+        usage(argv[0]);
+    }
 
-    c8_simulate(c8);
+    if (max) {
+        turbo(c8, max);
+    } else {
+        c8_simulate(c8);
+    }
     c8_deinit(c8);
 
     return EXIT_SUCCESS;
 }
 
+/**
+ * @brief Run up to `max` instructions headless and report the speed
+ *
+ * @param c8 the `c8_t` to run
+ * @param max maximum number of instructions to execute
+ */
+static void turbo(c8_t* c8, uint64_t max) {
+    static const char* reasons[] = { "budget", "exit", "key", "error" };
+    struct timespec start, end;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    int reason = c8_run(c8, max);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double secs = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    printf("%" PRIu64 " instructions in %.3f s (%.0f instructions/s), stopped: %s\n",
+        c8->cycles, secs, secs > 0 ? c8->cycles / secs : 0, reasons[reason]);
+}
+
 static void usage(const char *argv0) {
-    fprintf(stderr, "Usage: %s [-dvV] [-c clockspeed] [-f small,big] [-p file] [-P colors] [-q quirks] file\n", argv0);
+    fprintf(stderr, "Usage: %s [-djtvV] [-c clockspeed] [-f small,big] [-g profile] [-o tracefile] [-p file] [-P colors] [-q quirks] [-r KiB] [-s seed] [-T instructions] file\n", argv0);
     exit(EXIT_FAILURE);
 }
@@ -11,7 +11,6 @@
 #endif
 
 static int assemble(const char*, const char*, int);
-static char* dynamic_load(FILE*);
 
 int main(int argc, char* argv[]) {
     int opt;
@@ -30,8 +29,12 @@ int main(int argc, char* argv[]) {
         }
     }
 
-    int ret = assemble(argv[optind], outpath, args);
-    return 0;
+    if (optind >= argc) {
+        fprintf(stderr, "Usage: %s [-v] [-o outputfile] file\n", argv[0]);
+        exit(1);
+    }
+
+    return assemble(argv[optind], outpath, args) ? EXIT_SUCCESS : EXIT_FAILURE;
 }
 
 /**
@@ -44,65 +47,33 @@ int main(int argc, char* argv[]) {
  * @return 1 if success, 0 otherwise
  */
 static int assemble(const char* inpath, const char* outpath, int args) {
-    FILE* in;
     FILE* out;
-    char* input;
     uint8_t* output;
     int len;
     int romSize = C8_MEMSIZE - C8_PROG_START;
 
-    if (!(in = fopen(inpath, "r"))) {
-        fprintf(stderr, "Failed to load input file\n");
+    output = (uint8_t*)calloc(romSize, sizeof(uint8_t));
+    if (!output) {
         return 0;
     }
 
-    if (!outpath || !(out = fopen(outpath, "wb"))) {
-        fprintf(stderr, "Failed to load output file\n");
-        fclose(in);
+    if ((len = c8_encode_file(inpath, output, args)) < 0) {
+        fprintf(stderr, "Failed to assemble input file\n");
+        free(output);
         return 0;
     }
 
-    input = dynamic_load(in);
-    output = (uint8_t*)calloc(romSize, sizeof(uint8_t));
-
-    len = c8_encode(input, output, args);
-
     printf("length: %d\n", len);
 
-    for (int i = 0; i < len; i++) {
-        fputc(output[i], out);
+    if (!outpath || !(out = fopen(outpath, "wb"))) {
+        fprintf(stderr, "Failed to load output file\n");
+        free(output);
+        return 0;
     }
 
-    fclose(in);
+    fwrite(output, 1, len, out);
+
     fclose(out);
-    free(input);
     free(output);
     return 1;
 }
-
-/**
- * @brief Dynamically load an entire file into a string
- *
- * @param f file to load
- * @return pointer to string
- */
-static char* dynamic_load(FILE* f) {
-    int capacity = BUFSIZ;
-    char* buf = (char*)malloc(capacity);
-    char* newbuf;
-    char ch;
-    int len = 0;
-
-    while ((ch = fgetc(f)) != EOF) {
-        if (len >= capacity - 1) {
-            capacity *= 2;
-            newbuf = (char*)realloc(buf, capacity);
-            buf = newbuf;
-        }
-
-        buf[len++] = ch;
-    }
-
-    buf[len] = '\0';
-    return buf;
-}
@@ -0,0 +1,339 @@
+#include "c8/chip8.h"
+#include "c8/defs.h"
+
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifndef VERSION
+#define VERSION "dev"
+#endif
+
+#define LINE_MAX_LENGTH 4096
+#define ROM_MAX (C8_MEMSIZE - C8_PROG_START)
+#define DEFAULT_BUDGET 10000000ULL
+#define FNV_OFFSET 0xCBF29CE484222325ULL
+#define FNV_PRIME 0x100000001B3ULL
+
+#define STOP_LOAD_ERROR -1
+
+/* A worker's range of jobs [begin, end), packed as `end << 32 | begin` */
+#define RANGE(begin, end) (((uint64_t)(end) << 32) | (uint32_t)(begin))
+#define RANGE_BEGIN(r) ((uint32_t)(r))
+#define RANGE_END(r) ((uint32_t)((r) >> 32))
+
+/**
+ * @struct job_t
+ * @brief One manifest entry and its result
+ *
+ * @param path ROM path
+ * @param quirks quirk string (see `c8_load_quirks`), or NULL
+ * @param budget maximum number of instructions to execute
+ * @param hash FNV-1a hash of the final display
+ * @param cycles instructions executed
+ * @param reason reason execution stopped (`C8_STOP_*` or `STOP_LOAD_ERROR`)
+ */
+typedef struct {
+    char* path;
+    char* quirks;
+    uint64_t budget;
+    uint64_t hash;
+    uint64_t cycles;
+    int reason;
+} job_t;
+
+/**
+ * @struct worker_t
+ * @brief A thread of the pool and the jobs it has yet to run
+ *
+ * The owner takes jobs from the front of its range. Idle workers steal the
+ * back half of another worker's range. Both update `range` with a single
+ * compare-and-swap, so no locks are needed.
+ *
+ * @param thread the worker's thread
+ * @param range jobs not yet taken (see `RANGE`)
+ * @param id index of this worker in `workers`
+ */
+typedef struct {
+    pthread_t thread;
+    _Atomic uint64_t range;
+    int id;
+} worker_t;
+
+static int load_manifest(const char*, uint64_t);
+static void run_job(job_t*);
+static int steal(worker_t*);
+static int take(worker_t*, uint32_t*);
+static void usage(const char*);
+static void* work(void*);
+
+job_t* jobs;
+int jobCount;
+worker_t* workers;
+int workerCount;
+int flags;
+
+int main(int argc, char* argv[]) {
+    int opt;
+    char* outp = NULL;
+    FILE* outf = stdout;
+    uint64_t budget = DEFAULT_BUDGET;
+    const char* reasons[] = { "budget", "exit", "key", "error" };
+
+    workerCount = sysconf(_SC_NPROCESSORS_ONLN);
+
+    /* Parse args */
+    while ((opt = getopt(argc, argv, "jn:o:t:V")) != -1) {
+        switch (opt) {
+        case 'j': flags |= C8_FLAG_JIT; break;
+        case 'n': budget = strtoull(optarg, NULL, 0); break;
+        case 'o': outp = optarg; break;
+        case 't': workerCount = atoi(optarg); break;
+        case 'V': printf("%s %s\n", argv[0], VERSION); exit(EXIT_SUCCESS);
+        default: usage(argv[0]);
+        }
+    }
+
+    if (optind >= argc || workerCount < 1) {
+        usage(argv[0]);
+    }
+
+    if (!load_manifest(argv[optind], budget)) {
+        exit(EXIT_FAILURE);
+    }
+
+    /* A faulty ROM must not take down the whole batch */
+    c8_set_exit_on_exception(0);
+
+    if (workerCount > jobCount) {
+        workerCount = jobCount > 0 ? jobCount : 1;
+    }
+
+    workers = calloc(workerCount, sizeof(worker_t));
+    if (!workers) {
+        fprintf(stderr, "Failed to allocate memory.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    /* Split the jobs evenly, stealing balances the rest */
+    for (int i = 0; i < workerCount; i++) {
+        workers[i].id = i;
+        atomic_init(&workers[i].range, RANGE((int64_t)jobCount * i / workerCount,
+            (int64_t)jobCount * (i + 1) / workerCount));
+    }
+
+    for (int i = 1; i < workerCount; i++) {
+        if (pthread_create(&workers[i].thread, NULL, work, &workers[i])) {
+            fprintf(stderr, "Failed to start worker thread %d.\n", i);
+            exit(EXIT_FAILURE);
+        }
+    }
+    work(&workers[0]);
+    for (int i = 1; i < workerCount; i++) {
+        pthread_join(workers[i].thread, NULL);
+    }
+
+    if (outp) {
+        outf = fopen(outp, "w");
+        if (!outf) {
+            fprintf(stderr, "Could not open output file: %s\n", outp);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    for (int i = 0; i < jobCount; i++) {
+        fprintf(outf, "%s\t%016" PRIx64 "\t%" PRIu64 "\t%s\n", jobs[i].path,
+            jobs[i].hash, jobs[i].cycles,
+            jobs[i].reason == STOP_LOAD_ERROR ? "load-error" : reasons[jobs[i].reason]);
+    }
+
+    if (outp) {
+        fclose(outf);
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Load jobs from a manifest file
+ *
+ * Each line of the manifest is `path [quirks [instructions]]`. A quirks string
+ * of `-` enables no quirks. Blank lines and lines starting with `#` are
+ * ignored.
+ *
+ * @param path manifest file path
+ * @param budget instruction budget of jobs that do not specify one
+ *
+ * @return 1 if success, 0 otherwise
+ */
+static int load_manifest(const char* path, uint64_t budget) {
+    char line[LINE_MAX_LENGTH];
+    int size = 0;
+    int lineNum = 0;
+    FILE* f = fopen(path, "r");
+
+    if (!f) {
+        fprintf(stderr, "Could not open manifest file: %s\n", path);
+        return 0;
+    }
+
+    while (fgets(line, LINE_MAX_LENGTH, f)) {
+        char* save;
+        char* rom = strtok_r(line, " \t\r\n", &save);
+        char* quirks = strtok_r(NULL, " \t\r\n", &save);
+        char* instructions = strtok_r(NULL, " \t\r\n", &save);
+
+        lineNum++;
+        if (!rom || rom[0] == '#') {
+            continue;
+        }
+
+        if (jobCount == size) {
+            size = size ? size * 2 : 256;
+            job_t* j = realloc(jobs, size * sizeof(job_t));
+            if (!j) {
+                fprintf(stderr, "Failed to allocate memory.\n");
+                fclose(f);
+                return 0;
+            }
+            jobs = j;
+        }
+
+        job_t* job = &jobs[jobCount++];
+        memset(job, 0, sizeof(job_t));
+        job->path = strdup(rom);
+        job->quirks = quirks && strcmp(quirks, "-") ? strdup(quirks) : NULL;
+        job->budget = budget;
+        if (instructions) {
+            char* end;
+            job->budget = strtoull(instructions, &end, 0);
+            if (*end) {
+                fprintf(stderr, "Line %d: Invalid instruction budget '%s'\n",
+                    lineNum, instructions);
+                fclose(f);
+                return 0;
+            }
+        }
+    }
+
+    fclose(f);
+    return 1;
+}
+
+/**
+ * @brief Run a job headless and record its result
+ *
+ * @param job the job to run
+ */
+static void run_job(job_t* job) {
+    uint8_t rom[ROM_MAX];
+    size_t size;
+    FILE* f = fopen(job->path, "rb");
+
+    if (!f) {
+        job->reason = STOP_LOAD_ERROR;
+        return;
+    }
+    size = fread(rom, 1, ROM_MAX, f);
+    fclose(f);
+
+    c8_t* c8 = c8_init_mem(rom, size, flags);
+    if (!c8) {
+        job->reason = STOP_LOAD_ERROR;
+        return;
+    }
+    if (job->quirks) {
+        c8_load_quirks(c8, job->quirks);
+    }
+
+    job->reason = c8_run(c8, job->budget);
+    job->cycles = c8->cycles;
+
+    /* FNV-1a over the display rows */
+    job->hash = FNV_OFFSET;
+    const uint8_t* p = (const uint8_t*)c8->display.p;
+    for (size_t i = 0; i < sizeof(c8->display.p); i++) {
+        job->hash = (job->hash ^ p[i]) * FNV_PRIME;
+    }
+
+    c8_deinit(c8);
+}
+
+/**
+ * @brief Steal the back half of another worker's jobs
+ *
+ * @param self the worker stealing, whose range must be empty
+ *
+ * @return 1 if any jobs were stolen, 0 if every other worker is out of jobs
+ */
+static int steal(worker_t* self) {
+    for (int i = 1; i < workerCount; i++) {
+        worker_t* victim = &workers[(self->id + i) % workerCount];
+        uint64_t r = atomic_load(&victim->range);
+
+        while (RANGE_BEGIN(r) < RANGE_END(r)) {
+            uint32_t begin = RANGE_BEGIN(r);
+            uint32_t end = RANGE_END(r);
+            uint32_t mid = begin + (end - begin) / 2;
+
+            if (atomic_compare_exchange_weak(&victim->range, &r, RANGE(begin, mid))) {
+                atomic_store(&self->range, RANGE(mid, end));
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Take the next job from the front of a worker's range
+ *
+ * @param self the worker
+ * @param job where to store the index of the job taken
+ *
+ * @return 1 if a job was taken, 0 if the range is empty
+ */
+static int take(worker_t* self, uint32_t* job) {
+    uint64_t r = atomic_load(&self->range);
+
+    while (RANGE_BEGIN(r) < RANGE_END(r)) {
+        if (atomic_compare_exchange_weak(&self->range, &r,
+            RANGE(RANGE_BEGIN(r) + 1, RANGE_END(r)))) {
+            *job = RANGE_BEGIN(r);
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Worker thread: run jobs until no worker has any left
+ *
+ * @param arg the `worker_t`
+ *
+ * @return NULL
+ */
+static void* work(void* arg) {
+    worker_t* self = arg;
+    uint32_t job;
+
+    do {
+        while (take(self, &job)) {
+            run_job(&jobs[job]);
+        }
+    } while (steal(self));
+
+    return NULL;
+}
+
+static void usage(const char* argv0) {
+    fprintf(stderr, "Usage: %s [-jV] [-n instructions] [-o outputfile] [-t threads] manifest\n", argv0);
+    exit(EXIT_FAILURE);
+}
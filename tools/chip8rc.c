@@ -0,0 +1,412 @@
+#include "c8/decode.h"
+#include "c8/defs.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifndef VERSION
+#define VERSION "dev"
+#endif
+
+#define ROM_MAX (C8_MEMSIZE - C8_PROG_START)
+#define IN_ROM(addr) ((addr) >= C8_PROG_START && (addr) + 1 < C8_PROG_START + romSize)
+#define FETCH(addr) ((uint16_t)((rom[(addr) - C8_PROG_START] << 8) | rom[(addr) - C8_PROG_START + 1]))
+
+static void discover(void);
+static void emit(FILE*, const char*, int);
+static void emit_block(FILE*, uint16_t);
+static int emit_instruction(FILE*, uint16_t, uint16_t, int);
+static int ends_block(uint16_t, uint16_t, uint16_t*, int*);
+static void usage(const char*);
+
+uint8_t rom[ROM_MAX];
+int romSize;
+uint8_t blocks[C8_MEMSIZE];
+
+int main(int argc, char* argv[]) {
+    int opt;
+    int withMain = 0;
+    char* outp = NULL;
+    FILE* inf;
+    FILE* outf = stdout;
+
+    /* Parse args */
+    while ((opt = getopt(argc, argv, "mo:V")) != -1) {
+        switch (opt) {
+        case 'm': withMain = 1; break;
+        case 'o': outp = optarg; break;
+        case 'V': printf("%s %s\n", argv[0], VERSION); exit(EXIT_SUCCESS);
+        default: usage(argv[0]);
+        }
+    }
+
+    if (optind >= argc) {
+        usage(argv[0]);
+    }
+
+    inf = fopen(argv[optind], "rb");
+    if (!inf) {
+        fprintf(stderr, "Could not open ROM file: %s\n", argv[optind]);
+        exit(EXIT_FAILURE);
+    }
+
+    romSize = fread(rom, 1, ROM_MAX, inf);
+    if (fgetc(inf) != EOF) {
+        fprintf(stderr, "ROM file too big: %s\n", argv[optind]);
+        exit(EXIT_FAILURE);
+    }
+    fclose(inf);
+
+    if (outp) {
+        outf = fopen(outp, "w");
+        if (!outf) {
+            fprintf(stderr, "Could not open output file: %s\n", outp);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    discover();
+    emit(outf, argv[optind], withMain);
+
+    if (outp) {
+        fclose(outf);
+    }
+    return 0;
+}
+
+/**
+ * @brief Find the start addresses of all basic blocks reachable from
+ * `C8_PROG_START` and mark them in `blocks`.
+ *
+ * Targets of `JP V0, nnn` are only known at runtime and are left to the
+ * interpreter.
+ */
+static void discover(void) {
+    uint16_t stack[C8_MEMSIZE * 2];
+    int sp = 0;
+
+    stack[sp++] = C8_PROG_START;
+    while (sp > 0) {
+        uint16_t start = stack[--sp];
+
+        if (!IN_ROM(start) || blocks[start]) {
+            continue;
+        }
+        blocks[start] = 1;
+
+        for (uint16_t addr = start; IN_ROM(addr); addr += 2) {
+            uint16_t next[2];
+            int n;
+
+            if (ends_block(FETCH(addr), addr, next, &n)) {
+                for (int i = 0; i < n; i++) {
+                    stack[sp++] = next[i];
+                }
+                break;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Check if `in` ends a basic block, and get its successors if so.
+ *
+ * @param in instruction
+ * @param addr address of `in`
+ * @param next where to store the successors' addresses
+ * @param n where to store the number of successors
+ *
+ * @return 1 if `in` ends a basic block, 0 otherwise
+ */
+static int ends_block(uint16_t in, uint16_t addr, uint16_t* next, int* n) {
+    C8_EXPAND(in);
+    *n = 0;
+
+    switch (a) {
+    case 0x0:
+        if (y == 0xC) {
+            return 0; // SCD
+        }
+        switch (kk) {
+        case 0xE0: case 0xFB: case 0xFC: case 0xFE: case 0xFF:
+            return 0;
+        default:
+            return 1; // RET, EXIT, or invalid
+        }
+    case 0x1:
+        next[(*n)++] = c8_jump(in);
+        return 1;
+    case 0x2:
+        next[(*n)++] = c8_jump(in);
+        next[(*n)++] = addr + 2;
+        return 1;
+    case 0x3: case 0x4: case 0x5: case 0x9:
+        next[(*n)++] = addr + 2;
+        next[(*n)++] = addr + 4;
+        return 1;
+    case 0xB:
+        return 1;
+    case 0xD:
+        next[(*n)++] = addr + 2;
+        return 1;
+    case 0xE:
+        if (kk == 0x9E || kk == 0xA1) {
+            next[(*n)++] = addr + 2;
+            next[(*n)++] = addr + 4;
+        }
+        return 1;
+    case 0x8:
+        if (b > 0x7 && b != 0xE) {
+            return 1; // invalid
+        }
+        return 0;
+    case 0xF:
+        switch (kk) {
+        case 0x0A: case 0x33: case 0x55:
+            next[(*n)++] = addr + 2;
+            return 1;
+        case 0x07: case 0x15: case 0x18: case 0x1E: case 0x29: case 0x30:
+        case 0x65: case 0x75: case 0x85:
+            return 0;
+        default:
+            return 1; // invalid
+        }
+    default:
+        return 0;
+    }
+}
+
+/**
+ * @brief Write the C translation unit for the ROM to `out`.
+ *
+ * @param out where to write the C source
+ * @param name name of the ROM file
+ * @param withMain 1 to emit a `main` function running the ROM
+ */
+static void emit(FILE* out, const char* name, int withMain) {
+    fprintf(out, "/* Generated by chip8rc %s from %s */\n\n", VERSION, name);
+    fprintf(out, "#include \"c8/chip8.h\"\n");
+    fprintf(out, "#include \"c8/recompile.h\"\n\n");
+    fprintf(out, "#include <stdint.h>\n");
+    fprintf(out, "#include <stdlib.h>\n\n");
+
+    fprintf(out, "static const uint8_t rom[%d] = {", romSize > 0 ? romSize : 1);
+    for (int i = 0; i < romSize; i++) {
+        fprintf(out, "%s0x%02X,", i % 12 ? " " : "\n    ", rom[i]);
+    }
+    fprintf(out, "\n};\n\n");
+
+    for (int addr = 0; addr < C8_MEMSIZE; addr++) {
+        if (blocks[addr]) {
+            fprintf(out, "static int block_%03x(c8_t*);\n", addr);
+        }
+    }
+    fprintf(out, "\n");
+
+    for (int addr = 0; addr < C8_MEMSIZE; addr++) {
+        if (blocks[addr]) {
+            emit_block(out, addr);
+        }
+    }
+
+    fprintf(out, "int c8_recompiled(c8_t* c8) {\n");
+    fprintf(out, "    switch (c8->pc) {\n");
+    for (int addr = 0; addr < C8_MEMSIZE; addr++) {
+        if (blocks[addr]) {
+            fprintf(out, "    case 0x%03X: return block_%03x(c8);\n", addr, addr);
+        }
+    }
+    fprintf(out, "    default: return 0;\n");
+    fprintf(out, "    }\n");
+    fprintf(out, "}\n");
+
+    if (withMain) {
+        fprintf(out, "\nint main(int argc, char* argv[]) {\n");
+        fprintf(out, "    c8_t* c8 = c8_init_mem(rom, sizeof(rom), 0);\n\n");
+        fprintf(out, "    if (!c8) {\n");
+        fprintf(out, "        return EXIT_FAILURE;\n");
+        fprintf(out, "    }\n\n");
+        fprintf(out, "    if (argc > 1) {\n");
+        fprintf(out, "        c8_load_quirks(c8, argv[1]);\n");
+        fprintf(out, "    }\n\n");
+        fprintf(out, "    c8->recompiled = c8_recompiled;\n");
+        fprintf(out, "    c8_simulate(c8);\n");
+        fprintf(out, "    c8_deinit(c8);\n");
+        fprintf(out, "    return EXIT_SUCCESS;\n");
+        fprintf(out, "}\n");
+    }
+}
+
+/**
+ * @brief Write the function for the basic block starting at `start` to `out`.
+ *
+ * The function returns the number of instructions executed, 0 if the block's
+ * code has been modified at runtime, or an exception code.
+ *
+ * @param out where to write the C source
+ * @param start address of the first instruction in the block
+ */
+static void emit_block(FILE* out, uint16_t start) {
+    uint16_t end = start;
+    uint16_t next[2];
+    int n = 0;
+    int done = 0;
+
+    /* Find the end of the block */
+    while (!done && IN_ROM(end)) {
+        done = ends_block(FETCH(end), end, next, &n);
+        end += 2;
+    }
+
+    char* body;
+    size_t len;
+    FILE* f = open_memstream(&body, &len);
+
+    n = 0;
+    done = 0;
+    for (uint16_t addr = start; addr < end; addr += 2) {
+        uint16_t in = FETCH(addr);
+        n++;
+
+        fprintf(f, "    /* %03x: %s */\n", addr, c8_decode_instruction(in, NULL));
+        done = emit_instruction(f, in, addr, n);
+    }
+
+    if (!done) {
+        /* Ran off the end of the ROM */
+        fprintf(f, "    c8->pc = 0x%03X;\n", end);
+        fprintf(f, "    return %d;\n", n);
+    }
+    fclose(f);
+
+    fprintf(out, "static int block_%03x(c8_t* c8) {\n", start);
+    if (strstr(body, "c8_rc_exec")) {
+        fprintf(out, "    int r;\n\n");
+    }
+    fprintf(out, "    if (!c8_rc_valid(c8, rom, 0x%03X, 0x%03X)) {\n", start, end);
+    fprintf(out, "        return 0;\n");
+    fprintf(out, "    }\n\n");
+    fprintf(out, "%s", body);
+    fprintf(out, "}\n\n");
+    free(body);
+}
+
+/**
+ * @brief Write the C statements for instruction `in` to `out`.
+ *
+ * Register, `I`, timer, and control flow instructions with a static target
+ * are translated to C mirroring instruction.c. All others are executed by the
+ * interpreter via `c8_rc_exec`.
+ *
+ * @param out where to write the C source
+ * @param in instruction
+ * @param addr address of `in`
+ * @param n number of instructions in the block up to and including `in`
+ *
+ * @return 1 if `in` ends the block (and a return statement was written)
+ */
+static int emit_instruction(FILE* out, uint16_t in, uint16_t addr, int n) {
+    C8_EXPAND(in);
+    uint16_t next[2];
+    int count;
+    const char* shiftY = "c8->flags & C8_FLAG_QUIRK_SHIFT";
+
+    switch (a) {
+    case 0x1:
+        fprintf(out, "    c8->pc = 0x%03X;\n", nnn);
+        fprintf(out, "    return %d;\n", n);
+        return 1;
+    case 0x3:
+    case 0x4:
+        fprintf(out, "    c8->pc = c8->V[0x%X] %s 0x%02X ? 0x%03X : 0x%03X;\n",
+            x, a == 0x3 ? "==" : "!=", kk, addr + 4, addr + 2);
+        fprintf(out, "    return %d;\n", n);
+        return 1;
+    case 0x5:
+    case 0x9:
+        fprintf(out, "    c8->pc = c8->V[0x%X] %s c8->V[0x%X] ? 0x%03X : 0x%03X;\n",
+            x, a == 0x5 ? "==" : "!=", y, addr + 4, addr + 2);
+        fprintf(out, "    return %d;\n", n);
+        return 1;
+    case 0x6:
+        fprintf(out, "    c8->V[0x%X] = 0x%02X;\n", x, kk);
+        return 0;
+    case 0x7:
+        fprintf(out, "    c8->V[0xF] = c8->V[0x%X] + 0x%02X > 0xFF;\n", x, kk);
+        fprintf(out, "    c8->V[0x%X] += 0x%02X;\n", x, kk);
+        return 0;
+    case 0x8:
+        switch (b) {
+        case 0x0:
+            fprintf(out, "    c8->V[0x%X] = c8->V[0x%X];\n", x, y);
+            return 0;
+        case 0x1:
+        case 0x2:
+        case 0x3:
+            fprintf(out, "    c8->V[0x%X] %s= c8->V[0x%X];\n", x, b == 1 ? "|" : b == 2 ? "&" : "^", y);
+            fprintf(out, "    if (c8->flags & C8_FLAG_QUIRK_BITWISE) {\n");
+            fprintf(out, "        c8->V[0xF] = 0;\n");
+            fprintf(out, "    }\n");
+            return 0;
+        case 0x4:
+            fprintf(out, "    c8->V[0xF] = c8->V[0x%X] + c8->V[0x%X] > 0xFF;\n", x, y);
+            fprintf(out, "    c8->V[0x%X] += c8->V[0x%X];\n", x, y);
+            return 0;
+        case 0x5:
+            fprintf(out, "    c8->V[0xF] = c8->V[0x%X] >= c8->V[0x%X];\n", x, y);
+            fprintf(out, "    c8->V[0x%X] -= c8->V[0x%X];\n", x, y);
+            return 0;
+        case 0x6:
+            fprintf(out, "    c8->V[0x%X] = c8->V[%s ? 0x%X : 0x%X] >> 1;\n", x, shiftY, x, y);
+            fprintf(out, "    c8->V[0xF] = c8->V[0x%X] & 0x1;\n", x);
+            return 0;
+        case 0x7:
+            fprintf(out, "    c8->V[0xF] = c8->V[0x%X] >= c8->V[0x%X];\n", y, x);
+            fprintf(out, "    c8->V[0x%X] = c8->V[0x%X] - c8->V[0x%X];\n", x, y, x);
+            return 0;
+        case 0xE:
+            fprintf(out, "    c8->V[0x%X] = c8->V[%s ? 0x%X : 0x%X] << 1;\n", x, shiftY, x, y);
+            fprintf(out, "    c8->V[0xF] = (c8->V[0x%X] >> 7) & 1;\n", x);
+            return 0;
+        }
+        break;
+    case 0xA:
+        fprintf(out, "    c8->I = 0x%03X;\n", nnn);
+        return 0;
+    case 0xF:
+        switch (kk) {
+        case 0x07:
+            fprintf(out, "    c8->V[0x%X] = c8->dt;\n", x);
+            return 0;
+        case 0x15:
+            fprintf(out, "    c8->dt = c8->V[0x%X];\n", x);
+            return 0;
+        case 0x18:
+            fprintf(out, "    c8->st = c8->V[0x%X];\n", x);
+            return 0;
+        case 0x1E:
+            fprintf(out, "    c8->I += c8->V[0x%X];\n", x);
+            return 0;
+        }
+        break;
+    }
+
+    /* Everything else goes through the interpreter */
+    fprintf(out, "    if ((r = c8_rc_exec(c8, 0x%03X)) < 0) {\n", addr);
+    fprintf(out, "        return r;\n");
+    fprintf(out, "    }\n");
+
+    if (ends_block(in, addr, next, &count)) {
+        fprintf(out, "    return %d;\n", n);
+        return 1;
+    }
+    return 0;
+}
+
+static void usage(const char* argv0) {
+    fprintf(stderr, "Usage: %s [-m] [-o outputfile] file\n", argv0);
+    exit(EXIT_FAILURE);
+}
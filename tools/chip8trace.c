@@ -0,0 +1,91 @@
+#include "c8/decode.h"
+#include "c8/trace.h"
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifndef VERSION
+#define VERSION "dev"
+#endif
+
+static void usage(const char*);
+
+int main(int argc, char* argv[]) {
+    int opt;
+    char* outp = NULL;
+    FILE* outf = stdout;
+    size_t max = SIZE_MAX;
+    size_t count;
+    struct stat st;
+
+    /* Parse args */
+    while ((opt = getopt(argc, argv, "n:o:V")) != -1) {
+        switch (opt) {
+        case 'n': max = strtoull(optarg, NULL, 0); break;
+        case 'o': outp = optarg; break;
+        case 'V': printf("%s %s\n", argv[0], VERSION); exit(EXIT_SUCCESS);
+        default: usage(argv[0]);
+        }
+    }
+
+    if (optind >= argc) {
+        usage(argv[0]);
+    }
+
+    int fd = open(argv[optind], O_RDONLY);
+    if (fd < 0 || fstat(fd, &st) || st.st_size <= 0) {
+        fprintf(stderr, "Could not read trace: %s\n", argv[optind]);
+        exit(EXIT_FAILURE);
+    }
+
+    uint8_t* data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        fprintf(stderr, "Could not read trace: %s\n", argv[optind]);
+        exit(EXIT_FAILURE);
+    }
+
+    const uint8_t* records = c8_trace_records(data, st.st_size, &count);
+    if (!records) {
+        fprintf(stderr, "Not a trace: %s\n", argv[optind]);
+        exit(EXIT_FAILURE);
+    }
+
+    if (outp) {
+        outf = fopen(outp, "w");
+        if (!outf) {
+            fprintf(stderr, "Could not open %s\n", outp);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    if (count > max) {
+        count = max;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        char buf[C8_DECODE_MAX_LENGTH];
+        c8_trace_record_t r;
+
+        c8_trace_read(records, i, &r);
+        fprintf(outf, "%03x: %-20s I=%03x V%X=%02x VF=%02x\n", r.pc,
+            c8_decode_instruction_r(r.opcode, NULL, buf, sizeof(buf)),
+            r.I, (r.opcode >> 8) & 0xF, r.vx, r.vf);
+    }
+
+    munmap(data, st.st_size);
+    if (outp) {
+        fclose(outf);
+    }
+    return EXIT_SUCCESS;
+}
+
+static void usage(const char* argv0) {
+    fprintf(stderr, "Usage: %s [-V] [-n count] [-o outputfile] trace\n", argv0);
+    exit(EXIT_FAILURE);
+}